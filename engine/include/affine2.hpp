@@ -0,0 +1,217 @@
+#pragma once
+#include "matrix.hpp"
+#include "simd.hpp"
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+#ifndef OM_DECLSPEC
+#define OM_DECLSPEC
+#endif
+namespace om
+{
+/// 2D affine transform, the first two lines of Matrix<3, 3> with the last
+/// line 0 0 1. Linear part is one SSE or NEON register: columns are
+/// (linear[0], linear[1]) and (linear[2], linear[3]). Operations write to
+/// existing object, so composition of sprite transform doesn't copy 3x3
+/// temporaries as Matrix operators do
+struct alignas(16) OM_DECLSPEC Affine2
+{
+    myGlfloat linear[4]{ 1, 0, 0, 1 };
+    /// x, y and unused padding to register size
+    myGlfloat translation[4]{};
+
+    static Affine2 getShift(const Vector<2>& shift)
+    {
+        Affine2 result;
+        result.translation[0] = shift.elements[0];
+        result.translation[1] = shift.elements[1];
+        return result;
+    }
+
+    static Affine2 getScale(const Vector<2>& scale)
+    {
+        Affine2 result;
+        result.linear[0] = scale.elements[0];
+        result.linear[3] = scale.elements[1];
+        return result;
+    }
+
+    /// Rotation opposite clock direction around center, as
+    /// MatrixFunctor::getRotateMatrix. Sine and cosine may be computed once
+    /// for angle which doesn't change
+    static Affine2 getRotationSinCos(myGlfloat sin, myGlfloat cos,
+                                     const Vector<2>& center = {})
+    {
+        Affine2 result;
+        result.linear[0] = cos;
+        result.linear[1] = sin;
+        result.linear[2] = -sin;
+        result.linear[3] = cos;
+        // center stays in place
+        result.translation[0] = center.elements[0] -
+                                cos * center.elements[0] +
+                                sin * center.elements[1];
+        result.translation[1] = center.elements[1] -
+                                sin * center.elements[0] -
+                                cos * center.elements[1];
+        return result;
+    }
+
+    static Affine2 getRotation(myGlfloat angle, const Vector<2>& center = {})
+    {
+        return getRotationSinCos(std::sin(angle), std::cos(angle), center);
+    }
+
+    static Affine2 fromMatrix(const Matrix<3, 3>& matrix)
+    {
+        Affine2 result;
+        result.linear[0]      = matrix.columns[0].elements[0];
+        result.linear[1]      = matrix.columns[0].elements[1];
+        result.linear[2]      = matrix.columns[1].elements[0];
+        result.linear[3]      = matrix.columns[1].elements[1];
+        result.translation[0] = matrix.columns[2].elements[0];
+        result.translation[1] = matrix.columns[2].elements[1];
+        return result;
+    }
+
+    Matrix<3, 3> toMatrix() const
+    {
+        return { { { linear[0], linear[1], 0 },
+                   { linear[2], linear[3], 0 },
+                   { translation[0], translation[1], 1 } } };
+    }
+
+    /// this = this * other, so other is applied to points first
+    Affine2& compose(const Affine2& other);
+
+    Vector<2> transform(const Vector<2>& point) const
+    {
+        return { linear[0] * point.elements[0] +
+                     linear[2] * point.elements[1] + translation[0],
+                 linear[1] * point.elements[0] +
+                     linear[3] * point.elements[1] + translation[1] };
+    }
+};
+
+inline Affine2& Affine2::compose(const Affine2& other)
+{
+#if defined(OM_SIMD_SSE2)
+    // two bits of shuffle selector per lane, from lane 3 to lane 0
+    const __m128 matrix  = _mm_load_ps(linear);
+    const __m128 column0 = _mm_shuffle_ps(matrix, matrix, 0b01000100);
+    const __m128 column1 = _mm_shuffle_ps(matrix, matrix, 0b11101110);
+
+    // xs are (o0, o0, o2, o2), ys are (o1, o1, o3, o3)
+    const __m128 other4  = _mm_load_ps(other.linear);
+    const __m128 xs      = _mm_shuffle_ps(other4, other4, 0b10100000);
+    const __m128 ys      = _mm_shuffle_ps(other4, other4, 0b11110101);
+    const __m128 shift   = _mm_load_ps(other.translation);
+    const __m128 shiftXs = _mm_shuffle_ps(shift, shift, 0);
+    const __m128 shiftYs = _mm_shuffle_ps(shift, shift, 0b01010101);
+    _mm_store_ps(translation,
+                 _mm_add_ps(_mm_load_ps(translation),
+                            _mm_add_ps(_mm_mul_ps(column0, shiftXs),
+                                       _mm_mul_ps(column1, shiftYs))));
+    _mm_store_ps(linear, _mm_add_ps(_mm_mul_ps(column0, xs),
+                                    _mm_mul_ps(column1, ys)));
+#elif defined(OM_SIMD_NEON)
+    const float32x2_t   column0     = vld1_f32(linear);
+    const float32x2_t   column1     = vld1_f32(linear + 2);
+    const float32x4_t   columns0    = vcombine_f32(column0, column0);
+    const float32x4_t   columns1    = vcombine_f32(column1, column1);
+    const float32x4_t   otherMatrix = vld1q_f32(other.linear);
+    const float32x4x2_t xsYs        = vtrnq_f32(otherMatrix, otherMatrix);
+    const float32x2_t   otherShift  = vld1_f32(other.translation);
+    vst1_f32(translation,
+             vmla_lane_f32(vmla_lane_f32(vld1_f32(translation), column0,
+                                         otherShift, 0),
+                           column1, otherShift, 1));
+    vst1q_f32(linear, vmlaq_f32(vmulq_f32(columns0, xsYs.val[0]), columns1,
+                                xsYs.val[1]));
+#else
+    const Affine2 self{ *this };
+    for (size_t column = 0; column < 2; ++column)
+    {
+        linear[column * 2] = self.linear[0] * other.linear[column * 2] +
+                             self.linear[2] * other.linear[column * 2 + 1];
+        linear[column * 2 + 1] =
+            self.linear[1] * other.linear[column * 2] +
+            self.linear[3] * other.linear[column * 2 + 1];
+    }
+    translation[0] = self.linear[0] * other.translation[0] +
+                     self.linear[2] * other.translation[1] +
+                     self.translation[0];
+    translation[1] = self.linear[1] * other.translation[0] +
+                     self.linear[3] * other.translation[1] +
+                     self.translation[1];
+#endif
+    return *this;
+}
+
+OM_DECLSPEC inline void multiplicate(const Affine2& transform1,
+                                     const Affine2& transform2,
+                                     Affine2&       r_transform)
+{
+    r_transform = transform1;
+    r_transform.compose(transform2);
+}
+
+OM_DECLSPEC inline Affine2 operator*(const Affine2& transform1,
+                                     const Affine2& transform2)
+{
+    Affine2 result{ transform1 };
+    result.compose(transform2);
+    return result;
+}
+
+/// Transforms count points, two of them by one SIMD operation. Points and
+/// r_points may be the same array
+OM_DECLSPEC inline void transformPoints(const Affine2&   transform,
+                                        const Vector<2>* points,
+                                        size_t           count,
+                                        Vector<2>*       r_points)
+{
+    // two adjacent points are loaded as four packed floats
+    static_assert(sizeof(Vector<2>) == 2 * sizeof(myGlfloat));
+    static_assert(std::is_standard_layout_v<Vector<2>>);
+    size_t i = 0;
+#if defined(OM_SIMD_SSE2)
+    const __m128 matrix  = _mm_load_ps(transform.linear);
+    const __m128 column0 = _mm_shuffle_ps(matrix, matrix, 0b01000100);
+    const __m128 column1 = _mm_shuffle_ps(matrix, matrix, 0b11101110);
+    const __m128 shift   = _mm_load_ps(transform.translation);
+    const __m128 shifts  = _mm_shuffle_ps(shift, shift, 0b01000100);
+    for (; i + 2 <= count; i += 2)
+    {
+        // x0, y0, x1, y1
+        const __m128 pair = _mm_loadu_ps(points[i].elements);
+        const __m128 xs   = _mm_shuffle_ps(pair, pair, 0b10100000);
+        const __m128 ys   = _mm_shuffle_ps(pair, pair, 0b11110101);
+        _mm_storeu_ps(r_points[i].elements,
+                      _mm_add_ps(shifts, _mm_add_ps(_mm_mul_ps(column0, xs),
+                                                    _mm_mul_ps(column1, ys))));
+    }
+#elif defined(OM_SIMD_NEON)
+    const float32x2_t column0  = vld1_f32(transform.linear);
+    const float32x2_t column1  = vld1_f32(transform.linear + 2);
+    const float32x2_t shift    = vld1_f32(transform.translation);
+    const float32x4_t columns0 = vcombine_f32(column0, column0);
+    const float32x4_t columns1 = vcombine_f32(column1, column1);
+    const float32x4_t shifts   = vcombine_f32(shift, shift);
+    for (; i + 2 <= count; i += 2)
+    {
+        const float32x4_t   pair = vld1q_f32(points[i].elements);
+        const float32x4x2_t xsYs = vtrnq_f32(pair, pair);
+        vst1q_f32(r_points[i].elements,
+                  vmlaq_f32(vmlaq_f32(shifts, columns0, xsYs.val[0]),
+                            columns1, xsYs.val[1]));
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        r_points[i] = transform.transform(points[i]);
+    }
+}
+
+} // namespace om
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace om
+{
+/// Counts heap allocations of the whole program by replaced global operators
+/// new and delete, which are built only with OM_ALLOCATION_TRACKING option.
+/// Allocations are tagged by the innermost OM_TRACE_SCOPE of thread, counts
+/// of the last frame are published to MetricsRegistry as memory.* metrics
+class AllocationTracker
+{
+public:
+#ifdef OM_ALLOCATION_TRACKING
+    static constexpr bool isEnabled{ true };
+#else
+    static constexpr bool isEnabled{ false };
+#endif
+    /// Allocations out of scopes and of more scopes are counted as other
+    static constexpr size_t maxScopesCount{ 256 };
+
+    struct FrameStatistics
+    {
+        std::uint64_t allocations{};
+        std::uint64_t deallocations{};
+        std::uint64_t allocatedBytes{};
+        /// The highest live bytes during frame
+        std::uint64_t peakBytes{};
+        std::uint64_t liveBytes{};
+    };
+
+    enum class ZeroAllocationAction
+    {
+        report,
+        abort,
+    };
+
+    /// Publishes statistics of the finished frame, is called once per frame
+    /// before MetricsRegistry::finishFrame
+    static void            finishFrame();
+    static FrameStatistics getLastFrameStatistics();
+
+    /// While check is enabled, allocations of calling thread are reported
+    /// with call stack, every call site once. It asserts that steady state
+    /// frame doesn't allocate
+    static void setZeroAllocationCheck(bool isEnabled);
+    static void setZeroAllocationAction(ZeroAllocationAction action);
+};
+} // namespace om
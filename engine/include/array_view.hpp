@@ -0,0 +1,54 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <vector>
+
+namespace om
+{
+/// Non-owning view of contiguous elements, as std::span of C++20. Is passed
+/// by value, so vector with any allocator, array or braced list may be given
+/// to engine without copy. Braced list lives only until the end of call
+template <typename T>
+class ArrayView
+{
+public:
+    constexpr ArrayView() = default;
+    constexpr ArrayView(const T* data, size_t size)
+        : m_data{ data }
+        , m_size{ size }
+    {
+    }
+    template <typename Allocator>
+    ArrayView(const std::vector<T, Allocator>& vector)
+        : m_data{ vector.data() }
+        , m_size{ vector.size() }
+    {
+    }
+    template <size_t N>
+    constexpr ArrayView(const std::array<T, N>& array)
+        : m_data{ array.data() }
+        , m_size{ N }
+    {
+    }
+    constexpr ArrayView(std::initializer_list<T> list)
+        : m_data{ list.begin() }
+        , m_size{ list.size() }
+    {
+    }
+
+    constexpr const T* data() const { return m_data; }
+    constexpr size_t   size() const { return m_size; }
+    constexpr bool     empty() const { return m_size == 0; }
+
+    constexpr const T* begin() const { return m_data; }
+    constexpr const T* end() const { return m_data + m_size; }
+
+    constexpr const T& operator[](size_t index) const { return m_data[index]; }
+    constexpr const T& front() const { return m_data[0]; }
+
+private:
+    const T* m_data{};
+    size_t   m_size{};
+};
+} // namespace om
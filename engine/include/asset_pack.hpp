@@ -0,0 +1,51 @@
+#pragma once
+#include "array_view.hpp"
+#include "mapped_file.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace om
+{
+/// Resources in one file: header, index sorted by name, names and blobs
+/// aligned to blobAlignment. Pack is mapped to memory, so loaders read assets
+/// without copies and file system calls. Names are the same paths as of
+/// loose files, as "res/textures/planet.png". Numbers are in native byte
+/// order, pack is built on host by om_asset_packer
+class AssetPack
+{
+public:
+    static constexpr size_t           blobAlignment{ 64 };
+    static constexpr std::string_view defaultPath{ "res.pack" };
+
+    bool   open(const std::string& path);
+    bool   isOpen() const { return m_file.data != nullptr; }
+    size_t getAssetsCount() const { return m_assetsCount; }
+
+    /// Empty view if asset isn't packed
+    ArrayView<std::byte> find(std::string_view name) const;
+    /// Offset of asset found in pack. With size and modification time of
+    /// pack it identifies asset content, while pack isn't rebuilt
+    std::uint64_t getOffset(ArrayView<std::byte> asset) const
+    {
+        return static_cast<std::uint64_t>(asset.data() - m_file.data.get());
+    }
+    /// Ticks of the last write time of pack file, 0 if unknown
+    std::int64_t getModificationTime() const { return m_modificationTime; }
+
+    /// Packs files of directory recursively, they are named by path relative
+    /// to parent of directory
+    static bool write(const std::string& packPath,
+                      const std::string& directory);
+
+    /// Pack of defaultPath opened on the first call. Loaders fall back to
+    /// loose files if it's missing or asset isn't in it
+    static const AssetPack& getAssetPack();
+
+private:
+    MappedFile   m_file;
+    size_t       m_assetsCount{};
+    std::int64_t m_modificationTime{};
+};
+} // namespace om
@@ -11,6 +11,8 @@ public:
     explicit SoundTrack(std::string_view     path,
                         const SDL_AudioSpec& deviceAudioSpec);
     ~SoundTrack() override;
+    size_t getMemorySize() const override { return m_length; }
+
     uint_least8_t*   m_buffer{};
     uint_least32_t   m_length{};
     std::string_view m_path{};
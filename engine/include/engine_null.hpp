@@ -0,0 +1,234 @@
+#pragma once
+#include "iengine.hpp"
+#include "imgui_engine.hpp"
+#include <chrono>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace om
+{
+
+/// Engine without window and OpenGl context. Calls are recorded to command
+/// log and otherwise ignored, so CPU side of rendering (vertices building,
+/// matrices, ImGui) can be measured and checked on machine without display.
+/// Config is number of frames, after which turn_off event is sent, empty or
+/// zero - never
+class EngineNull : public IEngine
+{
+public:
+    struct Command
+    {
+        enum class Type
+        {
+            clear_window,
+            set_program,
+            set_uniform,
+            bind_texture,
+            draw,
+            update_window,
+        };
+        Type      type{};
+        ProgramId programId{};
+        TextureId textureId{};
+        /// Not copied, names are literals or strings owned by game objects
+        std::string_view uniformName;
+        /// Range of uniform parameters pool of the same frame
+        size_t    uniformParametersOffset{};
+        size_t    uniformParametersCount{};
+        ShapeType shapeType{};
+        size_t    verticesCount{};
+        size_t    indicesCount{};
+    };
+
+    struct Statistics
+    {
+        size_t                                    framesCount{};
+        size_t                                    drawCalls{};
+        size_t                                    vertices{};
+        size_t                                    indices{};
+        size_t                                    uniformSets{};
+        size_t                                    textureBinds{};
+        std::chrono::duration<double, std::milli> framesTime{};
+    };
+
+    std::string initialize(std::string_view windowName,
+                           std::string_view config) override;
+    bool        read_input(Event& e) override;
+    void        uninitialize() override;
+    ~EngineNull() override {}
+
+    /// Commands since last updateWindow
+    const std::vector<Command>& getCommandLog() const { return m_commandLog; }
+    /// Commands of the last finished frame
+    const std::vector<Command>& getLastFrameCommandLog() const
+    {
+        return m_lastFrameCommandLog;
+    }
+    /// Parameters of set_uniform commands of getCommandLog
+    const std::vector<myGlfloat>& getUniformParameters() const
+    {
+        return m_uniformParameters;
+    }
+    /// Parameters of set_uniform commands of getLastFrameCommandLog
+    const std::vector<myGlfloat>& getLastFrameUniformParameters() const
+    {
+        return m_lastFrameUniformParameters;
+    }
+    const Statistics& getStatistics() const { return m_statistics; }
+
+    ProgramId addProgram(const std::string_view& vertexShaderFileName,
+                         const std::string_view& fragmentShaderFileName,
+                         const std::vector<std::pair<myUint, std::string_view>>&
+                             attributes) override;
+
+    bool eraseProgram(ProgramId programId) override;
+
+    TextureId addTexture(const std::string_view& pathToTexture) override;
+
+    TextureId addTexture(const uint_least8_t* const pixels, const size_t w,
+                         const size_t h) override;
+
+    TextureId addTextureAsync(const std::string_view& pathToTexture) override;
+
+    size_t getPendingTexturesCount() const override;
+
+    bool eraseTexture(TextureId textureId) override;
+
+    size_t getTextureMemorySize(TextureId textureId) const override;
+
+    bool setCurrentDefaultProgram(ProgramId programId) override;
+
+    bool setUniform(std::string_view       uniformName,
+                    std::vector<myGlfloat> parameters,
+                    ProgramId              programId = ProgramId()) override;
+
+    bool setUniform(std::string_view uniformName, om::myGlfloat parameters,
+                    ProgramId programId = ProgramId()) override;
+
+    bool renderClearWindow(Color color = { 0, 0, 0, 0 }) override;
+    ///////////////////////////////////////////////////////////////////////////
+    void render(ArrayView<VertexWide>       vertices,
+                ArrayView<myUint>           indices,
+                ArrayView<TextureId>        textureIds,
+                ArrayView<std::string_view> textureAttributesNames,
+                const Matrix<3, 3>&         moveMatrix,
+                const std::string_view      moveUnifromName = "u_move_matrix",
+                ProgramId                   programId       = ProgramId(),
+                ShapeType type = ShapeType::triangle) override;
+
+    void render(ArrayView<VertexTextured>   vertices,
+                ArrayView<myUint>           indices,
+                ArrayView<TextureId>        textureIds,
+                ArrayView<std::string_view> textureAttributesNames,
+                const Matrix<3, 3>&         moveMatrix,
+                const std::string_view      moveUnifromName = "u_move_matrix",
+                ProgramId                   programId       = ProgramId(),
+                ShapeType type = ShapeType::triangle) override;
+
+    void render(ArrayView<VertexMorphed> vertices,
+                ArrayView<myUint>        indices,
+                const Matrix<3, 3>&      moveMatrix,
+                const std::string_view   moveUnifromName = "u_move_matrix",
+                ProgramId                programId       = ProgramId(),
+                ShapeType                type = ShapeType::triangle) override;
+
+    void render(ArrayView<Vertex> vertices, ArrayView<myUint> indices,
+                const Matrix<3, 3>&    moveMatrix,
+                const std::string_view moveUnifromName = "u_move_matrix",
+                ProgramId              programId       = ProgramId(),
+                ShapeType              type = ShapeType::triangle) override;
+    ///////////////////////////////////////////////////////////////////////////
+    void render(ArrayView<VertexWide>       vertices,
+                ArrayView<myUint>           indices,
+                ArrayView<TextureId>        textureIds,
+                ArrayView<std::string_view> textureAttributesNames,
+                ProgramId                   programId = ProgramId(),
+                ShapeType type = ShapeType::triangle) override;
+
+    void render(ArrayView<VertexTextured>   vertices,
+                ArrayView<myUint>           indices,
+                ArrayView<TextureId>        textureIds,
+                ArrayView<std::string_view> textureAttributesNames,
+                ProgramId                   programId = ProgramId(),
+                ShapeType type = ShapeType::triangle) override;
+
+    void render(ArrayView<VertexMorphed> vertices,
+                ArrayView<myUint>        indices,
+                ProgramId                programId = ProgramId(),
+                ShapeType type = ShapeType::triangle) override;
+
+    void render(ArrayView<Vertex> vertices, ArrayView<myUint> indices,
+                ProgramId programId = ProgramId(),
+                ShapeType type      = ShapeType::triangle) override;
+    ///////////////////////////////////////////////////////////////////////////
+    void renderTriangle(const Triangle<Vertex>& t,
+                        ProgramId programId = ProgramId()) override;
+
+    bool updateWindow(Color fillingColor = { 0, 0, 0, 0 }) override;
+
+    ISoundTrack*  addSoundTrack(std::string_view path) override;
+    void          eraseSoundTrack(ISoundTrack* soundTrack) override;
+    ISoundBuffer* addSoundBuffer(ISoundTrack* soundTrack) override;
+    void playSoundBufferOnce(ISoundTrack* soundTrack, om::myGlfloat volume = 1,
+                             om::myGlfloat leftRightBalance = 0,
+                             om::myGlfloat stereo           = 0) override;
+    void eraseSoundBuffer(ISoundBuffer* soundBuffer) override;
+
+    std::array<myGlfloat, 2> getDrawableInchesSize() override;
+    std::array<int, 2>       getDrawablePixelSize() override;
+
+    std::array<int, 2> getDisplayPixelSize() override;
+    int                getDisplayRefreshRate() override;
+
+    void uiNewFrame() override;
+
+protected:
+    /// Current default program if programId is not added
+    ProgramId findProgram(ProgramId programId) const;
+    /// Renders ImGui frame if it was started, before frame is finished
+    void      uiRender();
+
+private:
+    void recordTextures(ArrayView<TextureId> textureIds);
+    /// Takes the last parametersCount values of uniform parameters pool,
+    /// they are removed if program is not found
+    bool recordUniform(std::string_view uniformName, size_t parametersCount,
+                       ProgramId programId);
+    void recordMoveMatrix(const std::string_view moveUnifromName,
+                          const Matrix<3, 3>&    moveMatrix,
+                          ProgramId              programId);
+    void recordDraw(size_t verticesCount, ArrayView<myUint> indices,
+                    ShapeType type, ProgramId programId);
+
+    using clock_t = std::chrono::steady_clock;
+
+    std::vector<Command>   m_commandLog;
+    std::vector<Command>   m_lastFrameCommandLog;
+    std::vector<myGlfloat> m_uniformParameters;
+    std::vector<myGlfloat> m_lastFrameUniformParameters;
+    Statistics             m_statistics;
+    size_t                 m_maxFramesCount{};
+    clock_t::time_point    m_frameStartTime{};
+
+    ProgramId m_currentProgramId{};
+    ProgramId lastProgramId{};
+    std::unordered_set<ProgramId, MyIdsHash<ProgramId>> m_programs;
+
+    TextureId lastTextureId{};
+    std::unordered_set<TextureId, MyIdsHash<TextureId>> m_textures;
+
+    std::vector<std::unique_ptr<ISoundTrack>>  m_soundTracks;
+    std::vector<std::unique_ptr<ISoundBuffer>> m_soundBuffers;
+
+    bool        m_isUiNewFrameEvoked{};
+    ImguiEngine m_imguiEngine;
+
+    static constexpr int       nullPixelWidth{ 1920 };
+    static constexpr int       nullPixelHeight{ 1080 };
+    static constexpr myGlfloat nullInchesPerPixel{ 1.f / 96 };
+    static constexpr int       nullRefreshRate{ 60 };
+};
+} // end namespace om
@@ -10,12 +10,16 @@
 #else
 #include <SDL.h>
 #endif
+#include <chrono>
 #include <forward_list>
+#include <future>
 #include <glad.h>
 #include <iosfwd>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace om
 {
@@ -44,8 +48,14 @@ public:
     TextureId addTexture(const uint_least8_t* const pixels, const size_t w,
                          const size_t h) override;
 
+    TextureId addTextureAsync(const std::string_view& pathToTexture) override;
+
+    size_t getPendingTexturesCount() const override;
+
     bool eraseTexture(TextureId textureId) override;
 
+    size_t getTextureMemorySize(TextureId textureId) const override;
+
     bool setCurrentDefaultProgram(ProgramId programId) override;
 
     bool setUniform(std::string_view       uniformName,
@@ -57,61 +67,59 @@ public:
 
     bool renderClearWindow(Color color = { 0, 0, 0, 0 }) override;
     ///////////////////////////////////////////////////////////////////////////
-    void render(const std::vector<VertexWide>&       vertices,
-                const std::vector<myUint>&           indices,
-                const std::vector<TextureId>&        textureIds,
-                const std::vector<std::string_view>& textureAttributesNames,
-                const Matrix<3, 3>&                  moveMatrix,
-                const std::string_view moveUnifromName = "u_move_matrix",
-                ProgramId              programId       = ProgramId(),
-                ShapeType              type = ShapeType::triangle) override;
+    void render(ArrayView<VertexWide>       vertices,
+                ArrayView<myUint>           indices,
+                ArrayView<TextureId>        textureIds,
+                ArrayView<std::string_view> textureAttributesNames,
+                const Matrix<3, 3>&         moveMatrix,
+                const std::string_view      moveUnifromName = "u_move_matrix",
+                ProgramId                   programId       = ProgramId(),
+                ShapeType type = ShapeType::triangle) override;
 
-    void render(const std::vector<VertexTextured>&   vertices,
-                const std::vector<myUint>&           indices,
-                const std::vector<TextureId>&        textureIds,
-                const std::vector<std::string_view>& textureAttributesNames,
-                const Matrix<3, 3>&                  moveMatrix,
-                const std::string_view moveUnifromName = "u_move_matrix",
-                ProgramId              programId       = ProgramId(),
-                ShapeType              type = ShapeType::triangle) override;
+    void render(ArrayView<VertexTextured>   vertices,
+                ArrayView<myUint>           indices,
+                ArrayView<TextureId>        textureIds,
+                ArrayView<std::string_view> textureAttributesNames,
+                const Matrix<3, 3>&         moveMatrix,
+                const std::string_view      moveUnifromName = "u_move_matrix",
+                ProgramId                   programId       = ProgramId(),
+                ShapeType type = ShapeType::triangle) override;
+
+    void render(ArrayView<VertexMorphed> vertices,
+                ArrayView<myUint>        indices,
+                const Matrix<3, 3>&      moveMatrix,
+                const std::string_view   moveUnifromName = "u_move_matrix",
+                ProgramId                programId       = ProgramId(),
+                ShapeType                type = ShapeType::triangle) override;
 
-    void render(const std::vector<VertexMorphed>& vertices,
-                const std::vector<myUint>&        indices,
-                const Matrix<3, 3>&               moveMatrix,
+    void render(ArrayView<Vertex> vertices, ArrayView<myUint> indices,
+                const Matrix<3, 3>&    moveMatrix,
                 const std::string_view moveUnifromName = "u_move_matrix",
                 ProgramId              programId       = ProgramId(),
                 ShapeType              type = ShapeType::triangle) override;
-
-    void render(const std::vector<Vertex>& vertices,
-                const std::vector<myUint>& indices,
-                const Matrix<3, 3>&        moveMatrix,
-                const std::string_view     moveUnifromName = "u_move_matrix",
-                ProgramId                  programId       = ProgramId(),
-                ShapeType                  type = ShapeType::triangle) override;
     ///////////////////////////////////////////////////////////////////////////
-    void render(const std::vector<VertexWide>&       vertices,
-                const std::vector<myUint>&           indices,
-                const std::vector<TextureId>&        textureIds,
-                const std::vector<std::string_view>& textureAttributesNames,
-                ProgramId                            programId = ProgramId(),
+    void render(ArrayView<VertexWide>       vertices,
+                ArrayView<myUint>           indices,
+                ArrayView<TextureId>        textureIds,
+                ArrayView<std::string_view> textureAttributesNames,
+                ProgramId                   programId = ProgramId(),
                 ShapeType type = ShapeType::triangle) override;
 
-    void render(const std::vector<VertexTextured>&   vertices,
-                const std::vector<myUint>&           indices,
-                const std::vector<TextureId>&        textureIds,
-                const std::vector<std::string_view>& textureAttributesNames,
-                ProgramId                            programId = ProgramId(),
+    void render(ArrayView<VertexTextured>   vertices,
+                ArrayView<myUint>           indices,
+                ArrayView<TextureId>        textureIds,
+                ArrayView<std::string_view> textureAttributesNames,
+                ProgramId                   programId = ProgramId(),
                 ShapeType type = ShapeType::triangle) override;
 
-    void render(const std::vector<VertexMorphed>& vertices,
-                const std::vector<myUint>&        indices,
-                ProgramId                         programId = ProgramId(),
+    void render(ArrayView<VertexMorphed> vertices,
+                ArrayView<myUint>        indices,
+                ProgramId                programId = ProgramId(),
                 ShapeType type = ShapeType::triangle) override;
 
-    void render(const std::vector<Vertex>& vertices,
-                const std::vector<myUint>& indices,
-                ProgramId                  programId = ProgramId(),
-                ShapeType                  type = ShapeType::triangle) override;
+    void render(ArrayView<Vertex> vertices, ArrayView<myUint> indices,
+                ProgramId programId = ProgramId(),
+                ShapeType type      = ShapeType::triangle) override;
     ///////////////////////////////////////////////////////////////////////////
     void renderTriangle(const Triangle<Vertex>& t,
                         ProgramId programId = ProgramId()) override;
@@ -138,6 +146,8 @@ private:
     bool initSdl(std::stringstream& serr);
     bool initSdlWindow(std::string_view windowName, std::stringstream& serr);
     bool initOpenGl(std::stringstream& serr);
+    void initCacheDirectories(std::string_view windowName);
+    void initProgramCacheDriver();
 
     bool loadGLFunctionsPointers(std::stringstream& serr);
 
@@ -148,18 +158,19 @@ private:
     void       setAdditionalGlParameters();
     GlProgram* findProgram(ProgramId programId);
     GlTexture* findTexture(TextureId textureId);
+    /// Uploads decoded textures and streams required mip levels
+    void       uploadTextures();
 
     template <typename T, typename = std::enable_if_t<is_vertex<T>>>
-    void renderInternal(const std::vector<T>&      vertices,
-                        const std::vector<myUint>& indices, ShapeType type,
-                        ProgramId programId);
+    void renderInternal(ArrayView<T> vertices, ArrayView<myUint> indices,
+                        ShapeType type, ProgramId programId);
 
     template <typename T, typename = std::enable_if_t<is_texture_vertex<T>>>
     void renderTexturedInternal(
-        const std::vector<T>& vertices, const std::vector<myUint>& indices,
-        std::vector<TextureId>        textureIds,
-        std::vector<std::string_view> textureAttributesNames, ShapeType type,
-        ProgramId programId);
+        ArrayView<T> vertices, ArrayView<myUint> indices,
+        ArrayView<TextureId>        textureIds,
+        ArrayView<std::string_view> textureAttributesNames,
+        const Matrix<3, 3>& moveMatrix, ShapeType type, ProgramId programId);
 
     template <typename T, typename = std::enable_if_t<is_vertex<T>>>
     void renderTriangleInternal(const Triangle<T>& t, ProgramId programId);
@@ -187,6 +198,10 @@ private:
     myGlfloat m_displayHeightDpi{};
     int       m_displayRefreshRate{};
 
+    /// Size of viewport, kept on every glViewport, so it isn't queried
+    /// from driver on every draw
+    std::array<int, 2> m_drawablePixelSize{};
+
     SDL_GLContext m_glContext{};
 
     GlProgram* m_currentProgram{};
@@ -197,11 +212,24 @@ private:
     TextureId  lastTextureId{};
     std::unordered_map<TextureId, GlTexture, MyIdsHash<TextureId>> m_textures;
 
+    using DecodingResult = std::optional<GlTexture::DecodedImage>;
+    std::unordered_map<TextureId, std::future<DecodingResult>,
+                       MyIdsHash<TextureId>>
+                             m_pendingTextures;
+    std::optional<GlTexture> m_placeholderTexture;
+    /// Textures which failed to load asynchronously, they are drawn as
+    /// placeholder until erased
+    std::unordered_set<TextureId, MyIdsHash<TextureId>> m_failedTextures;
+
     static constexpr int creatingSdlWindowFlags{ SDL_WINDOW_OPENGL |
                                                  SDL_WINDOW_RESIZABLE |
                                                  SDL_WINDOW_SHOWN |
                                                  SDL_WINDOW_ALLOW_HIGHDPI };
 
+    /// Uploads of decoded textures and streaming of mip levels stop after
+    /// this time per frame, at least one decoded texture is uploaded
+    static constexpr std::chrono::milliseconds textureUploadBudget{ 4 };
+
     static constexpr myGlfloat initialWpixels{ 960 };
     static constexpr myGlfloat initialHpixels{ 540 };
 
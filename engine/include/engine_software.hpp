@@ -0,0 +1,124 @@
+#pragma once
+#include "engine_null.hpp"
+#include "software_rasterizer.hpp"
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace om
+{
+
+/// Engine without window and GPU, triangles are drawn by SoftwareRasterizer
+/// with the same transform, texturing and blending as game shaders. Calls
+/// are also recorded as by EngineNull. Config is
+/// "<frames>[\n<png directory>[\n<png period>]]", every png period frame is
+/// written to png directory as frame_<number>.png
+class EngineSoftware : public EngineNull
+{
+public:
+    static constexpr char configSeparator{ '\n' };
+
+    std::string initialize(std::string_view windowName,
+                           std::string_view config) override;
+    void        uninitialize() override;
+
+    const SoftwareRasterizer* getRasterizer() const
+    {
+        return m_rasterizer ? &*m_rasterizer : nullptr;
+    }
+
+    TextureId addTexture(const std::string_view& pathToTexture) override;
+
+    TextureId addTexture(const uint_least8_t* const pixels, const size_t w,
+                         const size_t h) override;
+
+    bool eraseTexture(TextureId textureId) override;
+
+    size_t getTextureMemorySize(TextureId textureId) const override;
+
+    bool renderClearWindow(Color color = { 0, 0, 0, 0 }) override;
+    ///////////////////////////////////////////////////////////////////////////
+    void render(ArrayView<VertexWide>       vertices,
+                ArrayView<myUint>           indices,
+                ArrayView<TextureId>        textureIds,
+                ArrayView<std::string_view> textureAttributesNames,
+                const Matrix<3, 3>&         moveMatrix,
+                const std::string_view      moveUnifromName = "u_move_matrix",
+                ProgramId                   programId       = ProgramId(),
+                ShapeType type = ShapeType::triangle) override;
+
+    void render(ArrayView<VertexTextured>   vertices,
+                ArrayView<myUint>           indices,
+                ArrayView<TextureId>        textureIds,
+                ArrayView<std::string_view> textureAttributesNames,
+                const Matrix<3, 3>&         moveMatrix,
+                const std::string_view      moveUnifromName = "u_move_matrix",
+                ProgramId                   programId       = ProgramId(),
+                ShapeType type = ShapeType::triangle) override;
+
+    void render(ArrayView<VertexMorphed> vertices,
+                ArrayView<myUint>        indices,
+                const Matrix<3, 3>&      moveMatrix,
+                const std::string_view   moveUnifromName = "u_move_matrix",
+                ProgramId                programId       = ProgramId(),
+                ShapeType                type = ShapeType::triangle) override;
+
+    void render(ArrayView<Vertex> vertices, ArrayView<myUint> indices,
+                const Matrix<3, 3>&    moveMatrix,
+                const std::string_view moveUnifromName = "u_move_matrix",
+                ProgramId              programId       = ProgramId(),
+                ShapeType              type = ShapeType::triangle) override;
+    ///////////////////////////////////////////////////////////////////////////
+    void render(ArrayView<VertexWide>       vertices,
+                ArrayView<myUint>           indices,
+                ArrayView<TextureId>        textureIds,
+                ArrayView<std::string_view> textureAttributesNames,
+                ProgramId                   programId = ProgramId(),
+                ShapeType type = ShapeType::triangle) override;
+
+    void render(ArrayView<VertexTextured>   vertices,
+                ArrayView<myUint>           indices,
+                ArrayView<TextureId>        textureIds,
+                ArrayView<std::string_view> textureAttributesNames,
+                ProgramId                   programId = ProgramId(),
+                ShapeType type = ShapeType::triangle) override;
+
+    void render(ArrayView<VertexMorphed> vertices,
+                ArrayView<myUint>        indices,
+                ProgramId                programId = ProgramId(),
+                ShapeType type = ShapeType::triangle) override;
+
+    void render(ArrayView<Vertex> vertices, ArrayView<myUint> indices,
+                ProgramId programId = ProgramId(),
+                ShapeType type      = ShapeType::triangle) override;
+    ///////////////////////////////////////////////////////////////////////////
+    void renderTriangle(const Triangle<Vertex>& t,
+                        ProgramId programId = ProgramId()) override;
+
+    bool updateWindow(Color fillingColor = { 0, 0, 0, 0 }) override;
+
+private:
+    using TexturePtr = std::shared_ptr<const SoftwareRasterizer::Texture>;
+
+    /// Move matrix stays set for program, as OpenGl uniform
+    const Matrix<3, 3>& setMoveMatrix(ProgramId           programId,
+                                      const Matrix<3, 3>& moveMatrix);
+    const Matrix<3, 3>& findMoveMatrix(ProgramId programId);
+
+    template <typename T, typename = std::enable_if_t<is_vertex<T>>>
+    void rasterizeInternal(ArrayView<T> vertices, ArrayView<myUint> indices,
+                           ArrayView<TextureId> textureIds,
+                           const Matrix<3, 3>& moveMatrix, ShapeType type);
+
+    std::optional<SoftwareRasterizer> m_rasterizer;
+    std::string                       m_pngDirectory;
+    size_t                            m_pngPeriod{ 1 };
+    size_t                            m_framesCount{};
+
+    std::unordered_map<TextureId, TexturePtr, MyIdsHash<TextureId>>
+        m_texturesPixels;
+    std::unordered_map<ProgramId, Matrix<3, 3>, MyIdsHash<ProgramId>>
+        m_moveMatrices;
+};
+} // end namespace om
@@ -0,0 +1,36 @@
+#pragma once
+#include "array_view.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+namespace om
+{
+constexpr std::uint64_t fnv1aBasis{ 14695981039346656037ull };
+
+/// FNV-1a of data. Hash of previous data may be given to continue it
+std::uint64_t calcFnv1a(ArrayView<std::byte> data,
+                        std::uint64_t        hash = fnv1aBasis);
+
+/// File written under unique temporary name and renamed on commit, so readers
+/// never see it half written. Temporary file is removed if commit is not done
+class AtomicFileWriter
+{
+public:
+    explicit AtomicFileWriter(std::string path);
+    ~AtomicFileWriter();
+    AtomicFileWriter(const AtomicFileWriter&) = delete;
+    AtomicFileWriter& operator=(const AtomicFileWriter&) = delete;
+
+    std::ofstream& getStream() { return m_file; }
+    /// False if writing or renaming failed, error is printed
+    bool commit();
+
+private:
+    std::string   m_path;
+    std::string   m_temporaryPath;
+    std::ofstream m_file;
+    bool          m_isCommitted{};
+};
+} // namespace om
@@ -0,0 +1,102 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace om
+{
+/// Monotonic memory for temporaries of one frame. Allocation moves top of
+/// the last block, memory is released all at once by reset, which engine
+/// calls in updateWindow. If frame doesn't fit to one block, blocks are
+/// merged on reset, so the next frames don't allocate from heap at all.
+/// Isn't thread safe, the frame arena is used by render thread only
+class FrameArena
+{
+public:
+    static constexpr size_t defaultBlockSize{ 64 * 1024 };
+
+    explicit FrameArena(size_t blockSize = defaultBlockSize);
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    void* allocate(size_t size, size_t alignment);
+    /// Only the last allocation is returned to arena, as vector growth
+    void deallocate(void* pointer, size_t size);
+    /// Invalidates all allocated memory
+    void reset();
+
+    size_t getUsedSize() const;
+    size_t getCapacity() const;
+
+    /// Arena reset by updateWindow of engine
+    static FrameArena& getFrameArena();
+
+private:
+    struct Block
+    {
+        std::unique_ptr<std::byte[]> data;
+        size_t                       size{};
+    };
+
+    void addBlock(size_t size);
+
+    std::vector<Block> m_blocks;
+    size_t             m_blockSize{};
+    size_t             m_offset{};
+    size_t             m_previousBlocksUsedSize{};
+};
+
+/// Allocator of standard containers from frame arena. Container must not be
+/// used after the end of frame
+template <typename T>
+class FrameAllocator
+{
+public:
+    using value_type = T;
+
+    FrameAllocator() noexcept
+        : m_arena{ &FrameArena::getFrameArena() }
+    {
+    }
+    explicit FrameAllocator(FrameArena& arena) noexcept
+        : m_arena{ &arena }
+    {
+    }
+    template <typename U>
+    FrameAllocator(const FrameAllocator<U>& other) noexcept
+        : m_arena{ &other.getArena() }
+    {
+    }
+
+    T* allocate(size_t count)
+    {
+        return static_cast<T*>(
+            m_arena->allocate(count * sizeof(T), alignof(T)));
+    }
+    void deallocate(T* pointer, size_t count) noexcept
+    {
+        m_arena->deallocate(pointer, count * sizeof(T));
+    }
+
+    FrameArena& getArena() const noexcept { return *m_arena; }
+
+    template <typename U>
+    friend bool operator==(const FrameAllocator&    first,
+                           const FrameAllocator<U>& second)
+    {
+        return &first.getArena() == &second.getArena();
+    }
+    template <typename U>
+    friend bool operator!=(const FrameAllocator&    first,
+                           const FrameAllocator<U>& second)
+    {
+        return !(first == second);
+    }
+
+private:
+    FrameArena* m_arena;
+};
+
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+} // namespace om
@@ -3,6 +3,7 @@
 #include "iengine.hpp"
 #include "matrix.hpp"
 #include "opengl_debug.hpp"
+#include <cstdint>
 #include <glad.h>
 #include <iostream>
 #include <string>
@@ -34,8 +35,8 @@ public:
     bool setUniform(std::string_view            uniformName,
                     const std::vector<GLfloat>& parameters);
 
-    bool setTextures(const std::vector<std::string_view>& textureUniformName,
-                     const std::vector<GlTexture*>&       texture);
+    bool setTextures(ArrayView<std::string_view> textureUniformName,
+                     ArrayView<GlTexture*>       texture);
     bool setTexture(std::string_view textureUniformName, GlTexture* texture);
 
     template <size_t n, size_t m>
@@ -46,8 +47,18 @@ public:
 
     bool validate();
 
+    /// Program was created from binary of ProgramCache without compiling
+    bool isLoadedFromCache() const { return m_isLoadedFromCache; }
+
 private:
-    bool initShader(const std::string_view& shaderFileName, GLenum type,
+    static bool readShaderSource(const std::string_view& shaderFileName,
+                                 std::string&            r_shaderSrc,
+                                 std::stringstream&      serr);
+
+    bool loadProgramBinary(std::uint64_t cacheKey);
+    void storeProgramBinary(std::uint64_t cacheKey);
+
+    bool initShader(const std::string& shaderSrc, GLenum type,
                     GLuint& r_shader, const std::string_view& versionLine,
                     std::stringstream& serr);
 
@@ -78,6 +89,7 @@ private:
     }
     GLuint                  m_programId{};
     GLenum                  m_nextTextureUnit{};
+    bool                    m_isLoadedFromCache{};
     static constexpr GLenum maxNumberOfTexturesForProgram{ 16 };
 };
 
@@ -1,16 +1,48 @@
 #pragma once
+#include "array_view.hpp"
 #include "glad.h"
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <optional>
 #include <sstream>
 #include <string_view>
 #include <vector>
 
 namespace om
 {
+using myGlfloat = float;
+
 class GlTexture
 {
 public:
+    /// RGBA pixels of decoded png, level 0 is followed by smaller mip levels
+    struct DecodedImage
+    {
+        std::vector<std::byte> pixels;
+        /// Set instead of pixels if they are mapped from texture cache
+        std::shared_ptr<const std::byte> mappedPixels;
+        size_t                           w{};
+        size_t                           h{};
+        size_t                           levelsCount{ 1 };
+
+        const std::byte* data() const
+        {
+            return mappedPixels ? mappedPixels.get() : pixels.data();
+        }
+        size_t getLevelW(size_t level) const;
+        size_t getLevelH(size_t level) const;
+        size_t getLevelOffset(size_t level) const;
+        /// Number of levels down to 1x1
+        size_t getFullChainLevelsCount() const;
+    };
+
     explicit GlTexture(const std::string_view filePath);
 
+    /// Only coarse mip levels are uploaded, finer ones are streamed when
+    /// requested
+    explicit GlTexture(DecodedImage image);
+
     GlTexture(const uint_least8_t* const pixels, const size_t w,
               const size_t h);
 
@@ -28,8 +60,30 @@ public:
     bool getW() { return m_w; }
     bool getH() { return m_h; }
 
+    /// Texture is drawn with these derivatives of texture coordinates by
+    /// screen pixels (du/dx, dv/dx, du/dy, dv/dy), mip level sampled for
+    /// them becomes required
+    void requestDetail(const std::array<myGlfloat, 4>& texCoordDerivatives);
+    bool isStreamingNeeded() const { return m_requiredLevel < m_baseLevel; }
+    /// Uploads one level finer than resident ones
+    bool streamNextLevel();
+    size_t getBaseLevel() const { return m_baseLevel; }
+    /// Bytes of uploaded levels
+    size_t getMemorySize() const;
+
+    /// Reads and decodes png file without OpenGl calls, so it can be called
+    /// from any thread. Uses TextureCache and fills it
+    static bool decodeFile(const std::string_view filePath,
+                           DecodedImage&          r_image);
+    /// Decodes png in memory, as asset of pack. Name is key of TextureCache
+    static bool decodePng(const std::string_view name,
+                          ArrayView<std::byte>   png,
+                          DecodedImage&          r_image);
+
 private:
     bool loadTexture(const std::string_view filePath);
+    bool generateOpenGlTexture(DecodedImage image);
+    bool uploadLevel(size_t level);
     bool generateOpenGlTexture(const uint_least8_t* const textureDecodedData,
                                const unsigned long        wTexture,
                                const unsigned long        hTexture,
@@ -40,6 +94,13 @@ private:
     size_t m_w{};
     size_t m_h{};
 
+    /// Source of not uploaded levels, released when level 0 is uploaded
+    std::optional<DecodedImage> m_mipChain;
+    size_t                      m_baseLevel{};
+    size_t                      m_requiredLevel{};
+
     static constexpr GLenum hardcodedTextureType{ GL_TEXTURE_2D };
+    /// Levels bigger than it are not uploaded until requested
+    static constexpr size_t initialResidentSize{ 256 };
 };
 } // namespace om
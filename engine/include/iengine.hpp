@@ -1,4 +1,5 @@
 #pragma once
+#include "array_view.hpp"
 #include "matrix.hpp"
 #include "vertex.hpp"
 #include <array>
@@ -84,6 +85,8 @@ enum class OM_DECLSPEC EventType : size_t
     button1_released,
     button2_pressed, // middle key of mouse
     button2_released,
+    button3_pressed, // F9
+    button3_released,
 
     cursor_motion,
     wheel_rolled,
@@ -113,6 +116,8 @@ class OM_DECLSPEC ISoundTrack
 {
 public:
     virtual ~ISoundTrack() {}
+    /// Bytes of decoded samples
+    virtual size_t getMemorySize() const { return 0; }
 };
 
 class OM_DECLSPEC ISoundBuffer
@@ -143,6 +148,10 @@ public:
     enum class EngineTypes : size_t
     {
         sdl,
+        /// without window, calls are recorded for benchmarks and tests
+        null,
+        /// without window and GPU, frames are drawn by CPU to png files
+        software,
         max_types,
     };
     virtual ~IEngine() noexcept {}
@@ -167,8 +176,20 @@ public:
     virtual TextureId addTexture(const uint_least8_t* const pixels,
                                  const size_t w, const size_t h) = 0;
 
+    /// Returns id at once, png is decoded on worker thread and uploaded by
+    /// updateWindow within per frame time budget. Until upload texture is
+    /// drawn as transparent placeholder
+    virtual TextureId addTextureAsync(
+        const std::string_view& pathToTexture) = 0;
+
+    /// Textures added by addTextureAsync and not uploaded yet
+    virtual size_t getPendingTexturesCount() const = 0;
+
     virtual bool eraseTexture(TextureId textureId) = 0;
 
+    /// Bytes of texture levels in video memory, 0 until texture is uploaded
+    virtual size_t getTextureMemorySize(TextureId textureId) const = 0;
+
     virtual bool setCurrentDefaultProgram(ProgramId programId) = 0;
 
     virtual bool setUniform(std::string_view       uniformName,
@@ -181,65 +202,64 @@ public:
     virtual bool renderClearWindow(Color color = { 0, 0, 0, 0 }) = 0;
 
     virtual void render(
-        const std::vector<VertexWide>&       vertices,
-        const std::vector<myUint>&           indices,
-        const std::vector<TextureId>&        textureIds,
-        const std::vector<std::string_view>& textureAttributesNames,
-        const Matrix<3, 3>&                  moveMatrix,
-        const std::string_view               moveUnifromName = "u_move_matrix",
-        ProgramId                            programId       = ProgramId(),
-        ShapeType                            type = ShapeType::triangle) = 0;
+        ArrayView<VertexWide>       vertices,
+        ArrayView<myUint>           indices,
+        ArrayView<TextureId>        textureIds,
+        ArrayView<std::string_view> textureAttributesNames,
+        const Matrix<3, 3>&         moveMatrix,
+        const std::string_view      moveUnifromName = "u_move_matrix",
+        ProgramId                   programId       = ProgramId(),
+        ShapeType                   type = ShapeType::triangle) = 0;
 
     virtual void render(
-        const std::vector<VertexTextured>&   vertices,
-        const std::vector<myUint>&           indices,
-        const std::vector<TextureId>&        textureIds,
-        const std::vector<std::string_view>& textureAttributesNames,
-        const Matrix<3, 3>&                  moveMatrix,
-        const std::string_view               moveUnifromName = "u_move_matrix",
-        ProgramId                            programId       = ProgramId(),
-        ShapeType                            type = ShapeType::triangle) = 0;
+        ArrayView<VertexTextured>   vertices,
+        ArrayView<myUint>           indices,
+        ArrayView<TextureId>        textureIds,
+        ArrayView<std::string_view> textureAttributesNames,
+        const Matrix<3, 3>&         moveMatrix,
+        const std::string_view      moveUnifromName = "u_move_matrix",
+        ProgramId                   programId       = ProgramId(),
+        ShapeType                   type = ShapeType::triangle) = 0;
 
     virtual void render(
-        const std::vector<VertexMorphed>& vertices,
-        const std::vector<myUint>& indices, const Matrix<3, 3>& moveMatrix,
-        const std::string_view moveUnifromName = "u_move_matrix",
-        ProgramId              programId       = ProgramId(),
-        ShapeType              type            = ShapeType::triangle) = 0;
+        ArrayView<VertexMorphed> vertices, ArrayView<myUint> indices,
+        const Matrix<3, 3>&      moveMatrix,
+        const std::string_view   moveUnifromName = "u_move_matrix",
+        ProgramId                programId       = ProgramId(),
+        ShapeType                type            = ShapeType::triangle) = 0;
 
     virtual void render(
-        const std::vector<Vertex>& vertices, const std::vector<myUint>& indices,
+        ArrayView<Vertex> vertices, ArrayView<myUint> indices,
         const Matrix<3, 3>&    moveMatrix,
         const std::string_view moveUnifromName = "u_move_matrix",
         ProgramId              programId       = ProgramId(),
         ShapeType              type            = ShapeType::triangle) = 0;
 
     virtual void render(
-        const std::vector<VertexWide>&       vertices,
-        const std::vector<myUint>&           indices,
-        const std::vector<TextureId>&        textureIds,
-        const std::vector<std::string_view>& textureAttributesNames,
-        ProgramId                            programId = ProgramId(),
-        ShapeType                            type = ShapeType::triangle) = 0;
+        ArrayView<VertexWide>       vertices,
+        ArrayView<myUint>           indices,
+        ArrayView<TextureId>        textureIds,
+        ArrayView<std::string_view> textureAttributesNames,
+        ProgramId                   programId = ProgramId(),
+        ShapeType                   type      = ShapeType::triangle) = 0;
 
     virtual void render(
-        const std::vector<VertexTextured>&   vertices,
-        const std::vector<myUint>&           indices,
-        const std::vector<TextureId>&        textureIds,
-        const std::vector<std::string_view>& textureAttributesNames,
-        ProgramId                            programId = ProgramId(),
-        ShapeType                            type = ShapeType::triangle) = 0;
-
-    virtual void render(const std::vector<VertexMorphed>& vertices,
-                        const std::vector<myUint>&        indices,
+        ArrayView<VertexTextured>   vertices,
+        ArrayView<myUint>           indices,
+        ArrayView<TextureId>        textureIds,
+        ArrayView<std::string_view> textureAttributesNames,
+        ProgramId                   programId = ProgramId(),
+        ShapeType                   type      = ShapeType::triangle) = 0;
+
+    virtual void render(ArrayView<VertexMorphed> vertices,
+                        ArrayView<myUint>        indices,
+                        ProgramId                programId = ProgramId(),
+                        ShapeType type = ShapeType::triangle) = 0;
+
+    virtual void render(ArrayView<Vertex> vertices, ArrayView<myUint> indices,
                         ProgramId programId = ProgramId(),
                         ShapeType type      = ShapeType::triangle) = 0;
 
-    virtual void render(const std::vector<Vertex>& vertices,
-                        const std::vector<myUint>& indices,
-                        ProgramId                  programId = ProgramId(),
-                        ShapeType type = ShapeType::triangle) = 0;
-
     virtual void renderTriangle(const Triangle<Vertex>& t,
                                 ProgramId programId = ProgramId()) = 0;
 
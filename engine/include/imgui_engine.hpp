@@ -10,6 +10,8 @@ union SDL_Event;
 class ImguiEngine
 {
 public:
+    /// Window may be nullptr, then display size is taken from engine and
+    /// there is no mouse input
     bool initialize(SDL_Window* const window, om::IEngine* const engine);
     bool processEvent(const SDL_Event* event);
     void newFrame();
@@ -27,6 +29,7 @@ private:
     bool               createDeviceObjects();
     void               destroyDeviceObjects();
 
+    void newFrameWithoutWindow();
     void updateMousePosAndButtons();
     void updateMouseCursor();
 
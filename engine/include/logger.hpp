@@ -0,0 +1,136 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <streambuf>
+#include <string_view>
+
+/// Messages below this level are removed from build, values are of
+/// om::Logger::Level. Debug messages are kept only in debug configuration
+#ifndef OM_LOG_LEVEL
+#ifdef DEBUG_CONFIGURATION
+#define OM_LOG_LEVEL 0
+#else
+#define OM_LOG_LEVEL 1
+#endif
+#endif
+
+namespace om
+{
+/// Asynchronous log to std::clog. Calling thread formats message to own stack
+/// buffer and copies it to bounded lock-free ring, background thread writes
+/// messages in batches, so hot path never waits for output. Message is
+/// dropped and counted if ring is full. Messages longer than messageSize are
+/// truncated
+class Logger
+{
+public:
+    enum class Level : std::uint8_t
+    {
+        debug,
+        info,
+        warning,
+        error,
+        off,
+    };
+
+    enum class Category : std::uint8_t
+    {
+        general,
+        engine,
+        render,
+        audio,
+        world,
+        input,
+        count,
+    };
+
+    static constexpr size_t messageSize{ 512 };
+    static constexpr size_t ringSlotsCount{ 1024 };
+    static constexpr Level  compileTimeLevel{ static_cast<Level>(
+        OM_LOG_LEVEL) };
+
+    static bool isEnabled(Category category, Level level)
+    {
+        return level >= levels[static_cast<size_t>(category)].load(
+                            std::memory_order_relaxed);
+    }
+    static void setLevel(Category category, Level level);
+    /// Filter as "world=debug,render=warning", "all" sets every category
+    static bool setFilter(std::string_view filter);
+
+    static void write(Category category, Level level, std::string_view text);
+    /// Blocks until messages written before the call are written to output
+    static void flush();
+    static std::uint64_t getDroppedCount();
+
+    /// Streams values to stack buffer, message is written on destruction
+    class Message
+    {
+    public:
+        Message(Category category, Level level)
+            : m_category{ category }
+            , m_level{ level }
+        {
+        }
+        ~Message()
+        {
+            write(m_category, m_level, m_buffer.getText());
+        }
+        Message(const Message&) = delete;
+        Message& operator=(const Message&) = delete;
+
+        template <typename T>
+        Message& operator<<(const T& value)
+        {
+            m_stream << value;
+            return *this;
+        }
+
+    private:
+        class Buffer : public std::streambuf
+        {
+        public:
+            Buffer() { setp(m_text.data(), m_text.data() + m_text.size()); }
+            std::string_view getText() const
+            {
+                return { pbase(), static_cast<size_t>(pptr() - pbase()) };
+            }
+
+        private:
+            std::array<char, messageSize> m_text;
+        };
+
+        Category     m_category;
+        Level        m_level;
+        Buffer       m_buffer;
+        std::ostream m_stream{ &m_buffer };
+    };
+
+private:
+    static inline std::array<std::atomic<Level>,
+                             static_cast<size_t>(Category::count)>
+        levels{};
+};
+} // namespace om
+
+/// Streams message as to std::ostream, level is name of Logger::Level:
+/// OM_LOG(debug, world, "Bullet throwed at " << x). Arguments aren't
+/// evaluated if level is filtered
+#define OM_LOG(level, category, message)                                       \
+    do                                                                         \
+    {                                                                          \
+        if constexpr (::om::Logger::Level::level >=                            \
+                      ::om::Logger::compileTimeLevel)                          \
+        {                                                                      \
+            if (::om::Logger::isEnabled(::om::Logger::Category::category,      \
+                                        ::om::Logger::Level::level))           \
+            {                                                                  \
+                ::om::Logger::Message{ ::om::Logger::Category::category,       \
+                                       ::om::Logger::Level::level }            \
+                    << message;                                                \
+            }                                                                  \
+        }                                                                      \
+    } while (false)
@@ -0,0 +1,19 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace om
+{
+/// Read-only file mapped to memory, unmapped when the last owner of data is
+/// released. On Windows file is read to memory instead
+struct MappedFile
+{
+    std::shared_ptr<const std::byte> data;
+    size_t                           size{};
+};
+
+/// Nullopt if file can't be opened or is empty
+std::optional<MappedFile> mapFile(const std::string& path);
+} // namespace om
@@ -0,0 +1,154 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace om
+{
+/// Engine-wide named metrics. Metric is created on the first request by name
+/// and lives until exit, so reference to it may be kept in function static
+/// variable. Updates are lock-free and may be done from any thread, mutex
+/// guards only creation and reading of the whole registry
+class MetricsRegistry
+{
+public:
+    /// Monotonic count, value of the last finished frame is kept too
+    class Counter
+    {
+    public:
+        void add(std::uint64_t value = 1)
+        {
+            m_value.fetch_add(value, std::memory_order_relaxed);
+        }
+        std::uint64_t get() const
+        {
+            return m_value.load(std::memory_order_relaxed);
+        }
+
+    private:
+        friend class MetricsRegistry;
+
+        std::atomic<std::uint64_t> m_value{};
+        std::uint64_t              m_frameStartValue{};
+        std::uint64_t              m_lastFrameValue{};
+    };
+
+    /// The last set value
+    class Gauge
+    {
+    public:
+        void set(double value)
+        {
+            m_value.store(value, std::memory_order_relaxed);
+        }
+        double get() const { return m_value.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<double> m_value{};
+    };
+
+    /// Log-linear buckets as HDR histogram: every power of two range is split
+    /// to subBucketsCount buckets, so relative error of quantile is less than
+    /// 1 / subBucketsCount. Durations are recorded in microseconds, greater
+    /// values than maxValue are recorded as maxValue
+    class Histogram
+    {
+    public:
+        static constexpr size_t        subBucketsBits{ 5 };
+        static constexpr size_t        subBucketsCount{ 1 << subBucketsBits };
+        static constexpr std::uint64_t maxValue{ (1ull << 36) - 1 };
+        static constexpr size_t        bucketsCount{ 1024 };
+
+        void record(std::uint64_t value);
+        template <typename Rep, typename Period>
+        void recordDuration(std::chrono::duration<Rep, Period> duration)
+        {
+            const auto microseconds =
+                std::chrono::duration<double, std::micro>{ duration }.count();
+            record(microseconds > 0 ? static_cast<std::uint64_t>(microseconds)
+                                    : 0);
+        }
+
+        std::uint64_t getCount() const
+        {
+            return m_count.load(std::memory_order_relaxed);
+        }
+        std::uint64_t getMax() const
+        {
+            return m_max.load(std::memory_order_relaxed);
+        }
+        double getMean() const;
+        /// Highest value equivalent to bucket of quantile, 0 if empty
+        std::uint64_t getQuantile(double quantile) const;
+
+    private:
+        static size_t        getBucketIndex(std::uint64_t value);
+        static std::uint64_t getBucketHighestValue(size_t index);
+
+        std::array<std::atomic<std::uint64_t>, bucketsCount> m_buckets{};
+        std::atomic<std::uint64_t>                           m_count{};
+        std::atomic<std::uint64_t>                           m_sum{};
+        std::atomic<std::uint64_t>                           m_max{};
+    };
+
+    /// Records duration of scope to histogram
+    class ScopedTimer
+    {
+    public:
+        explicit ScopedTimer(Histogram& histogram)
+            : m_histogram{ histogram }
+        {
+        }
+        ~ScopedTimer()
+        {
+            m_histogram.recordDuration(std::chrono::steady_clock::now() -
+                                       m_startTime);
+        }
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        Histogram&                                  m_histogram;
+        const std::chrono::steady_clock::time_point m_startTime{
+            std::chrono::steady_clock::now()
+        };
+    };
+
+    struct Entry
+    {
+        enum class Type
+        {
+            counter,
+            gauge,
+            histogram,
+        };
+
+        std::string   name;
+        Type          type{};
+        double        value{};
+        std::uint64_t lastFrameValue{};
+        std::uint64_t count{};
+        double        mean{};
+        std::uint64_t p50{};
+        std::uint64_t p90{};
+        std::uint64_t p99{};
+        std::uint64_t max{};
+    };
+
+    static Counter&   getCounter(std::string_view name);
+    static Gauge&     getGauge(std::string_view name);
+    static Histogram& getHistogram(std::string_view name);
+
+    /// Stores per frame values of counters, is called once per frame
+    static void finishFrame();
+
+    /// All metrics sorted by name
+    static std::vector<Entry> getSnapshot();
+    /// Format is chosen by extension, .json or csv otherwise
+    static bool writeToFile(std::string_view filePath);
+};
+} // namespace om
@@ -0,0 +1,12 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace om
+{
+/// Writes 8 bit RGBA pixels, rows from top. Deflate blocks are stored
+/// without compression, so writing is fast and output is byte exact
+bool writePng(const std::string_view filePath, const std::uint8_t* pixels,
+              size_t w, size_t h);
+} // namespace om
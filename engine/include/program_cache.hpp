@@ -0,0 +1,37 @@
+#pragma once
+#include <glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace om
+{
+/// Linked program binaries kept between launches. Key is hash of shader
+/// sources, attributes and OpenGl driver, so binary is never given to other
+/// driver. Driver may still reject binary, then program is compiled again
+class ProgramCache
+{
+public:
+    struct Binary
+    {
+        GLenum                 format{};
+        std::vector<std::byte> data;
+    };
+
+    /// Empty directory disables cache
+    static void setDirectory(std::string directory);
+    /// Vendor, renderer and version of OpenGl. Empty disables cache, it is
+    /// not set if driver doesn't support program binaries
+    static void setDriver(std::string driver);
+    static bool isEnabled();
+
+    static std::uint64_t calcKey(const std::vector<std::string_view>& parts);
+
+    static bool load(std::uint64_t key, Binary& r_binary);
+    static void store(std::uint64_t key, const Binary& binary);
+    /// Removes binary rejected by driver
+    static void erase(std::uint64_t key);
+};
+} // namespace om
@@ -0,0 +1,163 @@
+#pragma once
+#include "iengine.hpp"
+#include "metrics_registry.hpp"
+#include <cstddef>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace om
+{
+/// Textures and sound tracks shared by asset name. Asset is loaded by engine
+/// on the first get through handle and stays resident while handles to it
+/// exist. Released assets are kept as cache until memory budget of their
+/// kind is exceeded, then least recently used ones are erased from engine.
+/// Isn't thread safe, is used by main thread only
+class ResourceManager
+{
+    struct Asset;
+
+public:
+    enum class AssetType
+    {
+        texture,
+        soundTrack,
+    };
+
+    struct Config
+    {
+        /// Textures in video memory
+        size_t gpuBudgetBytes{ std::numeric_limits<size_t>::max() };
+        /// Decoded sound tracks
+        size_t cpuBudgetBytes{ std::numeric_limits<size_t>::max() };
+        bool   isTextureLoadingAsync{ true };
+    };
+
+    /// Reference to asset, copies share it. Empty handle refers to nothing.
+    /// Handles must not outlive their manager
+    class Handle
+    {
+    public:
+        Handle() = default;
+        Handle(const Handle& other)
+            : m_asset{ other.m_asset }
+        {
+            addReference();
+        }
+        Handle(Handle&& other) noexcept
+            : m_asset{ std::exchange(other.m_asset, nullptr) }
+        {
+        }
+        Handle& operator=(Handle other) noexcept
+        {
+            std::swap(m_asset, other.m_asset);
+            return *this;
+        }
+        ~Handle() { reset(); }
+
+        explicit operator bool() const { return m_asset != nullptr; }
+        void     reset();
+
+    private:
+        friend class ResourceManager;
+
+        explicit Handle(Asset& asset)
+            : m_asset{ &asset }
+        {
+            addReference();
+        }
+        void addReference();
+
+        Asset* m_asset{};
+    };
+
+    struct ReportEntry
+    {
+        std::string_view name;
+        AssetType        type{};
+        size_t           residentBytes{};
+        size_t           referencesCount{};
+    };
+
+    ResourceManager(IEngine& engine, Config config);
+    ResourceManager(const ResourceManager&) = delete;
+    ResourceManager& operator=(const ResourceManager&) = delete;
+
+    /// Asset isn't loaded until the first get
+    Handle acquireTexture(std::string_view name);
+    Handle acquireSoundTrack(std::string_view name);
+
+    /// Load asset on the first call, empty id or nullptr if it can't be
+    /// loaded
+    TextureId    getTexture(const Handle& handle);
+    ISoundTrack* getSoundTrack(const Handle& handle);
+
+    /// Updates sizes of textures, evicts released assets over budget and
+    /// publishes metrics. Is called once per frame after frame is rendered
+    void finishFrame();
+
+    size_t getGpuBytes() const { return m_gpuBytes; }
+    size_t getCpuBytes() const { return m_cpuBytes; }
+
+    /// Resident assets, the biggest first
+    std::vector<ReportEntry> getReport() const;
+    void                     writeReport(std::ostream& stream) const;
+
+private:
+    struct Asset
+    {
+        /// Key of asset in map
+        std::string_view        name;
+        AssetType               type{};
+        size_t                  referencesCount{};
+        bool                    isLoaded{};
+        TextureId               texture{};
+        ISoundTrack*            soundTrack{};
+        size_t                  residentBytes{};
+        size_t                  lastUseFrame{};
+        MetricsRegistry::Gauge* residentBytesMetric{};
+    };
+    using Assets = std::unordered_map<std::string, Asset>;
+
+    Handle acquire(std::string_view name, AssetType type);
+    /// Loads asset on the first use, nullptr if handle isn't of type
+    Asset* use(const Handle& handle, AssetType type);
+    void   load(Asset& asset);
+    void   unload(Asset& asset);
+    /// Erases released assets of type in LRU order while bytes exceed budget
+    void evict(AssetType type, size_t budget, size_t& r_bytes);
+
+    IEngine&                      m_engine;
+    Config                        m_config;
+    Assets                        m_assets;
+    std::vector<Assets::iterator> m_evictionCandidates;
+    size_t                        m_framesCount{};
+    size_t                        m_gpuBytes{};
+    size_t                        m_cpuBytes{};
+    MetricsRegistry::Gauge&       m_gpuBytesMetric;
+    MetricsRegistry::Gauge&       m_cpuBytesMetric;
+    MetricsRegistry::Counter&     m_loadsCount;
+    MetricsRegistry::Counter&     m_evictionsCount;
+};
+
+inline void ResourceManager::Handle::addReference()
+{
+    if (m_asset != nullptr)
+    {
+        ++m_asset->referencesCount;
+    }
+}
+
+inline void ResourceManager::Handle::reset()
+{
+    if (m_asset != nullptr)
+    {
+        --m_asset->referencesCount;
+        m_asset = nullptr;
+    }
+}
+} // namespace om
@@ -0,0 +1,11 @@
+#pragma once
+
+/// Instruction set for explicit SIMD code, users keep scalar fallback for
+/// other targets
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define OM_SIMD_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define OM_SIMD_NEON
+#include <arm_neon.h>
+#endif
@@ -0,0 +1,125 @@
+#pragma once
+#include "gltexture.hpp"
+#include "vertex.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace om
+{
+/// CPU rasterizer of triangles with vertex color, nearest sampled repeated
+/// texture (mip level is chosen per triangle) and src alpha blending, as
+/// OpenGl state of EngineSdl. Triangles are binned to tiles, tiles are
+/// rasterized by worker threads, which are started once and wait for the
+/// next frame. Triangles of a tile keep order of adding, so image doesn't
+/// depend on number of threads
+class SoftwareRasterizer
+{
+public:
+    using Texture = GlTexture::DecodedImage;
+
+    /// Position in pixels, y grows down
+    struct ScreenVertex
+    {
+        myGlfloat x{};
+        myGlfloat y{};
+        myGlfloat u{};
+        myGlfloat v{};
+        Color     color{};
+    };
+
+    struct Statistics
+    {
+        size_t                                    framesCount{};
+        size_t                                    triangles{};
+        size_t                                    pixels{};
+        std::chrono::duration<double, std::milli> rasterizationTime{};
+    };
+
+    SoftwareRasterizer(size_t w, size_t h, size_t threadsCount);
+    ~SoftwareRasterizer();
+    SoftwareRasterizer(const SoftwareRasterizer&) = delete;
+    SoftwareRasterizer& operator=(const SoftwareRasterizer&) = delete;
+
+    void clear(Color color);
+    /// Texture may be nullptr, then vertex color is used
+    void addTriangle(const std::array<ScreenVertex, 3>& vertices,
+                     std::shared_ptr<const Texture>     texture);
+    /// Draws added triangles over cleared framebuffer
+    void rasterize();
+
+    /// RGBA, rows from top
+    const std::vector<std::uint8_t>& getPixels() const { return m_pixels; }
+    size_t                           getW() const { return m_w; }
+    size_t                           getH() const { return m_h; }
+    const Statistics& getStatistics() const { return m_statistics; }
+
+    static constexpr size_t tileSize{ 64 };
+
+private:
+    /// Attribute a is a0 + dadx * x + dady * y at pixel center (x, y)
+    struct Gradient
+    {
+        float a0{};
+        float dadx{};
+        float dady{};
+    };
+
+    struct Edge
+    {
+        float a{};
+        float b{};
+        float c{};
+    };
+
+    struct RasterTriangle
+    {
+        std::array<Edge, 3>            edges;
+        std::array<Gradient, 6>        attributes; // u, v, r, g, b, a
+        std::shared_ptr<const Texture> texture;
+        size_t                         level{};
+        int                            minX{};
+        int                            minY{};
+        int                            maxX{};
+        int                            maxY{};
+    };
+
+    /// Waits for frames and rasterizes their tiles with calling thread
+    void runWorker();
+    /// Takes tiles of frame until none is left
+    void rasterizeTiles();
+    /// Returns number of drawn pixels
+    size_t rasterizeTile(size_t tileIndex);
+    void   fillSpan(const RasterTriangle& triangle, int y, int xBegin,
+                    int xEnd);
+
+    size_t                           m_w{};
+    size_t                           m_h{};
+    size_t                           m_threadsCount{};
+    size_t                           m_tilesW{};
+    size_t                           m_tilesH{};
+    std::vector<std::uint8_t>        m_pixels;
+    std::array<std::uint8_t, 4>      m_clearColor{};
+    std::vector<RasterTriangle>      m_triangles;
+    /// Indices of triangles overlapping every tile
+    std::vector<std::vector<size_t>> m_tilesTriangles;
+    Statistics                       m_statistics;
+
+    std::vector<std::thread> m_workers;
+    std::mutex               m_workersMutex;
+    std::condition_variable  m_frameStarted;
+    std::condition_variable  m_frameFinished;
+    /// Frames given to workers, guarded by mutex as following two
+    size_t              m_startedFramesCount{};
+    size_t              m_busyWorkersCount{};
+    bool                m_isStopping{};
+    std::atomic<size_t> m_nextTile{};
+    std::atomic<size_t> m_framePixelsCount{};
+};
+} // namespace om
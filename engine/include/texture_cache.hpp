@@ -0,0 +1,55 @@
+#pragma once
+#include "array_view.hpp"
+#include "gltexture.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace om
+{
+/// Decoded pixels of png files kept in cache directory between launches.
+/// Header of cache file keeps size, modification time and hash of source png,
+/// and offset of png in asset pack if it's packed. Cached pixels are mapped
+/// from file and passed to OpenGl without copying
+class TextureCache
+{
+public:
+    /// Place of png in asset pack, the same while pack isn't rebuilt
+    struct PackedSource
+    {
+        std::int64_t  packModificationTime{};
+        std::uint64_t offset{};
+    };
+
+    /// Empty directory disables cache. Should be set before loading textures
+    static void setDirectory(std::string directory);
+
+    /// Uses cache if size and modification time of png didn't change, so
+    /// png is not even read
+    static bool loadIfUnchanged(const std::string_view  filePath,
+                                GlTexture::DecodedImage& r_image);
+
+    /// Uses cache if png content is the same, for files without modification
+    /// time (android assets) or touched without changes
+    static bool loadIfSameContent(const std::string_view   filePath,
+                                  ArrayView<std::byte>     png,
+                                  GlTexture::DecodedImage& r_image);
+
+    /// Uses cache if png of asset pack has the same size and place and pack
+    /// modification time didn't change, so png is not hashed
+    static bool loadIfUnchanged(const std::string_view   filePath,
+                                ArrayView<std::byte>     png,
+                                const PackedSource&      packedSource,
+                                GlTexture::DecodedImage& r_image);
+
+    /// Packed source is given for png of asset pack
+    static void store(const std::string_view             filePath,
+                      ArrayView<std::byte>               png,
+                      const GlTexture::DecodedImage&     image,
+                      const std::optional<PackedSource>& packedSource =
+                          std::nullopt);
+};
+} // namespace om
@@ -0,0 +1,94 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+
+namespace om
+{
+/// Timeline of scopes for chrome://tracing or Perfetto. Every thread writes
+/// events to own ring buffer, so the oldest events are dropped if trace isn't
+/// written for long time. Scopes are recorded only in build with OM_TRACING
+/// option. OM_TRACE_SCOPE is empty if allocation tracking is disabled too,
+/// it tags allocations by the current scope
+class Trace
+{
+public:
+#ifdef OM_TRACING
+    static constexpr bool isEnabled{ true };
+#else
+    static constexpr bool isEnabled{ false };
+#endif
+    /// Events kept per thread
+    static constexpr size_t threadEventsCount{ 1 << 16 };
+
+    /// Nanoseconds since start of program
+    static std::uint64_t now()
+    {
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - startTime)
+                .count());
+    }
+
+    /// Name should live until trace is written, as string literal
+    static void addEvent(const char* name, std::uint64_t startTime,
+                         std::uint64_t endTime);
+    /// Name of calling thread in trace
+    static void setThreadName(const char* name);
+
+    /// Writes events of all threads as Chrome trace_event json and clears
+    /// buffers, so the next file has only new events
+    static bool writeChromeJson(std::string_view filePath);
+
+    /// Name of the innermost scope of calling thread, nullptr out of scopes
+    static const char* getCurrentScope() { return currentScope; }
+
+    class Scope
+    {
+    public:
+        explicit Scope(const char* name)
+            : m_name{ name }
+            , m_parentScope{ currentScope }
+        {
+            currentScope = name;
+        }
+        ~Scope()
+        {
+            currentScope = m_parentScope;
+            if constexpr (isEnabled)
+            {
+                addEvent(m_name, m_startTime, now());
+            }
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char*         m_name;
+        const char*         m_parentScope;
+        const std::uint64_t m_startTime{ isEnabled ? now() : 0 };
+    };
+
+private:
+    static inline const std::chrono::steady_clock::time_point startTime{
+        std::chrono::steady_clock::now()
+    };
+    static inline thread_local const char* currentScope{};
+};
+} // namespace om
+
+#if defined(OM_TRACING) || defined(OM_ALLOCATION_TRACKING)
+#define OM_TRACE_CONCAT_INTERNAL(first, second) first##second
+#define OM_TRACE_CONCAT(first, second) OM_TRACE_CONCAT_INTERNAL(first, second)
+/// Records scope from this line to its end, name is string literal
+#define OM_TRACE_SCOPE(name)                                                   \
+    const ::om::Trace::Scope OM_TRACE_CONCAT(omTraceScope, __LINE__) { name }
+#else
+#define OM_TRACE_SCOPE(name) static_cast<void>(0)
+#endif
+
+#ifdef OM_TRACING
+#define OM_TRACE_THREAD_NAME(name) ::om::Trace::setThreadName(name)
+#else
+#define OM_TRACE_THREAD_NAME(name) static_cast<void>(0)
+#endif
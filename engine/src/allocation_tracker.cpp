@@ -0,0 +1,437 @@
+#include "allocation_tracker.hpp"
+#include "metrics_registry.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+#if __has_include(<execinfo.h>)
+#include <execinfo.h>
+#include <unistd.h>
+#define OM_HAS_BACKTRACE
+#endif
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+#if defined(__GNUC__)
+#define OM_CALL_SITE __builtin_return_address(0)
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#define OM_CALL_SITE _ReturnAddress()
+#else
+#define OM_CALL_SITE nullptr
+#endif
+
+namespace om
+{
+
+struct ScopeAllocations
+{
+    /// Pointer to string literal of scope, it identifies scope
+    std::atomic<const char*>   name{};
+    std::atomic<std::uint64_t> allocations{};
+    // used only by finishFrame
+    std::uint64_t              publishedAllocations{};
+    MetricsRegistry::Counter*  counter{};
+};
+
+/// Operator new may be called before dynamic initialization, so counts are
+/// initialized at compile time
+struct AllocationCounts
+{
+    std::atomic<std::uint64_t> allocations{};
+    std::atomic<std::uint64_t> deallocations{};
+    std::atomic<std::uint64_t> allocatedBytes{};
+    std::atomic<std::uint64_t> liveBytes{};
+    std::atomic<std::uint64_t> framePeakBytes{};
+    std::atomic<std::uint64_t> zeroAllocationViolations{};
+    std::atomic<AllocationTracker::ZeroAllocationAction> zeroAllocationAction{};
+    /// The first scope is other
+    std::array<ScopeAllocations, AllocationTracker::maxScopesCount> scopes{};
+    std::array<std::atomic<void*>, 1024> reportedCallSites{};
+};
+
+constinit static AllocationCounts counts;
+/// Report of allocation allocates too, it isn't reported again
+constinit static thread_local bool isReporting{};
+constinit static thread_local bool isZeroAllocationChecked{};
+
+#ifdef OM_ALLOCATION_TRACKING
+static ScopeAllocations& findScope(const char* name)
+{
+    auto& scopes = counts.scopes;
+    if (name == nullptr)
+    {
+        return scopes.front();
+    }
+    const auto hash = reinterpret_cast<std::uintptr_t>(name) >> 3;
+    for (size_t i = 0; i < scopes.size() - 1; ++i)
+    {
+        auto&       scope = scopes[1 + (hash + i) % (scopes.size() - 1)];
+        const char* found = scope.name.load(std::memory_order_acquire);
+        if (found == nullptr &&
+            scope.name.compare_exchange_strong(found, name,
+                                               std::memory_order_acq_rel))
+        {
+            return scope;
+        }
+        // found is updated if other thread has taken scope first
+        if (found == name)
+        {
+            return scope;
+        }
+    }
+    return scopes.front();
+}
+
+/// False if call site is reported already
+static bool markCallSiteReported(void* callSite)
+{
+    auto&      callSites = counts.reportedCallSites;
+    const auto hash      = reinterpret_cast<std::uintptr_t>(callSite) >> 2;
+    for (size_t i = 0; i < callSites.size(); ++i)
+    {
+        auto& reported = callSites[(hash + i) % callSites.size()];
+        void* found    = reported.load(std::memory_order_acquire);
+        if (found == nullptr &&
+            reported.compare_exchange_strong(found, callSite,
+                                             std::memory_order_acq_rel))
+        {
+            return true;
+        }
+        if (found == callSite)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void reportAllocation(size_t size, void* callSite)
+{
+    counts.zeroAllocationViolations.fetch_add(1, std::memory_order_relaxed);
+    if (!markCallSiteReported(callSite))
+    {
+        return;
+    }
+    isReporting       = true;
+    const auto* scope = Trace::getCurrentScope();
+    std::cerr << "Allocation of " << size
+              << " bytes in zero allocation frame, scope: "
+              << (scope ? scope : "none") << ", call site: " << callSite
+              << std::endl;
+#ifdef OM_HAS_BACKTRACE
+    std::array<void*, 32> frames;
+    const auto            framesCount =
+        backtrace(frames.data(), static_cast<int>(frames.size()));
+    backtrace_symbols_fd(frames.data(), framesCount, STDERR_FILENO);
+#endif
+    if (counts.zeroAllocationAction.load(std::memory_order_relaxed) ==
+        AllocationTracker::ZeroAllocationAction::abort)
+    {
+        std::abort();
+    }
+    isReporting = false;
+}
+
+static void recordAllocation(size_t size, void* callSite)
+{
+    counts.allocations.fetch_add(1, std::memory_order_relaxed);
+    counts.allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    const auto liveBytes =
+        counts.liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+    auto peakBytes = counts.framePeakBytes.load(std::memory_order_relaxed);
+    while (liveBytes > peakBytes &&
+           !counts.framePeakBytes.compare_exchange_weak(
+               peakBytes, liveBytes, std::memory_order_relaxed))
+    {
+    }
+    findScope(Trace::getCurrentScope())
+        .allocations.fetch_add(1, std::memory_order_relaxed);
+    if (isZeroAllocationChecked && !isReporting)
+    {
+        reportAllocation(size, callSite);
+    }
+}
+
+static void recordDeallocation(size_t size)
+{
+    counts.deallocations.fetch_add(1, std::memory_order_relaxed);
+    counts.liveBytes.fetch_sub(size, std::memory_order_relaxed);
+}
+
+static constexpr size_t defaultAlignment{ __STDCPP_DEFAULT_NEW_ALIGNMENT__ };
+
+static size_t getHeaderSize(size_t alignment)
+{
+    return std::max(alignment, defaultAlignment);
+}
+
+/// Size of allocation is kept before returned memory, so delete knows it
+static void* allocate(size_t size, size_t alignment, void* callSite) noexcept
+{
+    const auto headerSize = getHeaderSize(alignment);
+    void*      base{};
+    if (alignment <= defaultAlignment)
+    {
+        base = std::malloc(headerSize + size);
+    }
+    else
+    {
+#ifdef _WIN32
+        base = _aligned_malloc(headerSize + size, alignment);
+#else
+        if (posix_memalign(&base, alignment, headerSize + size) != 0)
+        {
+            base = nullptr;
+        }
+#endif
+    }
+    if (!base)
+    {
+        return nullptr;
+    }
+    auto* pointer = static_cast<std::byte*>(base) + headerSize;
+    reinterpret_cast<size_t*>(pointer)[-1] = size;
+    recordAllocation(size, callSite);
+    return pointer;
+}
+
+static void* allocateOrThrow(size_t size, size_t alignment, void* callSite)
+{
+    for (;;)
+    {
+        if (auto* pointer = allocate(size, alignment, callSite))
+        {
+            return pointer;
+        }
+        const auto newHandler = std::get_new_handler();
+        if (!newHandler)
+        {
+            throw std::bad_alloc();
+        }
+        newHandler();
+    }
+}
+
+static void deallocate(void* pointer, size_t alignment) noexcept
+{
+    if (!pointer)
+    {
+        return;
+    }
+    recordDeallocation(static_cast<size_t*>(pointer)[-1]);
+    auto* base = static_cast<std::byte*>(pointer) - getHeaderSize(alignment);
+#ifdef _WIN32
+    if (alignment > defaultAlignment)
+    {
+        _aligned_free(base);
+        return;
+    }
+#endif
+    std::free(base);
+}
+#endif
+
+static AllocationTracker::FrameStatistics lastFrameStatistics;
+
+void AllocationTracker::finishFrame()
+{
+    if constexpr (!isEnabled)
+    {
+        return;
+    }
+    static auto& allocationsMetric =
+        MetricsRegistry::getCounter("memory.allocations");
+    static auto& bytesMetric =
+        MetricsRegistry::getCounter("memory.allocated_bytes");
+    static auto& violationsMetric =
+        MetricsRegistry::getCounter("memory.zero_allocation_violations");
+    static auto& liveBytesMetric =
+        MetricsRegistry::getGauge("memory.live_bytes");
+    static auto& peakBytesMetric =
+        MetricsRegistry::getGauge("memory.frame_peak_bytes");
+    static FrameStatistics total;
+
+    constexpr auto  order = std::memory_order_relaxed;
+    FrameStatistics current;
+    current.allocations    = counts.allocations.load(order);
+    current.deallocations  = counts.deallocations.load(order);
+    current.allocatedBytes = counts.allocatedBytes.load(order);
+    current.liveBytes      = counts.liveBytes.load(order);
+    // peak of the next frame starts from live bytes
+    current.peakBytes =
+        counts.framePeakBytes.exchange(current.liveBytes, order);
+
+    auto& last          = lastFrameStatistics;
+    last.allocations    = current.allocations - total.allocations;
+    last.deallocations  = current.deallocations - total.deallocations;
+    last.allocatedBytes = current.allocatedBytes - total.allocatedBytes;
+    last.peakBytes      = current.peakBytes;
+    last.liveBytes      = current.liveBytes;
+    total               = current;
+
+    allocationsMetric.add(last.allocations);
+    bytesMetric.add(last.allocatedBytes);
+    violationsMetric.add(counts.zeroAllocationViolations.exchange(0, order));
+    liveBytesMetric.set(static_cast<double>(current.liveBytes));
+    peakBytesMetric.set(static_cast<double>(current.peakBytes));
+
+    // hot spots are visible as counters of scopes
+    for (size_t i = 0; i < counts.scopes.size(); ++i)
+    {
+        auto&       scope = counts.scopes[i];
+        const char* name =
+            i == 0 ? "other" : scope.name.load(std::memory_order_acquire);
+        const auto allocations = scope.allocations.load(order);
+        if (name == nullptr || allocations == scope.publishedAllocations)
+        {
+            continue;
+        }
+        if (!scope.counter)
+        {
+            scope.counter = &MetricsRegistry::getCounter(
+                std::string{ "memory.allocations." } + name);
+        }
+        scope.counter->add(allocations - scope.publishedAllocations);
+        scope.publishedAllocations = allocations;
+    }
+}
+
+AllocationTracker::FrameStatistics AllocationTracker::getLastFrameStatistics()
+{
+    return lastFrameStatistics;
+}
+
+void AllocationTracker::setZeroAllocationCheck(bool isEnabled)
+{
+    isZeroAllocationChecked = isEnabled;
+}
+
+void AllocationTracker::setZeroAllocationAction(ZeroAllocationAction action)
+{
+    counts.zeroAllocationAction.store(action, std::memory_order_relaxed);
+}
+
+} // namespace om
+
+#ifdef OM_ALLOCATION_TRACKING
+// replaceable global allocation functions, they are linked with this file
+// because game calls AllocationTracker::finishFrame
+
+void* operator new(std::size_t size)
+{
+    return om::allocateOrThrow(size, om::defaultAlignment, OM_CALL_SITE);
+}
+
+void* operator new[](std::size_t size)
+{
+    return om::allocateOrThrow(size, om::defaultAlignment, OM_CALL_SITE);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    return om::allocateOrThrow(size, static_cast<std::size_t>(alignment),
+                               OM_CALL_SITE);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return om::allocateOrThrow(size, static_cast<std::size_t>(alignment),
+                               OM_CALL_SITE);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return om::allocate(size, om::defaultAlignment, OM_CALL_SITE);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return om::allocate(size, om::defaultAlignment, OM_CALL_SITE);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment,
+                   const std::nothrow_t&) noexcept
+{
+    return om::allocate(size, static_cast<std::size_t>(alignment),
+                        OM_CALL_SITE);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment,
+                     const std::nothrow_t&) noexcept
+{
+    return om::allocate(size, static_cast<std::size_t>(alignment),
+                        OM_CALL_SITE);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    om::deallocate(pointer, om::defaultAlignment);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    om::deallocate(pointer, om::defaultAlignment);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    om::deallocate(pointer, om::defaultAlignment);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+    om::deallocate(pointer, om::defaultAlignment);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{
+    om::deallocate(pointer, om::defaultAlignment);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept
+{
+    om::deallocate(pointer, om::defaultAlignment);
+}
+
+void operator delete(void* pointer, std::align_val_t alignment) noexcept
+{
+    om::deallocate(pointer, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void* pointer, std::align_val_t alignment) noexcept
+{
+    om::deallocate(pointer, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* pointer, std::size_t,
+                     std::align_val_t alignment) noexcept
+{
+    om::deallocate(pointer, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void* pointer, std::size_t,
+                       std::align_val_t alignment) noexcept
+{
+    om::deallocate(pointer, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* pointer, std::align_val_t alignment,
+                     const std::nothrow_t&) noexcept
+{
+    om::deallocate(pointer, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void* pointer, std::align_val_t alignment,
+                       const std::nothrow_t&) noexcept
+{
+    om::deallocate(pointer, static_cast<std::size_t>(alignment));
+}
+#endif
@@ -0,0 +1,252 @@
+#include "asset_pack.hpp"
+#include "file_utils.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace om
+{
+
+struct PackHeader
+{
+    std::array<char, 8> magic{};
+    std::uint64_t       assetsCount{};
+};
+
+/// Offsets are from start of pack
+struct PackEntry
+{
+    std::uint64_t nameOffset{};
+    std::uint64_t nameSize{};
+    std::uint64_t offset{};
+    std::uint64_t size{};
+};
+
+static constexpr std::array<char, 8> packMagic{ 'O', 'M', 'P', 'A',
+                                                'C', 'K', '0', '1' };
+
+static PackEntry getEntry(const std::byte* pack, size_t index)
+{
+    PackEntry entry;
+    std::memcpy(&entry, pack + sizeof(PackHeader) + index * sizeof(PackEntry),
+                sizeof(entry));
+    return entry;
+}
+
+static std::string_view getName(const std::byte* pack, const PackEntry& entry)
+{
+    return { reinterpret_cast<const char*>(pack + entry.nameOffset),
+             static_cast<size_t>(entry.nameSize) };
+}
+
+static bool isInside(std::uint64_t offset, std::uint64_t size,
+                     std::uint64_t packSize)
+{
+    return offset <= packSize && size <= packSize - offset;
+}
+
+static size_t alignBlob(size_t offset)
+{
+    constexpr auto alignment = AssetPack::blobAlignment;
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+bool AssetPack::open(const std::string& path)
+{
+    auto mapped = mapFile(path);
+    if (!mapped)
+    {
+        return false;
+    }
+    PackHeader header;
+    if (mapped->size >= sizeof(header))
+    {
+        std::memcpy(&header, mapped->data.get(), sizeof(header));
+    }
+    const auto* pack = mapped->data.get();
+    bool        isValid =
+        mapped->size >= sizeof(header) && header.magic == packMagic &&
+        header.assetsCount <= (mapped->size - sizeof(header)) /
+                                  sizeof(PackEntry);
+    std::string_view previousName;
+    for (size_t i = 0; isValid && i < header.assetsCount; ++i)
+    {
+        const auto entry = getEntry(pack, i);
+        isValid = isInside(entry.nameOffset, entry.nameSize, mapped->size) &&
+                  isInside(entry.offset, entry.size, mapped->size) &&
+                  (i == 0 || previousName < getName(pack, entry));
+        previousName = isValid ? getName(pack, entry) : std::string_view{};
+    }
+    if (!isValid)
+    {
+        std::cerr << "Asset pack " << path << " is damaged" << std::endl;
+        return false;
+    }
+    m_file        = std::move(*mapped);
+    m_assetsCount = static_cast<size_t>(header.assetsCount);
+    // stays 0 if unknown, then content of packed pngs is hashed by texture
+    // cache
+    std::error_code error;
+    const auto      writeTime = std::filesystem::last_write_time(path, error);
+    m_modificationTime =
+        error ? 0
+              : static_cast<std::int64_t>(writeTime.time_since_epoch().count());
+    return true;
+}
+
+ArrayView<std::byte> AssetPack::find(std::string_view name) const
+{
+    const auto* pack = m_file.data.get();
+    // index is sorted by names
+    size_t first{};
+    size_t count{ m_assetsCount };
+    while (count > 0)
+    {
+        const auto step = count / 2;
+        if (getName(pack, getEntry(pack, first + step)) < name)
+        {
+            first += step + 1;
+            count -= step + 1;
+        }
+        else
+        {
+            count = step;
+        }
+    }
+    if (first == m_assetsCount)
+    {
+        return {};
+    }
+    const auto entry = getEntry(pack, first);
+    if (getName(pack, entry) != name)
+    {
+        return {};
+    }
+    return { pack + entry.offset, static_cast<size_t>(entry.size) };
+}
+
+bool AssetPack::write(const std::string& packPath,
+                      const std::string& directory)
+{
+    namespace fs = std::filesystem;
+    struct Asset
+    {
+        std::string name;
+        fs::path    path;
+    };
+
+    auto root = fs::path{ directory }.lexically_normal();
+    if (!root.has_filename())
+    {
+        root = root.parent_path();
+    }
+    std::vector<Asset> assets;
+    std::error_code    error;
+    for (fs::recursive_directory_iterator fileIt{ root, error }, end;
+         !error && fileIt != end; fileIt.increment(error))
+    {
+        if (fileIt->is_regular_file())
+        {
+            assets.push_back(
+                { fileIt->path().lexically_relative(root.parent_path())
+                      .generic_string(),
+                  fileIt->path() });
+        }
+    }
+    if (error)
+    {
+        std::cerr << "Can't read resources directory " << directory << ". "
+                  << error.message() << std::endl;
+        return false;
+    }
+    std::sort(assets.begin(), assets.end(),
+              [](const Asset& first, const Asset& second) {
+                  return first.name < second.name;
+              });
+
+    // header, index and names are followed by blobs
+    std::vector<PackEntry> entries(assets.size());
+    size_t offset = sizeof(PackHeader) + entries.size() * sizeof(PackEntry);
+    for (size_t i = 0; i < assets.size(); ++i)
+    {
+        entries[i].nameOffset = offset;
+        entries[i].nameSize   = assets[i].name.size();
+        offset += assets[i].name.size();
+    }
+    auto position = offset;
+    for (size_t i = 0; i < assets.size(); ++i)
+    {
+        offset            = alignBlob(offset);
+        entries[i].offset = offset;
+        entries[i].size   = fs::file_size(assets[i].path, error);
+        if (error)
+        {
+            std::cerr << "Can't read resource " << assets[i].path << ". "
+                      << error.message() << std::endl;
+            return false;
+        }
+        offset += entries[i].size;
+    }
+
+    AtomicFileWriter writer{ packPath };
+    auto&            file = writer.getStream();
+    PackHeader       header;
+    header.magic       = packMagic;
+    header.assetsCount = assets.size();
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(entries.data()),
+               static_cast<std::streamsize>(entries.size() *
+                                            sizeof(PackEntry)));
+    for (const auto& asset : assets)
+    {
+        file << asset.name;
+    }
+    std::vector<char> content;
+    bool              isReadOk{ true };
+    for (size_t i = 0; i < assets.size() && isReadOk && file; ++i)
+    {
+        file.write(std::array<char, blobAlignment>{}.data(),
+                   static_cast<std::streamsize>(entries[i].offset - position));
+        position = entries[i].offset + entries[i].size;
+        std::ifstream source{ assets[i].path, std::ios::binary };
+        content.resize(static_cast<size_t>(entries[i].size));
+        isReadOk = static_cast<bool>(source.read(
+            content.data(), static_cast<std::streamsize>(content.size())));
+        file.write(content.data(),
+                   static_cast<std::streamsize>(content.size()));
+    }
+    if (!isReadOk)
+    {
+        std::cerr << "Can't read resources of asset pack " << packPath
+                  << std::endl;
+        return false;
+    }
+    if (!writer.commit())
+    {
+        return false;
+    }
+    std::clog << "Asset pack " << packPath << ": " << assets.size()
+              << " assets, " << offset << " bytes" << std::endl;
+    return true;
+}
+
+const AssetPack& AssetPack::getAssetPack()
+{
+    static const AssetPack pack = []() {
+        AssetPack opened;
+        if (opened.open(std::string{ defaultPath }))
+        {
+            std::clog << "Assets are mapped from " << defaultPath << ": "
+                      << opened.getAssetsCount() << std::endl;
+        }
+        return opened;
+    }();
+    return pack;
+}
+
+} // namespace om
@@ -1,5 +1,8 @@
 ﻿#include "audio_engine.hpp"
+#include "asset_pack.hpp"
 #include "engine_sdl.hpp"
+#include "metrics_registry.hpp"
+#include "trace.hpp"
 #include <iostream>
 #include <map>
 #include <stdexcept>
@@ -37,7 +40,13 @@ uint_least8_t* SoundTrack::loadWav(std::string_view path,
                                    SDL_AudioSpec&   fileAudioSpec,
                                    uint_least32_t&  length)
 {
-    SDL_RWops* fileSrcWav = SDL_RWFromFile(path.data(), "rb");
+    // packed wav is read from mapped pack by memory stream
+    const auto packedWav  = AssetPack::getAssetPack().find(path);
+    SDL_RWops* fileSrcWav = packedWav.empty()
+                                ? SDL_RWFromFile(path.data(), "rb")
+                                : SDL_RWFromConstMem(
+                                      packedWav.data(),
+                                      static_cast<int>(packedWav.size()));
     if (fileSrcWav == nullptr)
     {
         throw std::runtime_error(std::string("can't open audio file: ") +
@@ -374,6 +383,17 @@ void AudioEngine::eraseSoundTrack(ISoundTrack* soundTrack)
     auto reducedToChildTrack = static_cast<SoundTrack*>(soundTrack);
     m_soundTracks.remove(reducedToChildTrack);
     SDL_LockAudioDevice(m_audioDevice);
+    // disposable buffers belong to engine, other ones are erased by owner
+    // before their track
+    m_soundBuffers.remove_if([reducedToChildTrack](SoundBuffer* buffer) {
+        const bool isErased = buffer->is_disposable &&
+                              buffer->m_soundTrack == reducedToChildTrack;
+        if (isErased)
+        {
+            delete buffer;
+        }
+        return isErased;
+    });
     delete reducedToChildTrack;
     SDL_UnlockAudioDevice(m_audioDevice);
 }
@@ -547,15 +567,23 @@ void AudioEngine::playSoundInternal(SoundBuffer* buffer, uint8_t* stream,
 void AudioEngine::audioCallback(void* audioEnginePtr, uint8_t* stream,
                                 int stream_size)
 {
+    static auto& callbackTime =
+        MetricsRegistry::getHistogram("audio.callback_us");
+    static auto& voicesCount = MetricsRegistry::getGauge("audio.voices");
+    MetricsRegistry::ScopedTimer callbackTimer{ callbackTime };
+    OM_TRACE_SCOPE("AudioEngine::audioCallback");
+
     // no sound default
     std::fill_n(stream, stream_size, '\0');
 
     AudioEngine* audioEngine = static_cast<AudioEngine*>(audioEnginePtr);
 
+    size_t playingCount{};
     for (SoundBuffer* snd : audioEngine->m_soundBuffers)
     {
         if (snd->is_playing)
         {
+            ++playingCount;
             playSoundInternal(snd, stream, stream_size,
                               audioEngine->m_audioDeviceSpec.format);
 
@@ -577,6 +605,7 @@ void AudioEngine::audioCallback(void* audioEnginePtr, uint8_t* stream,
     audioEngine->m_soundBuffers.remove_if([](SoundBuffer* snd) {
         return snd->is_disposable && !snd->is_playing;
     });
+    voicesCount.set(static_cast<double>(playingCount));
 }
 
 } // namespace om
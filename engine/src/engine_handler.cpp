@@ -1,5 +1,7 @@
 #include "engine_handler.hpp"
+#include "engine_null.hpp"
 #include "engine_sdl.hpp"
+#include "engine_software.hpp"
 #include <iostream>
 #include <stdexcept>
 
@@ -20,7 +22,7 @@ EngineHandler::EngineHandler(EngineTypes             engineType,
     }
     if (!initEngine(windowName, config))
     {
-        throw std::runtime_error("Cannot init SDL2.");
+        throw std::runtime_error("Cannot init engine.");
     }
 }
 
@@ -46,6 +48,12 @@ bool EngineHandler::initEnginePtr(EngineTypes engineType) noexcept
             case EngineTypes::sdl:
                 m_currentEnginePtr = std::make_shared<EngineSdl>();
                 break;
+            case EngineTypes::null:
+                m_currentEnginePtr = std::make_shared<EngineNull>();
+                break;
+            case EngineTypes::software:
+                m_currentEnginePtr = std::make_shared<EngineSoftware>();
+                break;
             default:
                 std::cerr << "Cannot init engine. " << std::endl;
                 return false;
@@ -0,0 +1,430 @@
+#include "engine_null.hpp"
+#include "frame_arena.hpp"
+#include <algorithm>
+#include <charconv>
+#include <imgui.h>
+#include <iostream>
+#include <sstream>
+
+namespace om
+{
+
+class NullSoundTrack : public ISoundTrack
+{
+};
+
+class NullSoundBuffer final : public ISoundBuffer
+{
+public:
+    void play(const properties) override {}
+    void stop() override {}
+    void proceed() override {}
+    void pause() override {}
+    void setVolume(float) override {}
+    void setLeftRightBalance(float) override {}
+    void setStereo(float) override {}
+};
+
+std::string EngineNull::initialize(std::string_view /*windowName*/,
+                                   std::string_view config)
+{
+    std::stringstream serr;
+    if (!config.empty())
+    {
+        const auto result = std::from_chars(
+            config.data(), config.data() + config.size(), m_maxFramesCount);
+        if (result.ec != std::errc{})
+        {
+            serr << "Incorrect number of frames in config: " << config
+                 << std::endl;
+            return serr.str();
+        }
+    }
+
+    if (!m_imguiEngine.initialize(nullptr, this))
+    {
+        serr << "Cannot init imgui" << std::endl;
+        return serr.str();
+    }
+    m_frameStartTime = clock_t::now();
+    return serr.str();
+}
+
+bool EngineNull::read_input(Event& e)
+{
+    if (m_maxFramesCount != 0 && m_statistics.framesCount >= m_maxFramesCount)
+    {
+        // once, so game loop can react to it
+        m_maxFramesCount = 0;
+        e.type           = EventType::turn_off;
+        return true;
+    }
+    return false;
+}
+
+void EngineNull::uninitialize()
+{
+    m_imguiEngine.shutdown();
+    if (m_statistics.framesCount == 0)
+    {
+        return;
+    }
+    const auto frames = static_cast<double>(m_statistics.framesCount);
+    std::clog << "Null engine frames: " << m_statistics.framesCount
+              << " frame time: " << m_statistics.framesTime.count() / frames
+              << " ms draw calls: " << m_statistics.drawCalls / frames
+              << " vertices: " << m_statistics.vertices / frames
+              << " indices: " << m_statistics.indices / frames
+              << " uniforms: " << m_statistics.uniformSets / frames
+              << " texture binds: " << m_statistics.textureBinds / frames
+              << " per frame" << std::endl;
+}
+
+ProgramId EngineNull::addProgram(
+    const std::string_view& /*vertexShaderFileName*/,
+    const std::string_view& /*fragmentShaderFileName*/,
+    const std::vector<std::pair<myUint, std::string_view>>& /*attributes*/)
+{
+    ++lastProgramId.id;
+    m_programs.insert(lastProgramId);
+    return lastProgramId;
+}
+
+bool EngineNull::eraseProgram(ProgramId programId)
+{
+    return m_programs.erase(programId) == 1;
+}
+
+TextureId EngineNull::addTexture(const std::string_view& /*pathToTexture*/)
+{
+    ++lastTextureId.id;
+    m_textures.insert(lastTextureId);
+    return lastTextureId;
+}
+
+TextureId EngineNull::addTexture(const uint_least8_t* const /*pixels*/,
+                                 const size_t /*w*/, const size_t /*h*/)
+{
+    ++lastTextureId.id;
+    m_textures.insert(lastTextureId);
+    return lastTextureId;
+}
+
+TextureId EngineNull::addTextureAsync(const std::string_view& pathToTexture)
+{
+    return addTexture(pathToTexture);
+}
+
+size_t EngineNull::getPendingTexturesCount() const
+{
+    return 0;
+}
+
+bool EngineNull::eraseTexture(TextureId textureId)
+{
+    return m_textures.erase(textureId) == 1;
+}
+
+size_t EngineNull::getTextureMemorySize(TextureId /*textureId*/) const
+{
+    return 0;
+}
+
+bool EngineNull::setCurrentDefaultProgram(ProgramId programId)
+{
+    if (m_programs.count(programId) == 0)
+    {
+        return false;
+    }
+    m_currentProgramId = programId;
+    Command command;
+    command.type      = Command::Type::set_program;
+    command.programId = programId;
+    m_commandLog.push_back(std::move(command));
+    return true;
+}
+
+bool EngineNull::setUniform(std::string_view uniformName, myGlfloat parameters,
+                            ProgramId programId)
+{
+    m_uniformParameters.push_back(parameters);
+    return recordUniform(uniformName, 1, programId);
+}
+
+bool EngineNull::setUniform(std::string_view       uniformName,
+                            std::vector<myGlfloat> parameters,
+                            ProgramId              programId)
+{
+    m_uniformParameters.insert(m_uniformParameters.end(), parameters.begin(),
+                               parameters.end());
+    return recordUniform(uniformName, parameters.size(), programId);
+}
+
+bool EngineNull::renderClearWindow(Color /*color*/)
+{
+    Command command;
+    command.type = Command::Type::clear_window;
+    m_commandLog.push_back(std::move(command));
+    return true;
+}
+
+void EngineNull::render(ArrayView<VertexWide> vertices,
+                        ArrayView<myUint>     indices,
+                        ArrayView<TextureId>  textureIds,
+                        ArrayView<std::string_view> /*textureAttributesNames*/,
+                        const Matrix<3, 3>&    moveMatrix,
+                        const std::string_view moveUnifromName,
+                        ProgramId programId, ShapeType type)
+{
+    recordMoveMatrix(moveUnifromName, moveMatrix, programId);
+    recordTextures(textureIds);
+    recordDraw(vertices.size(), indices, type, programId);
+}
+
+void EngineNull::render(ArrayView<VertexTextured> vertices,
+                        ArrayView<myUint>         indices,
+                        ArrayView<TextureId>      textureIds,
+                        ArrayView<std::string_view> /*textureAttributesNames*/,
+                        const Matrix<3, 3>&    moveMatrix,
+                        const std::string_view moveUnifromName,
+                        ProgramId programId, ShapeType type)
+{
+    recordMoveMatrix(moveUnifromName, moveMatrix, programId);
+    recordTextures(textureIds);
+    recordDraw(vertices.size(), indices, type, programId);
+}
+
+void EngineNull::render(ArrayView<VertexMorphed> vertices,
+                        ArrayView<myUint>        indices,
+                        const Matrix<3, 3>&      moveMatrix,
+                        const std::string_view   moveUnifromName,
+                        ProgramId programId, ShapeType type)
+{
+    recordMoveMatrix(moveUnifromName, moveMatrix, programId);
+    recordDraw(vertices.size(), indices, type, programId);
+}
+
+void EngineNull::render(ArrayView<Vertex> vertices, ArrayView<myUint> indices,
+                        const Matrix<3, 3>&    moveMatrix,
+                        const std::string_view moveUnifromName,
+                        ProgramId programId, ShapeType type)
+{
+    recordMoveMatrix(moveUnifromName, moveMatrix, programId);
+    recordDraw(vertices.size(), indices, type, programId);
+}
+
+void EngineNull::render(ArrayView<VertexWide> vertices,
+                        ArrayView<myUint>     indices,
+                        ArrayView<TextureId>  textureIds,
+                        ArrayView<std::string_view> /*textureAttributesNames*/,
+                        ProgramId programId, ShapeType type)
+{
+    recordTextures(textureIds);
+    recordDraw(vertices.size(), indices, type, programId);
+}
+
+void EngineNull::render(ArrayView<VertexTextured> vertices,
+                        ArrayView<myUint>         indices,
+                        ArrayView<TextureId>      textureIds,
+                        ArrayView<std::string_view> /*textureAttributesNames*/,
+                        ProgramId programId, ShapeType type)
+{
+    recordTextures(textureIds);
+    recordDraw(vertices.size(), indices, type, programId);
+}
+
+void EngineNull::render(ArrayView<VertexMorphed> vertices,
+                        ArrayView<myUint> indices, ProgramId programId,
+                        ShapeType type)
+{
+    recordDraw(vertices.size(), indices, type, programId);
+}
+
+void EngineNull::render(ArrayView<Vertex> vertices, ArrayView<myUint> indices,
+                        ProgramId programId, ShapeType type)
+{
+    recordDraw(vertices.size(), indices, type, programId);
+}
+
+void EngineNull::renderTriangle(const Triangle<Vertex>& /*t*/,
+                                ProgramId programId)
+{
+    recordDraw(3, { 0, 1, 2 }, ShapeType::triangle, programId);
+}
+
+bool EngineNull::updateWindow(Color fillingColor)
+{
+    uiRender();
+    FrameArena::getFrameArena().reset();
+
+    Command command;
+    command.type = Command::Type::update_window;
+    m_commandLog.push_back(std::move(command));
+    // capacity is kept, so log doesn't allocate in next frames
+    std::swap(m_lastFrameCommandLog, m_commandLog);
+    m_commandLog.clear();
+    std::swap(m_lastFrameUniformParameters, m_uniformParameters);
+    m_uniformParameters.clear();
+
+    const auto now = clock_t::now();
+    m_statistics.framesTime += now - m_frameStartTime;
+    m_frameStartTime = now;
+    ++m_statistics.framesCount;
+
+    return renderClearWindow(fillingColor);
+}
+
+ISoundTrack* EngineNull::addSoundTrack(std::string_view /*path*/)
+{
+    m_soundTracks.push_back(std::make_unique<NullSoundTrack>());
+    return m_soundTracks.back().get();
+}
+
+void EngineNull::eraseSoundTrack(ISoundTrack* soundTrack)
+{
+    m_soundTracks.erase(
+        std::remove_if(m_soundTracks.begin(), m_soundTracks.end(),
+                       [soundTrack](const auto& track) {
+                           return track.get() == soundTrack;
+                       }),
+        m_soundTracks.end());
+}
+
+ISoundBuffer* EngineNull::addSoundBuffer(ISoundTrack* /*soundTrack*/)
+{
+    m_soundBuffers.push_back(std::make_unique<NullSoundBuffer>());
+    return m_soundBuffers.back().get();
+}
+
+void EngineNull::playSoundBufferOnce(ISoundTrack* /*soundTrack*/,
+                                     om::myGlfloat /*volume*/,
+                                     om::myGlfloat /*leftRightBalance*/,
+                                     om::myGlfloat /*stereo*/)
+{
+}
+
+void EngineNull::eraseSoundBuffer(ISoundBuffer* soundBuffer)
+{
+    m_soundBuffers.erase(
+        std::remove_if(m_soundBuffers.begin(), m_soundBuffers.end(),
+                       [soundBuffer](const auto& buffer) {
+                           return buffer.get() == soundBuffer;
+                       }),
+        m_soundBuffers.end());
+}
+
+std::array<myGlfloat, 2> EngineNull::getDrawableInchesSize()
+{
+    return { nullPixelWidth * nullInchesPerPixel,
+             nullPixelHeight * nullInchesPerPixel };
+}
+
+std::array<int, 2> EngineNull::getDrawablePixelSize()
+{
+    return { nullPixelWidth, nullPixelHeight };
+}
+
+std::array<int, 2> EngineNull::getDisplayPixelSize()
+{
+    return { nullPixelWidth, nullPixelHeight };
+}
+
+int EngineNull::getDisplayRefreshRate()
+{
+    return nullRefreshRate;
+}
+
+void EngineNull::uiNewFrame()
+{
+    m_imguiEngine.newFrame();
+    m_isUiNewFrameEvoked = true;
+}
+
+void EngineNull::uiRender()
+{
+    if (m_isUiNewFrameEvoked)
+    {
+        // draw lists of ImGui are passed to render as with window
+        ImGui::Render();
+    }
+    m_isUiNewFrameEvoked = false;
+}
+
+ProgramId EngineNull::findProgram(ProgramId programId) const
+{
+    return m_programs.count(programId) != 0 ? programId : m_currentProgramId;
+}
+
+void EngineNull::recordTextures(ArrayView<TextureId> textureIds)
+{
+    for (const auto textureId : textureIds)
+    {
+        Command command;
+        command.type      = Command::Type::bind_texture;
+        command.textureId = textureId;
+        m_commandLog.push_back(std::move(command));
+    }
+    m_statistics.textureBinds += textureIds.size();
+}
+
+bool EngineNull::recordUniform(std::string_view uniformName,
+                               size_t parametersCount, ProgramId programId)
+{
+    const auto parametersOffset = m_uniformParameters.size() - parametersCount;
+    const auto foundProgramId   = findProgram(programId);
+    if (!foundProgramId.isInit())
+    {
+        m_uniformParameters.resize(parametersOffset);
+        return false;
+    }
+    Command command;
+    command.type                    = Command::Type::set_uniform;
+    command.programId               = foundProgramId;
+    command.uniformName             = uniformName;
+    command.uniformParametersOffset = parametersOffset;
+    command.uniformParametersCount  = parametersCount;
+    m_commandLog.push_back(std::move(command));
+    ++m_statistics.uniformSets;
+    return true;
+}
+
+void EngineNull::recordMoveMatrix(const std::string_view moveUnifromName,
+                                  const Matrix<3, 3>&    moveMatrix,
+                                  ProgramId              programId)
+{
+    for (const auto& column : moveMatrix)
+    {
+        m_uniformParameters.insert(m_uniformParameters.end(), column.begin(),
+                                   column.end());
+    }
+    recordUniform(moveUnifromName, 9, programId);
+}
+
+void EngineNull::recordDraw(size_t verticesCount, ArrayView<myUint> indices,
+                            ShapeType type, ProgramId programId)
+{
+    const auto foundProgramId = findProgram(programId);
+    if (!foundProgramId.isInit())
+    {
+        return;
+    }
+    const auto vertexNumber = static_cast<size_t>(type);
+    if ((indices.size() % vertexNumber) != 0)
+    {
+        std::cerr
+            << "Error draw triangles. Number of indices should multiply 3."
+            << std::endl;
+    }
+    Command command;
+    command.type          = Command::Type::draw;
+    command.programId     = foundProgramId;
+    command.shapeType     = type;
+    command.verticesCount = verticesCount;
+    command.indicesCount  = indices.size();
+    m_commandLog.push_back(std::move(command));
+    ++m_statistics.drawCalls;
+    m_statistics.vertices += verticesCount;
+    m_statistics.indices += indices.size();
+}
+
+} // end namespace om
@@ -1,13 +1,21 @@
 #include "engine_sdl.hpp"
+#include "frame_arena.hpp"
+#include "metrics_registry.hpp"
 #include "opengl_debug.hpp"
+#include "program_cache.hpp"
+#include "texture_cache.hpp"
+#include "trace.hpp"
 #include <algorithm>
 #include <array>
 #include <chrono>
 #include <cmath>
 #include <exception>
 #include <fstream>
+#include <future>
 #include <imgui.h>
 #include <iostream>
+#include <limits>
+#include <optional>
 #include <sstream>
 #include <stdexcept>
 #include <vector>
@@ -49,8 +57,8 @@ std::ostream& operator<<(std::ostream& stream, const EventType e)
           "up_pressed", "up_released", "down_pressed", "down_released",
           "select_pressed", "select_released", "start_pressed",
           "start_released", "button1_pressed ", " button1_released ",
-          "button2_pressed", "button2_released", "cursor_motion",
-          "wheel_rolled",
+          "button2_pressed", "button2_released", "button3_pressed",
+          "button3_released", "cursor_motion", "wheel_rolled",
           /// virtual console events
           "turn_off" }
     };
@@ -118,7 +126,7 @@ struct bindMouse
 
 static bool check_input(const SDL_Event& e, const bind*& result)
 {
-    static const std::array<bind, 7 /*8*/> keys{
+    static const std::array<bind, 8 /*9*/> keys{
         { { SDL_SCANCODE_W, "up", EventType::up_pressed,
             EventType::up_released },
           { SDL_SCANCODE_A, "left", EventType::left_pressed,
@@ -134,7 +142,9 @@ static bool check_input(const SDL_Event& e, const bind*& result)
           { SDL_SCANCODE_ESCAPE, "select", EventType::select_pressed,
             EventType::select_released },
           { SDL_SCANCODE_RETURN, "start", EventType::start_pressed,
-            EventType::start_released } }
+            EventType::start_released },
+          { SDL_SCANCODE_F9, "button3", EventType::button3_pressed,
+            EventType::button3_released } }
     };
 
     using namespace std;
@@ -194,6 +204,8 @@ std::string EngineSdl::initialize(std::string_view windowName,
         return serr.str();
     }
 
+    initCacheDirectories(windowName);
+
     auto isInitOpenGlContext = initOpenGl(serr);
     if (!isInitOpenGlContext)
     {
@@ -236,6 +248,45 @@ std::string EngineSdl::initialize(std::string_view windowName,
     return serr.str();
 }
 
+void EngineSdl::initCacheDirectories(std::string_view windowName)
+{
+    char* prefPath = SDL_GetPrefPath("om", std::string{ windowName }.c_str());
+    if (prefPath == nullptr)
+    {
+        std::clog << "Texture and program caches are disabled. "
+                  << SDL_GetError() << std::endl;
+        return;
+    }
+    TextureCache::setDirectory(std::string{ prefPath } + "texture_cache");
+    ProgramCache::setDirectory(std::string{ prefPath } + "program_cache");
+    SDL_free(prefPath);
+}
+
+void EngineSdl::initProgramCacheDriver()
+{
+    GLint numberOfBinaryFormats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numberOfBinaryFormats);
+    if (!isGlResultOk() || numberOfBinaryFormats <= 0)
+    {
+        std::clog << "Program binaries are not supported by driver"
+                  << std::endl;
+        return;
+    }
+    std::string driver;
+    for (const auto name : { GL_VENDOR, GL_RENDERER, GL_VERSION })
+    {
+        const auto value = glGetString(name);
+        isGlResultOk();
+        if (value == nullptr)
+        {
+            return;
+        }
+        driver += reinterpret_cast<const char*>(value);
+        driver += '\n';
+    }
+    ProgramCache::setDriver(std::move(driver));
+}
+
 bool EngineSdl::initSdl(std::stringstream& serr)
 {
     SDL_version compiled = { 0, 0, 0 };
@@ -600,6 +651,20 @@ bool EngineSdl::loadGLFunctionsPointers(std::stringstream& serr)
         std::cerr << "Noncritical exception: " << ex.what() << std::endl
                   << "text debug is unable" << std::endl;
     }
+    // For program cache
+    try
+    {
+        getGlFunctionPointer("glGetString", glad_glGetString);
+        getGlFunctionPointer("glProgramParameteri", glad_glProgramParameteri);
+        getGlFunctionPointer("glGetProgramBinary", glad_glGetProgramBinary);
+        getGlFunctionPointer("glProgramBinary", glad_glProgramBinary);
+        initProgramCacheDriver();
+    }
+    catch (std::runtime_error& ex)
+    {
+        std::cerr << "Noncritical exception: " << ex.what() << std::endl
+                  << "program cache is unable" << std::endl;
+    }
 
     return true;
 }
@@ -669,6 +734,8 @@ void EngineSdl::setAdditionalGlParameters()
     // float-sized it is necessary.
     glViewport(0, 0, initialWpixels, initialHpixels);
     isGlResultOk();
+    m_drawablePixelSize = { static_cast<int>(initialWpixels),
+                            static_cast<int>(initialHpixels) };
 
     // Enabling Z-buffer
     // glEnable(GL_DEPTH_TEST);
@@ -789,6 +856,10 @@ void EngineSdl::uninitialize()
 {
     m_audioEngine.shutdown();
     m_imguiEngine.shutdown();
+    // waits for decoding threads
+    m_pendingTextures.clear();
+    m_failedTextures.clear();
+    m_placeholderTexture.reset();
     SDL_GL_DeleteContext(m_glContext);
     SDL_DestroyWindow(m_window);
     SDL_Quit();
@@ -802,8 +873,15 @@ ProgramId EngineSdl::addProgram(
 
     const ProgramId thisId{ lastProgramId.id + 1 };
 
+    const auto startTime = std::chrono::steady_clock::now();
     GlProgram  tempGlProg{ vertexShaderFileName, fragmentShaderFileName,
                           attributes, m_shaderVersionLine };
+    const std::chrono::duration<double, std::milli> creationTime =
+        std::chrono::steady_clock::now() - startTime;
+    std::clog << "Program " << vertexShaderFileName << " is "
+              << (tempGlProg.isLoadedFromCache() ? "loaded from binary"
+                                                 : "compiled")
+              << " in " << creationTime.count() << " ms" << std::endl;
     const auto constructionResult =
         m_programs.emplace(thisId, std::move(tempGlProg));
     if (constructionResult.second)
@@ -817,6 +895,13 @@ bool EngineSdl::eraseProgram(ProgramId programId)
     return numberOfDeleted == 1;
 }
 
+size_t EngineSdl::getTextureMemorySize(TextureId textureId) const
+{
+    const auto textureIt = m_textures.find(textureId);
+    return textureIt != m_textures.end() ? textureIt->second.getMemorySize()
+                                         : 0;
+}
+
 TextureId EngineSdl::addTexture(const std::string_view& pathToTexture)
 {
     ++lastTextureId.id;
@@ -842,12 +927,97 @@ TextureId EngineSdl::addTexture(const uint_least8_t* const pixels,
     return (constructionResult.second) ? thisId : TextureId{};
 }
 
+TextureId EngineSdl::addTextureAsync(const std::string_view& pathToTexture)
+{
+    if (!m_placeholderTexture)
+    {
+        const std::array<uint_least8_t, 4> transparentPixel{};
+        m_placeholderTexture.emplace(transparentPixel.data(), 1, 1);
+    }
+
+    ++lastTextureId.id;
+    const auto thisId{ lastTextureId };
+
+    m_pendingTextures.emplace(
+        thisId, std::async(std::launch::async,
+                           [path = std::string{ pathToTexture }]() {
+                               GlTexture::DecodedImage image;
+                               return GlTexture::decodeFile(path, image)
+                                          ? DecodingResult{ std::move(image) }
+                                          : std::nullopt;
+                           }));
+    return thisId;
+}
+
+size_t EngineSdl::getPendingTexturesCount() const
+{
+    return m_pendingTextures.size();
+}
+
 bool EngineSdl::eraseTexture(TextureId textureId)
 {
-    const auto numberOfDeleted = m_textures.erase(textureId);
+    const auto numberOfDeleted = m_textures.erase(textureId) +
+                                 m_pendingTextures.erase(textureId) +
+                                 m_failedTextures.erase(textureId);
     return numberOfDeleted == 1;
 }
 
+void EngineSdl::uploadTextures()
+{
+    static auto& uploadTime =
+        MetricsRegistry::getHistogram("render.texture_upload_us");
+    MetricsRegistry::ScopedTimer uploadTimer{ uploadTime };
+    using clock = std::chrono::steady_clock;
+    const auto startTime = clock::now();
+    for (auto it = m_pendingTextures.begin(); it != m_pendingTextures.end();)
+    {
+        if (clock::now() - startTime >= textureUploadBudget)
+        {
+            break;
+        }
+        auto& decoding = it->second;
+        if (decoding.wait_for(std::chrono::seconds{}) !=
+            std::future_status::ready)
+        {
+            ++it;
+            continue;
+        }
+        auto image = decoding.get();
+        if (image)
+        {
+            try
+            {
+                m_textures.emplace(it->first, GlTexture{ std::move(*image) });
+            }
+            catch (const std::runtime_error&)
+            {
+                // error is reported by texture
+                m_failedTextures.insert(it->first);
+            }
+        }
+        else
+        {
+            std::cerr << "Error loading texture " << it->first.id << std::endl;
+            m_failedTextures.insert(it->first);
+        }
+        it = m_pendingTextures.erase(it);
+    }
+
+    for (auto& [textureId, texture] : m_textures)
+    {
+        while (texture.isStreamingNeeded() &&
+               clock::now() - startTime < textureUploadBudget)
+        {
+            if (!texture.streamNextLevel())
+            {
+                std::cerr << "Error streaming level of texture "
+                          << textureId.id << std::endl;
+                break;
+            }
+        }
+    }
+}
+
 bool EngineSdl::setCurrentDefaultProgram(ProgramId programId)
 {
     m_currentProgram = findProgram(programId);
@@ -890,37 +1060,38 @@ bool EngineSdl::renderClearWindow(Color color)
     return clearColorResult && clearResult;
 }
 
-void EngineSdl::render(
-    const std::vector<VertexWide>& vertices, const std::vector<myUint>& indices,
-    const std::vector<TextureId>&        textureIds,
-    const std::vector<std::string_view>& textureAttributesNames,
-    const Matrix<3, 3>& moveMatrix, const std::string_view moveUnifromName,
-    ProgramId programId, ShapeType type)
+void EngineSdl::render(ArrayView<VertexWide>       vertices,
+                       ArrayView<myUint>           indices,
+                       ArrayView<TextureId>        textureIds,
+                       ArrayView<std::string_view> textureAttributesNames,
+                       const Matrix<3, 3>&         moveMatrix,
+                       const std::string_view      moveUnifromName,
+                       ProgramId programId, ShapeType type)
 {
     auto glprogram = findProgram(programId);
     glprogram->setUniform(moveUnifromName, moveMatrix);
     renderTexturedInternal(vertices, indices, textureIds,
-                           textureAttributesNames, type, programId);
+                           textureAttributesNames, moveMatrix, type, programId);
 }
 
-void EngineSdl::render(
-    const std::vector<VertexTextured>&   vertices,
-    const std::vector<myUint>&           indices,
-    const std::vector<TextureId>&        textureIds,
-    const std::vector<std::string_view>& textureAttributesNames,
-    const Matrix<3, 3>& moveMatrix, const std::string_view moveUnifromName,
-    ProgramId programId, ShapeType type)
+void EngineSdl::render(ArrayView<VertexTextured>   vertices,
+                       ArrayView<myUint>           indices,
+                       ArrayView<TextureId>        textureIds,
+                       ArrayView<std::string_view> textureAttributesNames,
+                       const Matrix<3, 3>&         moveMatrix,
+                       const std::string_view      moveUnifromName,
+                       ProgramId programId, ShapeType type)
 {
     auto glprogram = findProgram(programId);
     glprogram->setUniform(moveUnifromName, moveMatrix);
     renderTexturedInternal(vertices, indices, textureIds,
-                           textureAttributesNames, type, programId);
+                           textureAttributesNames, moveMatrix, type, programId);
 }
 
-void EngineSdl::render(const std::vector<VertexMorphed>& vertices,
-                       const std::vector<myUint>&        indices,
-                       const Matrix<3, 3>&               moveMatrix,
-                       const std::string_view            moveUnifromName,
+void EngineSdl::render(ArrayView<VertexMorphed> vertices,
+                       ArrayView<myUint>        indices,
+                       const Matrix<3, 3>&      moveMatrix,
+                       const std::string_view   moveUnifromName,
                        ProgramId programId, ShapeType type)
 {
     auto glprogram = findProgram(programId);
@@ -928,10 +1099,9 @@ void EngineSdl::render(const std::vector<VertexMorphed>& vertices,
     renderInternal(vertices, indices, type, programId);
 }
 
-void EngineSdl::render(const std::vector<Vertex>& vertices,
-                       const std::vector<myUint>& indices,
-                       const Matrix<3, 3>&        moveMatrix,
-                       const std::string_view     moveUnifromName,
+void EngineSdl::render(ArrayView<Vertex> vertices, ArrayView<myUint> indices,
+                       const Matrix<3, 3>&    moveMatrix,
+                       const std::string_view moveUnifromName,
                        ProgramId programId, ShapeType type)
 {
     auto glprogram = findProgram(programId);
@@ -939,37 +1109,37 @@ void EngineSdl::render(const std::vector<Vertex>& vertices,
     renderInternal(vertices, indices, type, programId);
 }
 
-void EngineSdl::render(
-    const std::vector<VertexWide>& vertices, const std::vector<myUint>& indices,
-    const std::vector<TextureId>&        textureIds,
-    const std::vector<std::string_view>& textureAttributesNames,
-    ProgramId programId, ShapeType type)
+void EngineSdl::render(ArrayView<VertexWide>       vertices,
+                       ArrayView<myUint>           indices,
+                       ArrayView<TextureId>        textureIds,
+                       ArrayView<std::string_view> textureAttributesNames,
+                       ProgramId programId, ShapeType type)
 {
     renderTexturedInternal(vertices, indices, textureIds,
-                           textureAttributesNames, type, programId);
+                           textureAttributesNames,
+                           MatrixFunctor::getOneMatrix(), type, programId);
 }
 
-void EngineSdl::render(
-    const std::vector<VertexTextured>&   vertices,
-    const std::vector<myUint>&           indices,
-    const std::vector<TextureId>&        textureIds,
-    const std::vector<std::string_view>& textureAttributesNames,
-    ProgramId programId, ShapeType type)
+void EngineSdl::render(ArrayView<VertexTextured>   vertices,
+                       ArrayView<myUint>           indices,
+                       ArrayView<TextureId>        textureIds,
+                       ArrayView<std::string_view> textureAttributesNames,
+                       ProgramId programId, ShapeType type)
 {
     renderTexturedInternal(vertices, indices, textureIds,
-                           textureAttributesNames, type, programId);
+                           textureAttributesNames,
+                           MatrixFunctor::getOneMatrix(), type, programId);
 }
 
-void EngineSdl::render(const std::vector<VertexMorphed>& vertices,
-                       const std::vector<myUint>& indices, ProgramId programId,
+void EngineSdl::render(ArrayView<VertexMorphed> vertices,
+                       ArrayView<myUint> indices, ProgramId programId,
                        ShapeType type)
 {
     renderInternal(vertices, indices, type, programId);
 }
 
-void EngineSdl::render(const std::vector<Vertex>& vertices,
-                       const std::vector<myUint>& indices, ProgramId programId,
-                       ShapeType type)
+void EngineSdl::render(ArrayView<Vertex> vertices, ArrayView<myUint> indices,
+                       ProgramId programId, ShapeType type)
 {
     renderInternal(vertices, indices, type, programId);
 }
@@ -983,10 +1153,17 @@ static bool isUiNewFrameEvoked{};
 
 bool EngineSdl::updateWindow(Color fillingColor)
 {
+    OM_TRACE_SCOPE("EngineSdl::updateWindow");
     if (isUiNewFrameEvoked)
         uiRender();
     isUiNewFrameEvoked = false;
-    SDL_GL_SwapWindow(m_window);
+    // all temporaries of the frame are drawn already
+    FrameArena::getFrameArena().reset();
+    {
+        OM_TRACE_SCOPE("SDL_GL_SwapWindow");
+        SDL_GL_SwapWindow(m_window);
+    }
+    uploadTextures();
     renderClearWindow(fillingColor);
     return isGlResultOk();
 }
@@ -1054,6 +1231,12 @@ GlTexture* EngineSdl::findTexture(TextureId textureId)
     {
         outProgramPtr = &textureIt->second;
     }
+    else if (m_pendingTextures.count(textureId) != 0 ||
+             m_failedTextures.count(textureId) != 0)
+    {
+        // failed texture isn't replaced by the last bound one
+        outProgramPtr = &*m_placeholderTexture;
+    }
     if (!outProgramPtr)
     {
         std::cerr << "Attempt to find texture " << textureId.id << " failed";
@@ -1061,16 +1244,63 @@ GlTexture* EngineSdl::findTexture(TextureId textureId)
     return outProgramPtr;
 }
 
+/// Derivatives of texture coordinates by screen pixels (du/dx, dv/dx, du/dy,
+/// dv/dy) for the first triangle, nullopt if it is degenerate
+template <typename T>
+static std::optional<std::array<myGlfloat, 4>> calcTexCoordDerivatives(
+    ArrayView<T> vertices, ArrayView<myUint> indices,
+    const Matrix<3, 3>& moveMatrix, std::array<int, 2> pixelSize)
+{
+    if (indices.size() < 3)
+    {
+        return std::nullopt;
+    }
+    const auto& v0 = vertices[indices[0]];
+    const auto& v1 = vertices[indices[1]];
+    const auto& v2 = vertices[indices[2]];
+
+    // shift of move matrix doesn't change derivatives
+    const auto& c0         = moveMatrix.columns[0].elements;
+    const auto& c1         = moveMatrix.columns[1].elements;
+    const auto  halfWidth  = static_cast<myGlfloat>(pixelSize[0]) / 2;
+    const auto  halfHeight = static_cast<myGlfloat>(pixelSize[1]) / 2;
+    const auto  toPixels   = [&](myGlfloat dx, myGlfloat dy) {
+        return std::array<myGlfloat, 2>{ (c0[0] * dx + c1[0] * dy) * halfWidth,
+                                         (c0[1] * dx + c1[1] * dy) *
+                                             halfHeight };
+    };
+    const auto e1 = toPixels(v1.position.x - v0.position.x,
+                             v1.position.y - v0.position.y);
+    const auto e2 = toPixels(v2.position.x - v0.position.x,
+                             v2.position.y - v0.position.y);
+    const auto determinant = e1[0] * e2[1] - e2[0] * e1[1];
+    if (std::abs(determinant) < std::numeric_limits<myGlfloat>::epsilon())
+    {
+        return std::nullopt;
+    }
+    const std::array<myGlfloat, 2> t1{ v1.position_tex.x - v0.position_tex.x,
+                                       v1.position_tex.y - v0.position_tex.y };
+    const std::array<myGlfloat, 2> t2{ v2.position_tex.x - v0.position_tex.x,
+                                       v2.position_tex.y - v0.position_tex.y };
+    // texture edges multiplied by inverted screen edges
+    return std::array<myGlfloat, 4>{
+        (t1[0] * e2[1] - t2[0] * e1[1]) / determinant,
+        (t1[1] * e2[1] - t2[1] * e1[1]) / determinant,
+        (t2[0] * e1[0] - t1[0] * e2[0]) / determinant,
+        (t2[1] * e1[0] - t1[1] * e2[0]) / determinant
+    };
+}
+
 template <typename T, typename>
 void EngineSdl::renderTexturedInternal(
-    const std::vector<T>& vertices, const std::vector<myUint>& indices,
-    std::vector<TextureId>        textureIds,
-    std::vector<std::string_view> textureAttributesNames, ShapeType type,
-    ProgramId programId)
+    ArrayView<T> vertices, ArrayView<myUint> indices,
+    ArrayView<TextureId>        textureIds,
+    ArrayView<std::string_view> textureAttributesNames,
+    const Matrix<3, 3>& moveMatrix, ShapeType type, ProgramId programId)
 {
 
     auto                    glprogram = findProgram(programId);
-    std::vector<GlTexture*> textures;
+    FrameVector<GlTexture*> textures;
     textures.reserve(textureIds.size());
 
     auto findTextureWrap = [this](const TextureId& textureId) {
@@ -1080,6 +1310,19 @@ void EngineSdl::renderTexturedInternal(
     std::transform(std::begin(textureIds), std::end(textureIds),
                    std::back_inserter(textures), findTextureWrap);
 
+    // finer mip levels are streamed by updateWindow if they are needed
+    if (const auto derivatives = calcTexCoordDerivatives(
+            vertices, indices, moveMatrix, getDrawablePixelSize()))
+    {
+        for (auto* texture : textures)
+        {
+            if (texture)
+            {
+                texture->requestDetail(*derivatives);
+            }
+        }
+    }
+
     glprogram->setTextures(textureAttributesNames, textures);
     renderInternal(vertices, indices, type, programId);
     glprogram->resetTextures();
@@ -1089,18 +1332,17 @@ template <typename T, typename>
 void EngineSdl::renderTriangleInternal(const Triangle<T>& t,
                                        ProgramId          programId)
 {
-    const std::vector<T>      vertices{ &t.v[0], &t.v[3] };
-    const std::vector<myUint> indices{ 0, 1, 2 };
-    const auto                type = ShapeType::triangle;
-    renderInternal(vertices, indices, type, programId);
+    const std::array<myUint, 3> indices{ 0, 1, 2 };
+    const auto                  type = ShapeType::triangle;
+    renderInternal(ArrayView<T>{ t.v, 3 }, ArrayView<myUint>{ indices }, type,
+                   programId);
 }
 
 template <typename T, typename>
-void EngineSdl::renderInternal(const std::vector<T>&      vertices,
-                               const std::vector<myUint>& indices,
+void EngineSdl::renderInternal(ArrayView<T> vertices, ArrayView<myUint> indices,
                                ShapeType type, ProgramId programId)
 {
-
+    OM_TRACE_SCOPE("EngineSdl::renderInternal");
     auto glprogram = findProgram(programId);
     if (!glprogram)
     {
@@ -1122,10 +1364,17 @@ void EngineSdl::renderInternal(const std::vector<T>&      vertices,
             << std::endl;
     }
 
+    static auto& bufferUploadBytes =
+        MetricsRegistry::getCounter("render.buffer_upload_bytes");
+    static auto& drawCalls = MetricsRegistry::getCounter("render.draw_calls");
+    static auto& drawIndices =
+        MetricsRegistry::getCounter("render.draw_indices");
+
     // Fill internal OpenGL Vertices buffer with triangle
     glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(T), vertices.data(),
                  GL_STATIC_DRAW);
     isGlResultOk();
+    bufferUploadBytes.add(vertices.size() * sizeof(T));
 
     // Fill internal OpenGL indices buffer with triangle
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, numberOfIndeces * sizeof(myUint),
@@ -1183,6 +1432,8 @@ void EngineSdl::renderInternal(const std::vector<T>&      vertices,
     const GLsizei indicesDataType = GL_UNSIGNED_INT;
     glDrawElements(shapeGlType, numberOfIndeces, indicesDataType, nullptr);
     isGlResultOk();
+    drawCalls.add();
+    drawIndices.add(numberOfIndeces);
 
     auto disable_gl_attribute = [](myUint attributeNumber) {
         glDisableVertexAttribArray(attributeNumber);
@@ -1195,16 +1446,7 @@ void EngineSdl::renderInternal(const std::vector<T>&      vertices,
 
 std::array<int, 2> EngineSdl::getDrawablePixelSize()
 {
-
-    GLint viewPort[4];
-
-    glGetIntegerv(GL_VIEWPORT, viewPort);
-
-    //    int wPixels;
-    //    int hPixels;
-    //    SDL_GetWindowSize(m_window, &wPixels, &hPixels);
-
-    return { viewPort[2], viewPort[3] };
+    return m_drawablePixelSize;
 }
 
 std::array<myGlfloat, 2> EngineSdl::getDrawableInchesSize()
@@ -1237,12 +1479,14 @@ bool EngineSdl::resizeSdlGlWindow(const int w, const int h)
         GLint newH   = w / baseScaleXtoY;
         GLint yShift = (h - newH) / 2;
         glViewport(0, yShift, w, newH);
+        m_drawablePixelSize = { w, newH };
     }
     else
     {
         GLint newW   = h * baseScaleXtoY;
         GLint xShift = (w - newW) / 2;
         glViewport(xShift, 0, newW, h);
+        m_drawablePixelSize = { newW, h };
     }
 
     return isGlResultOk();
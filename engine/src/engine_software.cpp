@@ -0,0 +1,333 @@
+#include "engine_software.hpp"
+#include "png_writer.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+namespace om
+{
+
+std::string EngineSoftware::initialize(std::string_view windowName,
+                                       std::string_view config)
+{
+    std::stringstream serr;
+    // directory may contain spaces, so fields are separated by new lines
+    std::array<std::string_view, 3> fields;
+    for (size_t i = 0, begin = 0; i < fields.size() && begin <= config.size();
+         ++i)
+    {
+        const auto end =
+            std::min(config.find(configSeparator, begin), config.size());
+        fields[i] = config.substr(begin, end - begin);
+        begin     = end + 1;
+    }
+    const auto& framesCount = fields[0];
+    m_pngDirectory          = fields[1];
+    m_pngPeriod             = 1;
+    if (!fields[2].empty())
+    {
+        std::istringstream periodStream{ std::string{ fields[2] } };
+        if (!(periodStream >> m_pngPeriod) || !periodStream.eof())
+        {
+            m_pngPeriod = 0;
+        }
+    }
+    if (m_pngPeriod == 0)
+    {
+        serr << "Incorrect png period in config: " << fields[2] << std::endl;
+        return serr.str();
+    }
+
+    if (!m_pngDirectory.empty())
+    {
+        std::error_code error;
+        std::filesystem::create_directories(m_pngDirectory, error);
+        if (error)
+        {
+            serr << "Can't create directory " << m_pngDirectory << ". "
+                 << error.message() << std::endl;
+            return serr.str();
+        }
+    }
+
+    const auto size = getDrawablePixelSize();
+    m_rasterizer.emplace(static_cast<size_t>(size[0]),
+                         static_cast<size_t>(size[1]),
+                         std::thread::hardware_concurrency());
+
+    return EngineNull::initialize(windowName, framesCount);
+}
+
+void EngineSoftware::uninitialize()
+{
+    EngineNull::uninitialize();
+    m_texturesPixels.clear();
+    if (!m_rasterizer || m_rasterizer->getStatistics().framesCount == 0)
+    {
+        return;
+    }
+    const auto& statistics = m_rasterizer->getStatistics();
+    const auto  frames     = static_cast<double>(statistics.framesCount);
+    const auto  rasterizationSeconds =
+        statistics.rasterizationTime.count() / 1000;
+    std::clog << "Software rasterizer frames: " << statistics.framesCount
+              << " rasterization time: "
+              << statistics.rasterizationTime.count() / frames
+              << " ms triangles: " << statistics.triangles / frames
+              << " pixels: " << statistics.pixels / frames
+              << " per frame, throughput: "
+              << statistics.pixels / rasterizationSeconds / 1e6
+              << " Mpixels/s" << std::endl;
+}
+
+TextureId EngineSoftware::addTexture(const std::string_view& pathToTexture)
+{
+    auto image = std::make_shared<SoftwareRasterizer::Texture>();
+    if (!GlTexture::decodeFile(pathToTexture, *image))
+    {
+        std::cerr << "Can't decode texture " << pathToTexture << std::endl;
+        return TextureId{};
+    }
+    const auto textureId = EngineNull::addTexture(pathToTexture);
+    m_texturesPixels.emplace(textureId, std::move(image));
+    return textureId;
+}
+
+TextureId EngineSoftware::addTexture(const uint_least8_t* const pixels,
+                                     const size_t w, const size_t h)
+{
+    auto image = std::make_shared<SoftwareRasterizer::Texture>();
+    image->w   = w;
+    image->h   = h;
+    image->pixels.resize(w * h * 4);
+    std::memcpy(image->pixels.data(), pixels, image->pixels.size());
+    const auto textureId = EngineNull::addTexture(pixels, w, h);
+    m_texturesPixels.emplace(textureId, std::move(image));
+    return textureId;
+}
+
+bool EngineSoftware::eraseTexture(TextureId textureId)
+{
+    // triangles of current frame keep their textures
+    m_texturesPixels.erase(textureId);
+    return EngineNull::eraseTexture(textureId);
+}
+
+size_t EngineSoftware::getTextureMemorySize(TextureId textureId) const
+{
+    // pixels of CPU rasterizer stand for video memory
+    const auto textureIt = m_texturesPixels.find(textureId);
+    return textureIt != m_texturesPixels.end()
+               ? textureIt->second->getLevelOffset(
+                     textureIt->second->levelsCount)
+               : 0;
+}
+
+bool EngineSoftware::renderClearWindow(Color color)
+{
+    m_rasterizer->clear(color);
+    return EngineNull::renderClearWindow(color);
+}
+
+void EngineSoftware::render(ArrayView<VertexWide>       vertices,
+                            ArrayView<myUint>           indices,
+                            ArrayView<TextureId>        textureIds,
+                            ArrayView<std::string_view> textureAttributesNames,
+                            const Matrix<3, 3>&         moveMatrix,
+                            const std::string_view      moveUnifromName,
+                            ProgramId programId, ShapeType type)
+{
+    EngineNull::render(vertices, indices, textureIds, textureAttributesNames,
+                       moveMatrix, moveUnifromName, programId, type);
+    rasterizeInternal(vertices, indices, textureIds,
+                      setMoveMatrix(programId, moveMatrix), type);
+}
+
+void EngineSoftware::render(ArrayView<VertexTextured>   vertices,
+                            ArrayView<myUint>           indices,
+                            ArrayView<TextureId>        textureIds,
+                            ArrayView<std::string_view> textureAttributesNames,
+                            const Matrix<3, 3>&         moveMatrix,
+                            const std::string_view      moveUnifromName,
+                            ProgramId programId, ShapeType type)
+{
+    EngineNull::render(vertices, indices, textureIds, textureAttributesNames,
+                       moveMatrix, moveUnifromName, programId, type);
+    rasterizeInternal(vertices, indices, textureIds,
+                      setMoveMatrix(programId, moveMatrix), type);
+}
+
+void EngineSoftware::render(ArrayView<VertexMorphed> vertices,
+                            ArrayView<myUint>        indices,
+                            const Matrix<3, 3>&      moveMatrix,
+                            const std::string_view   moveUnifromName,
+                            ProgramId programId, ShapeType type)
+{
+    EngineNull::render(vertices, indices, moveMatrix, moveUnifromName,
+                       programId, type);
+    rasterizeInternal(vertices, indices, {},
+                      setMoveMatrix(programId, moveMatrix), type);
+}
+
+void EngineSoftware::render(ArrayView<Vertex>      vertices,
+                            ArrayView<myUint>      indices,
+                            const Matrix<3, 3>&    moveMatrix,
+                            const std::string_view moveUnifromName,
+                            ProgramId programId, ShapeType type)
+{
+    EngineNull::render(vertices, indices, moveMatrix, moveUnifromName,
+                       programId, type);
+    rasterizeInternal(vertices, indices, {},
+                      setMoveMatrix(programId, moveMatrix), type);
+}
+
+void EngineSoftware::render(ArrayView<VertexWide>       vertices,
+                            ArrayView<myUint>           indices,
+                            ArrayView<TextureId>        textureIds,
+                            ArrayView<std::string_view> textureAttributesNames,
+                            ProgramId programId, ShapeType type)
+{
+    EngineNull::render(vertices, indices, textureIds, textureAttributesNames,
+                       programId, type);
+    rasterizeInternal(vertices, indices, textureIds,
+                      findMoveMatrix(programId), type);
+}
+
+void EngineSoftware::render(ArrayView<VertexTextured>   vertices,
+                            ArrayView<myUint>           indices,
+                            ArrayView<TextureId>        textureIds,
+                            ArrayView<std::string_view> textureAttributesNames,
+                            ProgramId programId, ShapeType type)
+{
+    EngineNull::render(vertices, indices, textureIds, textureAttributesNames,
+                       programId, type);
+    rasterizeInternal(vertices, indices, textureIds,
+                      findMoveMatrix(programId), type);
+}
+
+void EngineSoftware::render(ArrayView<VertexMorphed> vertices,
+                            ArrayView<myUint> indices, ProgramId programId,
+                            ShapeType type)
+{
+    EngineNull::render(vertices, indices, programId, type);
+    rasterizeInternal(vertices, indices, {}, findMoveMatrix(programId), type);
+}
+
+void EngineSoftware::render(ArrayView<Vertex> vertices,
+                            ArrayView<myUint> indices, ProgramId programId,
+                            ShapeType type)
+{
+    EngineNull::render(vertices, indices, programId, type);
+    rasterizeInternal(vertices, indices, {}, findMoveMatrix(programId), type);
+}
+
+void EngineSoftware::renderTriangle(const Triangle<Vertex>& t,
+                                    ProgramId               programId)
+{
+    EngineNull::renderTriangle(t, programId);
+    rasterizeInternal(ArrayView<Vertex>{ t.v, 3 }, { 0, 1, 2 }, {},
+                      findMoveMatrix(programId), ShapeType::triangle);
+}
+
+bool EngineSoftware::updateWindow(Color fillingColor)
+{
+    // ImGui draw lists are added before rasterization
+    uiRender();
+    const auto frameNumber = m_framesCount++;
+    m_rasterizer->rasterize();
+    if (!m_pngDirectory.empty() && frameNumber % m_pngPeriod == 0)
+    {
+        std::ostringstream path;
+        path << m_pngDirectory << "/frame_" << std::setw(5)
+             << std::setfill('0') << frameNumber << ".png";
+        writePng(path.str(), m_rasterizer->getPixels().data(),
+                 m_rasterizer->getW(), m_rasterizer->getH());
+    }
+    return EngineNull::updateWindow(fillingColor);
+}
+
+const Matrix<3, 3>& EngineSoftware::setMoveMatrix(
+    ProgramId programId, const Matrix<3, 3>& moveMatrix)
+{
+    return m_moveMatrices[findProgram(programId)] = moveMatrix;
+}
+
+const Matrix<3, 3>& EngineSoftware::findMoveMatrix(ProgramId programId)
+{
+    const auto matrixIt = m_moveMatrices.find(findProgram(programId));
+    if (matrixIt == m_moveMatrices.end())
+    {
+        static const auto oneMatrix = MatrixFunctor::getOneMatrix();
+        return oneMatrix;
+    }
+    return matrixIt->second;
+}
+
+template <typename T, typename>
+void EngineSoftware::rasterizeInternal(ArrayView<T>         vertices,
+                                       ArrayView<myUint>    indices,
+                                       ArrayView<TextureId> textureIds,
+                                       const Matrix<3, 3>&  moveMatrix,
+                                       ShapeType            type)
+{
+    if (type == ShapeType::line)
+    {
+        // lines are not drawn by rasterizer
+        return;
+    }
+    // only the first texture is sampled, as by game shaders
+    TexturePtr texture;
+    if (!textureIds.empty())
+    {
+        const auto textureIt = m_texturesPixels.find(textureIds.front());
+        if (textureIt != m_texturesPixels.end())
+        {
+            texture = textureIt->second;
+        }
+    }
+
+    const auto size   = getDrawablePixelSize();
+    const auto screen = [&](myUint index) {
+        const auto& vertex = vertices[index];
+        const auto& m      = moveMatrix.columns;
+        const auto  x      = m[0].elements[0] * vertex.position.x +
+                       m[1].elements[0] * vertex.position.y + m[2].elements[0];
+        const auto y = m[0].elements[1] * vertex.position.x +
+                       m[1].elements[1] * vertex.position.y + m[2].elements[1];
+        SoftwareRasterizer::ScreenVertex result;
+        result.x     = (x + 1) / 2 * size[0];
+        result.y     = (1 - y) / 2 * size[1];
+        result.color = vertex.color;
+        if constexpr (is_texture_vertex<T>)
+        {
+            result.u = vertex.position_tex.x;
+            result.v = vertex.position_tex.y;
+        }
+        return result;
+    };
+
+    const bool isStrip        = type == ShapeType::triangle_strip;
+    const auto trianglesCount =
+        isStrip ? std::max<size_t>(indices.size(), 2) - 2 : indices.size() / 3;
+    for (size_t i = 0; i < trianglesCount; ++i)
+    {
+        const auto first = isStrip ? i : i * 3;
+        if (indices[first] >= vertices.size() ||
+            indices[first + 1] >= vertices.size() ||
+            indices[first + 2] >= vertices.size())
+        {
+            continue;
+        }
+        m_rasterizer->addTriangle({ screen(indices[first]),
+                                    screen(indices[first + 1]),
+                                    screen(indices[first + 2]) },
+                                  texture);
+    }
+}
+
+} // end namespace om
@@ -0,0 +1,76 @@
+#include "file_utils.hpp"
+#include <atomic>
+#include <filesystem>
+#include <iostream>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace om
+{
+
+/// Unique for every writer of all processes, so writers of the same file
+/// from parallel decodes or other game instances don't mix their content
+static std::string getTemporaryPath(const std::string& path)
+{
+    static std::atomic<unsigned> writersCount{};
+#ifdef _WIN32
+    const auto processId = _getpid();
+#else
+    const auto processId = getpid();
+#endif
+    return path + '.' + std::to_string(processId) + '.' +
+           std::to_string(writersCount++) + ".tmp";
+}
+
+std::uint64_t calcFnv1a(ArrayView<std::byte> data, std::uint64_t hash)
+{
+    for (const auto byte : data)
+    {
+        hash ^= static_cast<std::uint64_t>(byte);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+AtomicFileWriter::AtomicFileWriter(std::string path)
+    : m_path{ std::move(path) }
+    , m_temporaryPath{ getTemporaryPath(m_path) }
+    , m_file{ m_temporaryPath, std::ios::binary | std::ios::trunc }
+{
+}
+
+AtomicFileWriter::~AtomicFileWriter()
+{
+    if (!m_isCommitted)
+    {
+        m_file.close();
+        std::error_code error;
+        std::filesystem::remove(m_temporaryPath, error);
+    }
+}
+
+bool AtomicFileWriter::commit()
+{
+    m_file.close();
+    if (!m_file)
+    {
+        std::cerr << "Can't write " << m_temporaryPath << std::endl;
+        return false;
+    }
+    std::error_code error;
+    std::filesystem::rename(m_temporaryPath, m_path, error);
+    if (error)
+    {
+        std::cerr << "Can't write " << m_path << ". " << error.message()
+                  << std::endl;
+        return false;
+    }
+    m_isCommitted = true;
+    return true;
+}
+
+} // namespace om
@@ -0,0 +1,96 @@
+#include "frame_arena.hpp"
+#include "metrics_registry.hpp"
+#include <algorithm>
+
+namespace om
+{
+
+FrameArena::FrameArena(size_t blockSize)
+    : m_blockSize{ blockSize }
+{
+}
+
+void* FrameArena::allocate(size_t size, size_t alignment)
+{
+    if (!m_blocks.empty())
+    {
+        auto& block = m_blocks.back();
+        void* top   = block.data.get() + m_offset;
+        auto  space = block.size - m_offset;
+        if (std::align(alignment, size, top, space))
+        {
+            m_offset = block.size - space + size;
+            return top;
+        }
+    }
+    // the rest of the last block is left unused until reset
+    addBlock(std::max(m_blockSize, size + alignment));
+    return allocate(size, alignment);
+}
+
+void FrameArena::deallocate(void* pointer, size_t size)
+{
+    if (m_blocks.empty() || size > m_offset)
+    {
+        return;
+    }
+    auto* top = m_blocks.back().data.get() + m_offset;
+    if (static_cast<std::byte*>(pointer) + size == top)
+    {
+        m_offset -= size;
+    }
+}
+
+void FrameArena::reset()
+{
+    static auto& usedBytes =
+        MetricsRegistry::getGauge("memory.frame_arena_used_bytes");
+    static auto& blocksCount =
+        MetricsRegistry::getGauge("memory.frame_arena_blocks");
+    if (this == &getFrameArena())
+    {
+        usedBytes.set(static_cast<double>(getUsedSize()));
+        blocksCount.set(static_cast<double>(m_blocks.size()));
+    }
+
+    if (m_blocks.size() > 1)
+    {
+        const auto capacity = getCapacity();
+        m_blocks.clear();
+        addBlock(capacity);
+    }
+    m_offset                 = 0;
+    m_previousBlocksUsedSize = 0;
+}
+
+size_t FrameArena::getUsedSize() const
+{
+    return m_previousBlocksUsedSize + m_offset;
+}
+
+size_t FrameArena::getCapacity() const
+{
+    size_t capacity{};
+    for (const auto& block : m_blocks)
+    {
+        capacity += block.size;
+    }
+    return capacity;
+}
+
+FrameArena& FrameArena::getFrameArena()
+{
+    static FrameArena frameArena;
+    return frameArena;
+}
+
+void FrameArena::addBlock(size_t size)
+{
+    m_previousBlocksUsedSize += m_offset;
+    // memory isn't initialized, it is overwritten by containers anyway
+    m_blocks.push_back({ std::unique_ptr<std::byte[]>{ new std::byte[size] },
+                         size });
+    m_offset = 0;
+}
+
+} // namespace om
@@ -1,5 +1,7 @@
 #include "glprogram.hpp"
+#include "asset_pack.hpp"
 #include "opengl_debug.hpp"
+#include "program_cache.hpp"
 #include <algorithm>
 #include <fstream>
 #include <iostream>
@@ -18,10 +20,38 @@ GlProgram::GlProgram(
     const std::string_view&                                 versionLine)
 {
     std::stringstream serr;
-    GLuint            vertexShader;
-    auto              vertexShaderInitResult =
-        initShader(vertexShaderFileName, GL_VERTEX_SHADER, vertexShader,
-                   versionLine, serr);
+    std::string       vertexShaderSrc;
+    std::string       fragmentShaderSrc;
+    if (!readShaderSource(vertexShaderFileName, vertexShaderSrc, serr) ||
+        !readShaderSource(fragmentShaderFileName, fragmentShaderSrc, serr))
+    {
+        std::cerr << "Cannot create shaders for program " << serr.str()
+                  << std::endl;
+        throw std::runtime_error("Cannot create shaders for program " +
+                                 serr.str());
+    }
+
+    std::vector<std::string_view> cacheKeyParts{ versionLine, vertexShaderSrc,
+                                                 fragmentShaderSrc };
+    std::vector<std::string> attributesLocations;
+    attributesLocations.reserve(attributes.size());
+    for (const auto& [location, name] : attributes)
+    {
+        attributesLocations.push_back(std::to_string(location) + ' ' +
+                                      std::string{ name });
+    }
+    cacheKeyParts.insert(cacheKeyParts.end(), attributesLocations.begin(),
+                         attributesLocations.end());
+    const auto cacheKey = ProgramCache::calcKey(cacheKeyParts);
+    if (loadProgramBinary(cacheKey))
+    {
+        m_isLoadedFromCache = true;
+        return;
+    }
+
+    GLuint vertexShader;
+    auto   vertexShaderInitResult = initShader(
+        vertexShaderSrc, GL_VERTEX_SHADER, vertexShader, versionLine, serr);
 
     if (!vertexShaderInitResult)
     {
@@ -32,9 +62,9 @@ GlProgram::GlProgram(
     }
 
     GLuint fragmentShader;
-    auto   fragmentShaderInitResult =
-        initShader(fragmentShaderFileName, GL_FRAGMENT_SHADER, fragmentShader,
-                   versionLine, serr);
+    auto   fragmentShaderInitResult = initShader(
+        fragmentShaderSrc, GL_FRAGMENT_SHADER, fragmentShader, versionLine,
+        serr);
 
     if (!fragmentShaderInitResult)
     {
@@ -53,10 +83,12 @@ GlProgram::GlProgram(
         isGlResultOk();
         throw std::runtime_error("Cannot create program " + serr.str());
     }
+    storeProgramBinary(cacheKey);
 }
 
 GlProgram::GlProgram(GlProgram&& srcProgram)
     : m_programId{ srcProgram.m_programId }
+    , m_isLoadedFromCache{ srcProgram.m_isLoadedFromCache }
 {
     srcProgram.m_programId = 0;
 }
@@ -70,44 +102,108 @@ GlProgram::~GlProgram()
 GlProgram& GlProgram::operator=(GlProgram&& srcProgram)
 {
     m_programId            = srcProgram.m_programId;
+    m_isLoadedFromCache    = srcProgram.m_isLoadedFromCache;
     srcProgram.m_programId = 0;
     return *this;
 }
 
-bool GlProgram::initShader(const std::string_view& shaderFileName, GLenum type,
-                           GLuint&                 r_shader,
-                           const std::string_view& versionLine,
-                           std::stringstream&      serr)
+bool GlProgram::readShaderSource(const std::string_view& shaderFileName,
+                                 std::string&            r_shaderSrc,
+                                 std::stringstream&      serr)
 {
-    r_shader = glCreateShader(type);
-    isGlResultOk();
-
-    std::string shaderSrc;
-
+    const auto packedSource = AssetPack::getAssetPack().find(shaderFileName);
+    if (!packedSource.empty())
     {
-        SDL_RWops *fileSrcShader = SDL_RWFromFile(shaderFileName.data(), "rb");
-        if (fileSrcShader == nullptr) {
-            serr << "Unable open file shader: " << shaderFileName << ". "
-                 << SDL_GetError() << std::endl;
-            return false;
-        }
+        r_shaderSrc.assign(reinterpret_cast<const char*>(packedSource.data()),
+                           packedSource.size());
+        return true;
+    }
 
-        const auto fileSize = fileSrcShader->size(fileSrcShader);
+    SDL_RWops* fileSrcShader = SDL_RWFromFile(shaderFileName.data(), "rb");
+    if (fileSrcShader == nullptr)
+    {
+        serr << "Unable open file shader: " << shaderFileName << ". "
+             << SDL_GetError() << std::endl;
+        return false;
+    }
 
+    const auto fileSize = fileSrcShader->size(fileSrcShader);
 
-        shaderSrc.resize(fileSize);
+    r_shaderSrc.resize(fileSize);
 
-        const auto numberOfReadenObjects = fileSrcShader->read(
-                fileSrcShader, shaderSrc.data(), fileSize, 1);
+    const auto numberOfReadenObjects =
+        fileSrcShader->read(fileSrcShader, r_shaderSrc.data(), fileSize, 1);
 
-        if (numberOfReadenObjects != 1) {
-            serr << "can't read all content from file: " << shaderFileName << ". "
-                 << SDL_GetError() << std::endl;
-            fileSrcShader->close(fileSrcShader);
-            return false;
-        }
+    if (numberOfReadenObjects != 1)
+    {
+        serr << "can't read all content from file: " << shaderFileName << ". "
+             << SDL_GetError() << std::endl;
         fileSrcShader->close(fileSrcShader);
+        return false;
+    }
+    fileSrcShader->close(fileSrcShader);
+    return true;
+}
+
+bool GlProgram::loadProgramBinary(std::uint64_t cacheKey)
+{
+    ProgramCache::Binary binary;
+    if (!ProgramCache::load(cacheKey, binary))
+    {
+        return false;
+    }
+    m_programId = glCreateProgram();
+    isGlResultOk();
+    glProgramBinary(m_programId, binary.format, binary.data.data(),
+                    static_cast<GLsizei>(binary.data.size()));
+    // error is expected if driver was updated, it is not reported
+    glGetError();
+    GLint linkedStatus = 0;
+    glGetProgramiv(m_programId, GL_LINK_STATUS, &linkedStatus);
+    isGlResultOk();
+    if (linkedStatus == 0)
+    {
+        std::clog << "Program binary is rejected by driver, it is compiled "
+                     "again"
+                  << std::endl;
+        glDeleteProgram(m_programId);
+        isGlResultOk();
+        m_programId = 0;
+        ProgramCache::erase(cacheKey);
+        return false;
+    }
+    return true;
+}
+
+void GlProgram::storeProgramBinary(std::uint64_t cacheKey)
+{
+    if (!ProgramCache::isEnabled())
+    {
+        return;
+    }
+    GLint binaryLength = 0;
+    glGetProgramiv(m_programId, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+    if (!isGlResultOk() || binaryLength <= 0)
+    {
+        return;
+    }
+    ProgramCache::Binary binary;
+    binary.data.resize(static_cast<size_t>(binaryLength));
+    glGetProgramBinary(m_programId, binaryLength, nullptr, &binary.format,
+                       binary.data.data());
+    if (isGlResultOk())
+    {
+        ProgramCache::store(cacheKey, binary);
     }
+}
+
+bool GlProgram::initShader(const std::string& shaderSrc, GLenum type,
+                           GLuint&                 r_shader,
+                           const std::string_view& versionLine,
+                           std::stringstream&      serr)
+{
+    r_shader = glCreateShader(type);
+    isGlResultOk();
 
     const auto shaderSrcWithVersion{ static_cast<std::string>(versionLine) +
                                      shaderSrc };
@@ -199,6 +295,12 @@ bool GlProgram::bindAttributesLocationAndLinkProgram(
         glBindAttribLocation(programId, numberOfAttribute, nameOfAttribute);
         isGlResultOk();
     }
+    if (ProgramCache::isEnabled())
+    {
+        glProgramParameteri(programId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT,
+                            GL_TRUE);
+        isGlResultOk();
+    }
     // link program after binding attribute locations
     glLinkProgram(programId);
     isGlResultOk();
@@ -338,9 +440,8 @@ bool GlProgram::setTexture(std::string_view textureUniformName,
     return true;
 }
 
-bool GlProgram::setTextures(
-    const std::vector<std::string_view>& textureUniformNames,
-    const std::vector<GlTexture*>&       textures)
+bool GlProgram::setTextures(ArrayView<std::string_view> textureUniformNames,
+                            ArrayView<GlTexture*>       textures)
 {
     if (textureUniformNames.size() != textures.size())
     {
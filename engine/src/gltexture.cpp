@@ -1,7 +1,12 @@
 #include "gltexture.hpp"
+#include "asset_pack.hpp"
+#include "metrics_registry.hpp"
 #include "opengl_debug.hpp"
 #include "picopng.hxx"
+#include "texture_cache.hpp"
 #include <SDL.h>
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <iostream>
 #include <stdexcept>
@@ -11,6 +16,94 @@ namespace om
 static bool loadRawDataFromFile(const std::string_view  filePath,
                                 std::vector<std::byte>& rawDataFromFile);
 
+static constexpr size_t bytesPerPixel{ 4 };
+
+static void countUpload(size_t w, size_t h)
+{
+    static auto& uploadsCount =
+        MetricsRegistry::getCounter("render.texture_uploads");
+    static auto& uploadBytes =
+        MetricsRegistry::getCounter("render.texture_upload_bytes");
+    uploadsCount.add();
+    uploadBytes.add(w * h * bytesPerPixel);
+}
+
+size_t GlTexture::DecodedImage::getLevelW(size_t level) const
+{
+    return std::max<size_t>(w >> level, 1);
+}
+
+size_t GlTexture::DecodedImage::getLevelH(size_t level) const
+{
+    return std::max<size_t>(h >> level, 1);
+}
+
+size_t GlTexture::DecodedImage::getLevelOffset(size_t level) const
+{
+    size_t offset{};
+    for (size_t i = 0; i < level; ++i)
+    {
+        offset += getLevelW(i) * getLevelH(i) * bytesPerPixel;
+    }
+    return offset;
+}
+
+size_t GlTexture::DecodedImage::getFullChainLevelsCount() const
+{
+    size_t count{ 1 };
+    while ((w >> count) > 0 || (h >> count) > 0)
+    {
+        ++count;
+    }
+    return count;
+}
+
+/// Appends levels down to 1x1 to level 0, every texel is average of 2x2
+/// texels of previous level
+static void buildMipChain(GlTexture::DecodedImage& r_image)
+{
+    if (r_image.pixels.size() != r_image.w * r_image.h * bytesPerPixel)
+    {
+        // not RGBA, mipmaps are generated by OpenGl
+        return;
+    }
+    const auto levelsCount = r_image.getFullChainLevelsCount();
+    r_image.pixels.resize(r_image.getLevelOffset(levelsCount));
+    for (size_t level = 1; level < levelsCount; ++level)
+    {
+        const auto  srcW = r_image.getLevelW(level - 1);
+        const auto  srcH = r_image.getLevelH(level - 1);
+        const auto  dstW = r_image.getLevelW(level);
+        const auto  dstH = r_image.getLevelH(level);
+        const auto* src  = r_image.pixels.data() +
+                          r_image.getLevelOffset(level - 1);
+        auto* dst = r_image.pixels.data() + r_image.getLevelOffset(level);
+        for (size_t y = 0; y < dstH; ++y)
+        {
+            const size_t y0 = std::min(y * 2, srcH - 1);
+            const size_t y1 = std::min(y * 2 + 1, srcH - 1);
+            for (size_t x = 0; x < dstW; ++x)
+            {
+                const size_t x0 = std::min(x * 2, srcW - 1);
+                const size_t x1 = std::min(x * 2 + 1, srcW - 1);
+                for (size_t channel = 0; channel < bytesPerPixel; ++channel)
+                {
+                    const auto texel = [&](size_t srcX, size_t srcY) {
+                        return static_cast<unsigned>(
+                            src[(srcY * srcW + srcX) * bytesPerPixel +
+                                channel]);
+                    };
+                    const auto sum = texel(x0, y0) + texel(x1, y0) +
+                                     texel(x0, y1) + texel(x1, y1);
+                    dst[(y * dstW + x) * bytesPerPixel + channel] =
+                        static_cast<std::byte>((sum + 2) / 4);
+                }
+            }
+        }
+    }
+    r_image.levelsCount = levelsCount;
+}
+
 GlTexture::GlTexture(const std::string_view filePath)
 {
     if (!loadTexture(filePath))
@@ -36,6 +129,15 @@ GlTexture::GlTexture(const uint_least8_t* const pixels, const size_t w,
     }
 }
 
+GlTexture::GlTexture(DecodedImage image)
+{
+    if (!generateOpenGlTexture(std::move(image)))
+    {
+        std::cerr << "Error loading textrure from decoded image." << std::endl;
+        throw std::runtime_error("Error loading textrure.");
+    }
+}
+
 GlTexture::~GlTexture()
 {
     glDeleteTextures(1, &m_textureGlId);
@@ -47,7 +149,11 @@ GlTexture::GlTexture(GlTexture&& srcTexture)
     , m_textureGlType{ srcTexture.m_textureGlType }
     , m_w{ srcTexture.m_w }
     , m_h{ srcTexture.m_h }
+    , m_mipChain{ std::move(srcTexture.m_mipChain) }
+    , m_baseLevel{ srcTexture.m_baseLevel }
+    , m_requiredLevel{ srcTexture.m_requiredLevel }
 {
+    srcTexture.m_mipChain.reset();
     srcTexture.m_textureGlId   = 0;
     srcTexture.m_textureGlType = 0;
     srcTexture.m_h             = 0;
@@ -59,6 +165,10 @@ GlTexture& GlTexture::operator=(GlTexture&& srcTexture)
     m_textureGlType            = srcTexture.m_textureGlType;
     m_h                        = srcTexture.m_h;
     m_w                        = srcTexture.m_w;
+    m_mipChain                 = std::move(srcTexture.m_mipChain);
+    m_baseLevel                = srcTexture.m_baseLevel;
+    m_requiredLevel            = srcTexture.m_requiredLevel;
+    srcTexture.m_mipChain.reset();
     srcTexture.m_textureGlId   = 0;
     srcTexture.m_textureGlType = 0;
     srcTexture.m_h             = 0;
@@ -85,16 +195,140 @@ bool GlTexture::use()
 
 bool GlTexture::loadTexture(const std::string_view filePath)
 {
-    std::vector<std::byte> rawDataFromFile;
-    if (!loadRawDataFromFile(filePath, rawDataFromFile))
+    DecodedImage image;
+    if (!decodeFile(filePath, image))
+    {
+        return false;
+    }
+    return generateOpenGlTexture(std::move(image));
+}
+
+void GlTexture::requestDetail(
+    const std::array<myGlfloat, 4>& texCoordDerivatives)
+{
+    if (!m_mipChain)
+    {
+        return;
+    }
+    // the same level of detail as OpenGl calculates for minification
+    const auto texelsPerPixel = std::max(
+        std::hypot(texCoordDerivatives[0] * static_cast<myGlfloat>(m_w),
+                   texCoordDerivatives[1] * static_cast<myGlfloat>(m_h)),
+        std::hypot(texCoordDerivatives[2] * static_cast<myGlfloat>(m_w),
+                   texCoordDerivatives[3] * static_cast<myGlfloat>(m_h)));
+    const auto level =
+        texelsPerPixel > 1
+            ? static_cast<size_t>(std::floor(std::log2(texelsPerPixel)))
+            : size_t{};
+    m_requiredLevel = std::min(m_requiredLevel, level);
+}
+
+bool GlTexture::streamNextLevel()
+{
+    if (!isStreamingNeeded() || !m_mipChain)
+    {
+        return false;
+    }
+    glBindTexture(m_textureGlType, m_textureGlId);
+    if (!isGlResultOk() || !uploadLevel(m_baseLevel - 1))
     {
         return false;
     }
-    std::vector<std::byte> decodedPng;
+    --m_baseLevel;
+    glTexParameteri(m_textureGlType, GL_TEXTURE_BASE_LEVEL,
+                    static_cast<GLint>(m_baseLevel));
+    if (m_baseLevel == 0)
+    {
+        m_mipChain.reset();
+    }
+    return isGlResultOk();
+}
+
+size_t GlTexture::getMemorySize() const
+{
+    // every texture has full mip chain, levels finer than base one aren't
+    // uploaded yet
+    DecodedImage chain;
+    chain.w = m_w;
+    chain.h = m_h;
+    return chain.getLevelOffset(chain.getFullChainLevelsCount()) -
+           chain.getLevelOffset(m_baseLevel);
+}
+
+bool GlTexture::uploadLevel(size_t level)
+{
+    const auto& image = *m_mipChain;
+    glTexImage2D(m_textureGlType, static_cast<GLint>(level), GL_RGBA,
+                 static_cast<GLsizei>(image.getLevelW(level)),
+                 static_cast<GLsizei>(image.getLevelH(level)), 0, GL_RGBA,
+                 GL_UNSIGNED_BYTE, image.data() + image.getLevelOffset(level));
+    countUpload(image.getLevelW(level), image.getLevelH(level));
+    return isGlResultOk();
+}
+
+bool GlTexture::generateOpenGlTexture(DecodedImage image)
+{
+    m_w = image.w;
+    m_h = image.h;
+    if (image.levelsCount == 1)
+    {
+        return generateOpenGlTexture(
+            reinterpret_cast<const uint_least8_t*>(image.data()), m_w, m_h,
+            m_textureGlType, m_textureGlId);
+    }
+
+    m_mipChain.emplace(std::move(image));
+    const auto lastLevel = m_mipChain->levelsCount - 1;
+    m_baseLevel          = 0;
+    while (m_baseLevel < lastLevel &&
+           std::max(m_mipChain->getLevelW(m_baseLevel),
+                    m_mipChain->getLevelH(m_baseLevel)) > initialResidentSize)
+    {
+        ++m_baseLevel;
+    }
+    m_requiredLevel = m_baseLevel;
+
+    glGenTextures(1, &m_textureGlId);
+    m_textureGlType = hardcodedTextureType;
+    glBindTexture(m_textureGlType, m_textureGlId);
+    bool isUploadOk = isGlResultOk();
+    // coarse levels first, so texture is complete with any base level
+    for (size_t level = lastLevel + 1; level-- > m_baseLevel;)
+    {
+        isUploadOk = isUploadOk && uploadLevel(level);
+    }
+    glTexParameteri(m_textureGlType, GL_TEXTURE_BASE_LEVEL,
+                    static_cast<GLint>(m_baseLevel));
+    glTexParameteri(m_textureGlType, GL_TEXTURE_MAX_LEVEL,
+                    static_cast<GLint>(lastLevel));
+    glTexParameteri(m_textureGlType, GL_TEXTURE_MIN_FILTER,
+                    GL_LINEAR_MIPMAP_NEAREST);
+    glTexParameteri(m_textureGlType, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(m_textureGlType, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(m_textureGlType, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    isUploadOk = isUploadOk && isGlResultOk();
+
+    if (m_baseLevel == 0)
+    {
+        m_mipChain.reset();
+    }
+    if (!isUploadOk)
+    {
+        std::cerr << "Error generating openGl texture." << std::endl;
+    }
+    return isUploadOk;
+}
 
-    auto errorDecodingPng =
-        decodePNG(decodedPng, m_w, m_h, rawDataFromFile.data(),
-                  rawDataFromFile.size(), false);
+/// Decodes png and stores it to texture cache
+static bool decodeAndCachePng(
+    const std::string_view                           name,
+    ArrayView<std::byte>                             png,
+    GlTexture::DecodedImage&                         r_image,
+    const std::optional<TextureCache::PackedSource>& packedSource =
+        std::nullopt)
+{
+    auto errorDecodingPng = decodePNG(r_image.pixels, r_image.w, r_image.h,
+                                      png.data(), png.size(), false);
 
     if (errorDecodingPng != 0)
     {
@@ -102,16 +336,54 @@ bool GlTexture::loadTexture(const std::string_view filePath)
                   << " has occured." << std::endl;
         return false;
     }
-    const auto decodedDataPtr =
-        reinterpret_cast<const uint_least8_t*>(decodedPng.data());
+    buildMipChain(r_image);
+    TextureCache::store(name, png, r_image, packedSource);
+    return true;
+}
 
-    if (!generateOpenGlTexture(decodedDataPtr, m_w, m_h, m_textureGlType,
-                               m_textureGlId))
+bool GlTexture::decodeFile(const std::string_view filePath,
+                           DecodedImage&          r_image)
+{
+    // packed png is decoded right from mapped pack, file isn't touched
+    const auto& pack      = AssetPack::getAssetPack();
+    const auto  packedPng = pack.find(filePath);
+    if (!packedPng.empty() && pack.getModificationTime() == 0)
+    {
+        return decodePng(filePath, packedPng, r_image);
+    }
+    if (!packedPng.empty())
+    {
+        const TextureCache::PackedSource packedSource{
+            pack.getModificationTime(), pack.getOffset(packedPng)
+        };
+        if (TextureCache::loadIfUnchanged(filePath, packedPng, packedSource,
+                                          r_image))
+        {
+            return true;
+        }
+        return decodeAndCachePng(filePath, packedPng, r_image, packedSource);
+    }
+    if (TextureCache::loadIfUnchanged(filePath, r_image))
+    {
+        return true;
+    }
+    std::vector<std::byte> rawDataFromFile;
+    if (!loadRawDataFromFile(filePath, rawDataFromFile))
     {
         return false;
     }
+    return decodePng(filePath, rawDataFromFile, r_image);
+}
 
-    return true;
+bool GlTexture::decodePng(const std::string_view name,
+                          ArrayView<std::byte>   png,
+                          DecodedImage&          r_image)
+{
+    if (TextureCache::loadIfSameContent(name, png, r_image))
+    {
+        return true;
+    }
+    return decodeAndCachePng(name, png, r_image);
 }
 
 bool GlTexture::generateOpenGlTexture(
@@ -135,6 +407,7 @@ bool GlTexture::generateOpenGlTexture(
                  border, targetFormat, pixelParameterDataType,
                  textureDecodedData);
     const bool isTexImageOk = isGlResultOk();
+    countUpload(wTexture, hTexture);
     // Generating mipmap
     glGenerateMipmap(r_textureType);
     const bool isGenMipmapOk = isGlResultOk();
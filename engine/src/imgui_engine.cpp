@@ -1,5 +1,7 @@
 #include "imgui_engine.hpp"
+#include "frame_arena.hpp"
 #include "matrix.hpp"
+#include "trace.hpp"
 
 #include <SDL.h>
 #ifdef _WIN32
@@ -75,6 +77,13 @@ bool ImguiEngine::initialize(SDL_Window* const  window,
     io.GetClipboardTextFn = getClipboardText;
     io.ClipboardUserData  = nullptr;
 
+    m_Time = clock_t::now();
+    // without window (null engine) there are no cursors and mouse
+    if (window == nullptr)
+    {
+        return true;
+    }
+
     m_MouseCursors.resize(ImGuiMouseCursor_COUNT);
     // Load mouse cursors
     m_MouseCursors[ImGuiMouseCursor_Arrow] =
@@ -106,12 +115,12 @@ bool ImguiEngine::initialize(SDL_Window* const  window,
     SDL_GetWindowWMInfo(window, &wmInfo);
     io.ImeWindowHandle = wmInfo.info.win.window;
 #endif
-    m_Time = clock_t::now();
     return true;
 }
 
 void ImguiEngine::renderCallback(ImDrawData* draw_data)
 {
+    OM_TRACE_SCOPE("ImguiEngine::renderCallback");
     // Avoid rendering when minimized, scale coordinates for retina displays
     // (screen coordinates != framebuffer coordinates)
     ImGuiIO& io        = ImGui::GetIO();
@@ -164,7 +173,7 @@ void ImguiEngine::renderCallback(ImDrawData* draw_data)
         // ImGui
         size_t vert_count = static_cast<size_t>(cmd_list->VtxBuffer.size());
 
-        std::vector<om::VertexTextured> omVertexes;
+        om::FrameVector<om::VertexTextured> omVertexes;
         omVertexes.reserve(vert_count);
 
         auto imguiVertexToOmVertex = [](const ImDrawVert& imguiVertex) {
@@ -194,7 +203,7 @@ void ImguiEngine::renderCallback(ImDrawData* draw_data)
             const auto beginIndexBuffer =
                 cmd_list->IdxBuffer.begin() + idx_buffer_offset;
             const auto endIndexBuffer = beginIndexBuffer + pcmd->ElemCount;
-            std::vector<om::myUint> omIndices;
+            om::FrameVector<om::myUint> omIndices;
             omIndices.reserve(pcmd->ElemCount);
             std::transform(beginIndexBuffer, endIndexBuffer,
                            std::back_inserter(omIndices), imguiIndexToOmIndex);
@@ -282,6 +291,12 @@ void ImguiEngine::newFrame()
         createDeviceObjects();
     }
 
+    if (m_Window == nullptr)
+    {
+        newFrameWithoutWindow();
+        return;
+    }
+
     // Setup display size (every frame to accommodate for window resizing)
     int w, h;
     // int display_w, display_h;
@@ -325,6 +340,21 @@ void ImguiEngine::newFrame()
     ImGui::NewFrame();
 }
 
+void ImguiEngine::newFrameWithoutWindow()
+{
+    ImGuiIO&   io           = ImGui::GetIO();
+    const auto drawableSize = m_engine->getDrawablePixelSize();
+    io.DisplaySize = ImVec2(float(drawableSize[0]), float(drawableSize[1]));
+    io.DisplayFramebufferScale = ImVec2(1.f, 1.f);
+
+    auto time      = clock_t::now();
+    auto deltaTime = std::chrono::duration_cast<seconds_t>(time - m_Time);
+    io.DeltaTime   = deltaTime.count() > 0 ? deltaTime.count() : 1.0f / 60.0f;
+    m_Time         = time;
+
+    ImGui::NewFrame();
+}
+
 void ImguiEngine::updateMousePosAndButtons()
 {
     ImGuiIO& io = ImGui::GetIO();
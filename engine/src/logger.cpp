@@ -0,0 +1,240 @@
+#include "logger.hpp"
+#include "metrics_registry.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace om
+{
+
+static constexpr std::array<std::string_view,
+                            static_cast<size_t>(Logger::Category::count)>
+    categoryNames{ "general", "engine", "render", "audio", "world", "input" };
+static constexpr std::array<std::string_view, 5> levelNames{
+    "debug", "info", "warning", "error", "off"
+};
+
+/// Slot is free for writer of position equal to sequence and is ready for
+/// reader when sequence is position + 1, as in bounded queue of D. Vyukov
+struct LogSlot
+{
+    std::atomic<size_t>                   sequence{};
+    Logger::Category                      category{};
+    Logger::Level                         level{};
+    size_t                                length{};
+    std::array<char, Logger::messageSize> text;
+};
+
+class LogWriter
+{
+public:
+    LogWriter()
+        : m_slots{ std::make_unique<LogSlot[]>(Logger::ringSlotsCount) }
+    {
+        for (size_t i = 0; i < Logger::ringSlotsCount; ++i)
+        {
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        m_output.reserve(Logger::ringSlotsCount * 64);
+        m_thread = std::thread{ [this]() { run(); } };
+    }
+    ~LogWriter()
+    {
+        m_isRunning.store(false, std::memory_order_release);
+        m_thread.join();
+        writePending();
+    }
+
+    void push(Logger::Category category, Logger::Level level,
+              std::string_view text)
+    {
+        auto position = m_pushPosition.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            auto&      slot     = m_slots[position % Logger::ringSlotsCount];
+            const auto sequence = slot.sequence.load(std::memory_order_acquire);
+            if (sequence == position)
+            {
+                if (m_pushPosition.compare_exchange_weak(
+                        position, position + 1, std::memory_order_relaxed))
+                {
+                    slot.category = category;
+                    slot.level    = level;
+                    slot.length   = std::min(text.size(), slot.text.size());
+                    std::copy_n(text.data(), slot.length, slot.text.data());
+                    slot.sequence.store(position + 1,
+                                        std::memory_order_release);
+                    return;
+                }
+            }
+            else if (sequence < position)
+            {
+                // previous lap of ring isn't written yet
+                m_droppedCount.add();
+                return;
+            }
+            else
+            {
+                position = m_pushPosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void flush()
+    {
+        const auto position = m_pushPosition.load(std::memory_order_acquire);
+        while (m_writtenPosition.load(std::memory_order_acquire) < position &&
+               m_isRunning.load(std::memory_order_acquire))
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+        }
+    }
+
+    std::uint64_t getDroppedCount() const { return m_droppedCount.get(); }
+
+private:
+    static constexpr std::chrono::milliseconds writePeriod{ 5 };
+
+    void run()
+    {
+        while (m_isRunning.load(std::memory_order_acquire))
+        {
+            if (!writePending())
+            {
+                std::this_thread::sleep_for(writePeriod);
+            }
+        }
+    }
+
+    /// Writes all ready messages by one call of unbuffered std::clog
+    bool writePending()
+    {
+        auto position = m_writtenPosition.load(std::memory_order_relaxed);
+        m_output.clear();
+        for (;;)
+        {
+            auto& slot = m_slots[position % Logger::ringSlotsCount];
+            if (slot.sequence.load(std::memory_order_acquire) != position + 1)
+            {
+                break;
+            }
+            if (slot.level >= Logger::Level::warning)
+            {
+                m_output += levelNames[static_cast<size_t>(slot.level)];
+                m_output += ": ";
+            }
+            m_output.append(slot.text.data(), slot.length);
+            m_output += '\n';
+            slot.sequence.store(position + Logger::ringSlotsCount,
+                                std::memory_order_release);
+            ++position;
+        }
+        if (m_output.empty())
+        {
+            return false;
+        }
+        std::clog.write(m_output.data(),
+                        static_cast<std::streamsize>(m_output.size()));
+        std::clog.flush();
+        m_writtenPosition.store(position, std::memory_order_release);
+        return true;
+    }
+
+    std::unique_ptr<LogSlot[]> m_slots;
+    std::atomic<size_t>        m_pushPosition{};
+    std::atomic<size_t>        m_writtenPosition{};
+    std::atomic<bool>          m_isRunning{ true };
+    MetricsRegistry::Counter&  m_droppedCount{
+        MetricsRegistry::getCounter("log.dropped_messages")
+    };
+    std::string                m_output;
+    std::thread                m_thread;
+};
+
+static LogWriter& getWriter()
+{
+    // thread is started by the first message and joined at exit
+    static LogWriter writer;
+    return writer;
+}
+
+template <typename T, size_t N>
+static bool findByName(const std::array<std::string_view, N>& names,
+                       std::string_view name, T& value)
+{
+    const auto nameIt = std::find(names.begin(), names.end(), name);
+    if (nameIt == names.end())
+    {
+        return false;
+    }
+    value = static_cast<T>(nameIt - names.begin());
+    return true;
+}
+
+void Logger::setLevel(Category category, Level level)
+{
+    levels[static_cast<size_t>(category)].store(level,
+                                                std::memory_order_relaxed);
+}
+
+bool Logger::setFilter(std::string_view filter)
+{
+    while (!filter.empty())
+    {
+        const auto end   = std::min(filter.find(','), filter.size());
+        const auto entry = filter.substr(0, end);
+        filter.remove_prefix(std::min(end + 1, filter.size()));
+
+        const auto separator = entry.find('=');
+        Level      level{};
+        if (separator == std::string_view::npos ||
+            !findByName(levelNames, entry.substr(separator + 1), level))
+        {
+            std::cerr << "Wrong log filter: " << entry << std::endl;
+            return false;
+        }
+        const auto categoryName = entry.substr(0, separator);
+        Category   category{};
+        if (categoryName == "all")
+        {
+            for (size_t i = 0; i < levels.size(); ++i)
+            {
+                setLevel(static_cast<Category>(i), level);
+            }
+        }
+        else if (findByName(categoryNames, categoryName, category))
+        {
+            setLevel(category, level);
+        }
+        else
+        {
+            std::cerr << "Unknown log category: " << categoryName
+                      << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+void Logger::write(Category category, Level level, std::string_view text)
+{
+    if (isEnabled(category, level))
+    {
+        getWriter().push(category, level, text);
+    }
+}
+
+void Logger::flush()
+{
+    getWriter().flush();
+}
+
+std::uint64_t Logger::getDroppedCount()
+{
+    return getWriter().getDroppedCount();
+}
+
+} // namespace om
@@ -0,0 +1,68 @@
+#include "mapped_file.hpp"
+
+#ifdef _WIN32
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace om
+{
+
+std::optional<MappedFile> mapFile(const std::string& path)
+{
+#ifdef _WIN32
+    std::ifstream file{ path, std::ios::binary };
+    if (!file)
+    {
+        return std::nullopt;
+    }
+    const std::vector<char> content{ std::istreambuf_iterator<char>{ file },
+                                     std::istreambuf_iterator<char>{} };
+    if (content.empty())
+    {
+        return std::nullopt;
+    }
+    const std::shared_ptr<std::byte> data{ new std::byte[content.size()],
+                                           std::default_delete<std::byte[]>{} };
+    std::memcpy(data.get(), content.data(), content.size());
+    return MappedFile{ data, content.size() };
+#else
+    const int fileDescriptor = open(path.c_str(), O_RDONLY);
+    if (fileDescriptor < 0)
+    {
+        return std::nullopt;
+    }
+    struct stat fileStat
+    {
+    };
+    if (fstat(fileDescriptor, &fileStat) != 0 || fileStat.st_size <= 0)
+    {
+        close(fileDescriptor);
+        return std::nullopt;
+    }
+    const auto size    = static_cast<size_t>(fileStat.st_size);
+    void*      address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE,
+                              fileDescriptor, 0);
+    // mapping stays valid after file is closed
+    close(fileDescriptor);
+    if (address == MAP_FAILED)
+    {
+        return std::nullopt;
+    }
+    return MappedFile{ std::shared_ptr<const std::byte>{
+                           static_cast<const std::byte*>(address),
+                           [size](const std::byte* mapped) {
+                               munmap(const_cast<std::byte*>(mapped), size);
+                           } },
+                       size };
+#endif
+}
+
+} // namespace om
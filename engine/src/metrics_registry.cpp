@@ -0,0 +1,267 @@
+#include "metrics_registry.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace om
+{
+
+struct MetricsStorage
+{
+    std::mutex mutex;
+    std::map<std::string, std::unique_ptr<MetricsRegistry::Counter>,
+             std::less<>>
+        counters;
+    std::map<std::string, std::unique_ptr<MetricsRegistry::Gauge>, std::less<>>
+        gauges;
+    std::map<std::string, std::unique_ptr<MetricsRegistry::Histogram>,
+             std::less<>>
+        histograms;
+};
+
+static MetricsStorage& getStorage()
+{
+    // metrics may be requested during initialization of other statics
+    static MetricsStorage storage;
+    return storage;
+}
+
+template <typename T>
+static T& findOrAdd(
+    std::map<std::string, std::unique_ptr<T>, std::less<>>& metrics,
+    std::string_view                                        name)
+{
+    std::lock_guard lock{ getStorage().mutex };
+    auto            metricIt = metrics.find(name);
+    if (metricIt == metrics.end())
+    {
+        metricIt =
+            metrics.emplace(std::string{ name }, std::make_unique<T>()).first;
+    }
+    return *metricIt->second;
+}
+
+size_t MetricsRegistry::Histogram::getBucketIndex(std::uint64_t value)
+{
+    // values below 2 * subBucketsCount have own buckets, every next power of
+    // two range has subBucketsCount buckets of twice wider size
+    size_t exponent{};
+    for (auto high = value >> (subBucketsBits + 1); high != 0; high >>= 1)
+    {
+        ++exponent;
+    }
+    return exponent * subBucketsCount + static_cast<size_t>(value >> exponent);
+}
+
+std::uint64_t MetricsRegistry::Histogram::getBucketHighestValue(size_t index)
+{
+    if (index < 2 * subBucketsCount)
+    {
+        return index;
+    }
+    const auto exponent  = index / subBucketsCount - 1;
+    const auto subBucket = index - exponent * subBucketsCount;
+    return ((std::uint64_t{ subBucket } + 1) << exponent) - 1;
+}
+
+void MetricsRegistry::Histogram::record(std::uint64_t value)
+{
+    value = std::min(value, maxValue);
+    m_buckets[getBucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+    auto max = m_max.load(std::memory_order_relaxed);
+    while (value > max &&
+           !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+double MetricsRegistry::Histogram::getMean() const
+{
+    const auto count = getCount();
+    return count == 0 ? 0.
+                      : static_cast<double>(
+                            m_sum.load(std::memory_order_relaxed)) /
+                            static_cast<double>(count);
+}
+
+std::uint64_t MetricsRegistry::Histogram::getQuantile(double quantile) const
+{
+    const auto count = getCount();
+    if (count == 0)
+    {
+        return 0;
+    }
+    const auto rank = std::max<std::uint64_t>(
+        1, static_cast<std::uint64_t>(
+               std::ceil(std::clamp(quantile, 0., 1.) * count)));
+    std::uint64_t passed{};
+    for (size_t i = 0; i < bucketsCount; ++i)
+    {
+        passed += m_buckets[i].load(std::memory_order_relaxed);
+        if (passed >= rank)
+        {
+            return std::min(getBucketHighestValue(i), getMax());
+        }
+    }
+    // buckets are updated concurrently with count
+    return getMax();
+}
+
+MetricsRegistry::Counter& MetricsRegistry::getCounter(std::string_view name)
+{
+    return findOrAdd(getStorage().counters, name);
+}
+
+MetricsRegistry::Gauge& MetricsRegistry::getGauge(std::string_view name)
+{
+    return findOrAdd(getStorage().gauges, name);
+}
+
+MetricsRegistry::Histogram& MetricsRegistry::getHistogram(
+    std::string_view name)
+{
+    return findOrAdd(getStorage().histograms, name);
+}
+
+void MetricsRegistry::finishFrame()
+{
+    auto&           storage = getStorage();
+    std::lock_guard lock{ storage.mutex };
+    for (auto& [name, counter] : storage.counters)
+    {
+        const auto value           = counter->get();
+        counter->m_lastFrameValue  = value - counter->m_frameStartValue;
+        counter->m_frameStartValue = value;
+    }
+}
+
+std::vector<MetricsRegistry::Entry> MetricsRegistry::getSnapshot()
+{
+    auto&              storage = getStorage();
+    std::lock_guard    lock{ storage.mutex };
+    std::vector<Entry> entries;
+    entries.reserve(storage.counters.size() + storage.gauges.size() +
+                    storage.histograms.size());
+    for (const auto& [name, counter] : storage.counters)
+    {
+        Entry entry;
+        entry.name           = name;
+        entry.type           = Entry::Type::counter;
+        entry.value          = static_cast<double>(counter->get());
+        entry.lastFrameValue = counter->m_lastFrameValue;
+        entries.push_back(std::move(entry));
+    }
+    for (const auto& [name, gauge] : storage.gauges)
+    {
+        Entry entry;
+        entry.name  = name;
+        entry.type  = Entry::Type::gauge;
+        entry.value = gauge->get();
+        entries.push_back(std::move(entry));
+    }
+    for (const auto& [name, histogram] : storage.histograms)
+    {
+        Entry entry;
+        entry.name  = name;
+        entry.type  = Entry::Type::histogram;
+        entry.count = histogram->getCount();
+        entry.mean  = histogram->getMean();
+        entry.value = entry.mean;
+        entry.p50   = histogram->getQuantile(0.5);
+        entry.p90   = histogram->getQuantile(0.9);
+        entry.p99   = histogram->getQuantile(0.99);
+        entry.max   = histogram->getMax();
+        entries.push_back(std::move(entry));
+    }
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry& first, const Entry& second) {
+                  return first.name < second.name;
+              });
+    return entries;
+}
+
+static std::string_view getTypeName(MetricsRegistry::Entry::Type type)
+{
+    switch (type)
+    {
+        case MetricsRegistry::Entry::Type::counter:
+            return "counter";
+        case MetricsRegistry::Entry::Type::gauge:
+            return "gauge";
+        case MetricsRegistry::Entry::Type::histogram:
+            return "histogram";
+    }
+    return "";
+}
+
+static void writeCsv(std::ostream&                              out,
+                     const std::vector<MetricsRegistry::Entry>& entries)
+{
+    out << "name,type,value,last_frame,count,mean,p50,p90,p99,max\n";
+    for (const auto& entry : entries)
+    {
+        out << entry.name << ',' << getTypeName(entry.type) << ','
+            << entry.value << ',' << entry.lastFrameValue << ','
+            << entry.count << ',' << entry.mean << ',' << entry.p50 << ','
+            << entry.p90 << ',' << entry.p99 << ',' << entry.max << '\n';
+    }
+}
+
+static void writeJson(std::ostream&                              out,
+                      const std::vector<MetricsRegistry::Entry>& entries)
+{
+    // names are set by code, they don't need escaping
+    out << "[\n";
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        const auto& entry = entries[i];
+        out << "  { \"name\": \"" << entry.name << "\", \"type\": \""
+            << getTypeName(entry.type) << "\", \"value\": " << entry.value;
+        if (entry.type == MetricsRegistry::Entry::Type::counter)
+        {
+            out << ", \"last_frame\": " << entry.lastFrameValue;
+        }
+        else if (entry.type == MetricsRegistry::Entry::Type::histogram)
+        {
+            out << ", \"count\": " << entry.count
+                << ", \"mean\": " << entry.mean << ", \"p50\": " << entry.p50
+                << ", \"p90\": " << entry.p90 << ", \"p99\": " << entry.p99
+                << ", \"max\": " << entry.max;
+        }
+        out << (i + 1 < entries.size() ? " },\n" : " }\n");
+    }
+    out << "]\n";
+}
+
+bool MetricsRegistry::writeToFile(std::string_view filePath)
+{
+    std::ofstream out{ std::string{ filePath } };
+    if (!out)
+    {
+        std::cerr << "Can't open metrics file " << filePath << std::endl;
+        return false;
+    }
+    constexpr std::string_view jsonExtension{ ".json" };
+    const auto                 isJson =
+        filePath.size() >= jsonExtension.size() &&
+        filePath.substr(filePath.size() - jsonExtension.size()) ==
+            jsonExtension;
+    const auto entries = getSnapshot();
+    if (isJson)
+    {
+        writeJson(out, entries);
+    }
+    else
+    {
+        writeCsv(out, entries);
+    }
+    return static_cast<bool>(out);
+}
+
+} // namespace om
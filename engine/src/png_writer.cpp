@@ -0,0 +1,137 @@
+#include "png_writer.hpp"
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace om
+{
+
+static constexpr size_t pngBytesPerPixel{ 4 };
+/// Maximum size of stored deflate block
+static constexpr size_t maxStoredBlockSize{ 65535 };
+
+static std::uint32_t calcCrc(const std::uint8_t* data, size_t size,
+                             std::uint32_t crc = 0)
+{
+    static const auto table = []() {
+        std::array<std::uint32_t, 256> result{};
+        for (std::uint32_t i = 0; i < result.size(); ++i)
+        {
+            auto value = i;
+            for (int bit = 0; bit < 8; ++bit)
+            {
+                value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+            }
+            result[i] = value;
+        }
+        return result;
+    }();
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i)
+    {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+static std::uint32_t calcAdler(const std::vector<std::uint8_t>& data)
+{
+    std::uint32_t a{ 1 };
+    std::uint32_t b{};
+    for (const auto byte : data)
+    {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    return (b << 16) | a;
+}
+
+static void appendBigEndian(std::vector<std::uint8_t>& r_data,
+                            std::uint32_t               value)
+{
+    for (int shift = 24; shift >= 0; shift -= 8)
+    {
+        r_data.push_back(static_cast<std::uint8_t>(value >> shift));
+    }
+}
+
+static void writeChunk(std::ofstream& file, const char* type,
+                       const std::vector<std::uint8_t>& data)
+{
+    std::vector<std::uint8_t> chunk;
+    chunk.reserve(data.size() + 12);
+    appendBigEndian(chunk, static_cast<std::uint32_t>(data.size()));
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    // crc is calculated for type and data
+    appendBigEndian(chunk, calcCrc(chunk.data() + 4, chunk.size() - 4));
+    file.write(reinterpret_cast<const char*>(chunk.data()),
+               static_cast<std::streamsize>(chunk.size()));
+}
+
+bool writePng(const std::string_view filePath, const std::uint8_t* pixels,
+              size_t w, size_t h)
+{
+    std::ofstream file{ std::string{ filePath },
+                        std::ios::binary | std::ios::trunc };
+    if (!file)
+    {
+        std::cerr << "Can't open png file " << filePath << std::endl;
+        return false;
+    }
+    constexpr std::array<std::uint8_t, 8> signature{ 0x89, 'P',  'N',  'G',
+                                                     '\r', '\n', 0x1A, '\n' };
+    file.write(reinterpret_cast<const char*>(signature.data()),
+               signature.size());
+
+    std::vector<std::uint8_t> header;
+    appendBigEndian(header, static_cast<std::uint32_t>(w));
+    appendBigEndian(header, static_cast<std::uint32_t>(h));
+    // 8 bit, RGBA, deflate, adaptive filtering, no interlace
+    header.insert(header.end(), { 8, 6, 0, 0, 0 });
+    writeChunk(file, "IHDR", header);
+
+    // every row starts with filter type, 0 - none
+    const auto                rowSize = w * pngBytesPerPixel;
+    std::vector<std::uint8_t> rows;
+    rows.reserve((rowSize + 1) * h);
+    for (size_t y = 0; y < h; ++y)
+    {
+        rows.push_back(0);
+        rows.insert(rows.end(), pixels + y * rowSize,
+                    pixels + (y + 1) * rowSize);
+    }
+
+    std::vector<std::uint8_t> zlibStream{ 0x78, 0x01 };
+    zlibStream.reserve(rows.size() +
+                       rows.size() / maxStoredBlockSize * 5 + 16);
+    size_t offset{};
+    do
+    {
+        const auto size   = std::min(maxStoredBlockSize, rows.size() - offset);
+        const bool isLast = offset + size == rows.size();
+        zlibStream.push_back(isLast ? 1 : 0);
+        zlibStream.push_back(static_cast<std::uint8_t>(size & 0xFF));
+        zlibStream.push_back(static_cast<std::uint8_t>(size >> 8));
+        zlibStream.push_back(static_cast<std::uint8_t>(~size & 0xFF));
+        zlibStream.push_back(static_cast<std::uint8_t>((~size >> 8) & 0xFF));
+        zlibStream.insert(zlibStream.end(), rows.begin() + offset,
+                          rows.begin() + offset + size);
+        offset += size;
+    } while (offset < rows.size());
+    appendBigEndian(zlibStream, calcAdler(rows));
+    writeChunk(file, "IDAT", zlibStream);
+    writeChunk(file, "IEND", {});
+
+    if (!file)
+    {
+        std::cerr << "Can't write png file " << filePath << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace om
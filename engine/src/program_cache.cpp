@@ -0,0 +1,135 @@
+#include "program_cache.hpp"
+#include "file_utils.hpp"
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace om
+{
+
+struct ProgramCacheHeader
+{
+    std::array<char, 8> magic{};
+    std::uint64_t       key{};
+    std::uint64_t       format{};
+    std::uint64_t       size{};
+};
+
+static constexpr std::array<char, 8> programCacheMagic{ 'O', 'M', 'P', 'R',
+                                                        'O', 'G', '0', '1' };
+
+static std::string programCacheDirectory;
+static std::string driverDescription;
+
+/// Parts are separated, so "ab" + "c" differs from "a" + "bc"
+static std::uint64_t calcHash(const std::vector<std::string_view>& parts)
+{
+    auto hash = fnv1aBasis;
+    for (const auto part : parts)
+    {
+        hash = calcFnv1a({ reinterpret_cast<const std::byte*>(part.data()),
+                           part.size() },
+                         hash);
+        hash = calcFnv1a({ std::byte{} }, hash);
+    }
+    return hash;
+}
+
+static std::string getCachePath(std::uint64_t key)
+{
+    std::ostringstream path;
+    path << programCacheDirectory << std::hex << std::setw(16)
+         << std::setfill('0') << key << ".bin";
+    return path.str();
+}
+
+void ProgramCache::setDirectory(std::string directory)
+{
+    if (!directory.empty() && directory.back() != '/' &&
+        directory.back() != '\\')
+    {
+        directory += '/';
+    }
+    programCacheDirectory = std::move(directory);
+}
+
+void ProgramCache::setDriver(std::string driver)
+{
+    driverDescription = std::move(driver);
+}
+
+bool ProgramCache::isEnabled()
+{
+    return !programCacheDirectory.empty() && !driverDescription.empty();
+}
+
+std::uint64_t ProgramCache::calcKey(const std::vector<std::string_view>& parts)
+{
+    auto partsWithDriver = parts;
+    partsWithDriver.push_back(driverDescription);
+    return calcHash(partsWithDriver);
+}
+
+bool ProgramCache::load(std::uint64_t key, Binary& r_binary)
+{
+    if (!isEnabled())
+    {
+        return false;
+    }
+    std::ifstream file{ getCachePath(key), std::ios::binary | std::ios::ate };
+    if (!file)
+    {
+        return false;
+    }
+    const auto fileSize = static_cast<std::uint64_t>(file.tellg());
+    file.seekg(0);
+    ProgramCacheHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    // size is checked before allocation, truncated or corrupted cache is
+    // compiled again instead of throwing
+    if (!file || header.magic != programCacheMagic || header.key != key ||
+        header.size != fileSize - sizeof(header))
+    {
+        return false;
+    }
+    r_binary.format = static_cast<GLenum>(header.format);
+    r_binary.data.resize(header.size);
+    file.read(reinterpret_cast<char*>(r_binary.data.data()),
+              static_cast<std::streamsize>(header.size));
+    return static_cast<bool>(file);
+}
+
+void ProgramCache::store(std::uint64_t key, const Binary& binary)
+{
+    if (!isEnabled())
+    {
+        return;
+    }
+    namespace fs = std::filesystem;
+    std::error_code error;
+    fs::create_directories(programCacheDirectory, error);
+
+    ProgramCacheHeader header;
+    header.magic  = programCacheMagic;
+    header.key    = key;
+    header.format = binary.format;
+    header.size   = binary.data.size();
+
+    AtomicFileWriter writer{ getCachePath(key) };
+    auto&            file = writer.getStream();
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(binary.data.data()),
+               static_cast<std::streamsize>(binary.data.size()));
+    writer.commit();
+}
+
+void ProgramCache::erase(std::uint64_t key)
+{
+    std::error_code error;
+    std::filesystem::remove(getCachePath(key), error);
+}
+
+} // namespace om
@@ -0,0 +1,224 @@
+#include "resource_manager.hpp"
+#include "logger.hpp"
+#include <algorithm>
+#include <iostream>
+
+namespace om
+{
+
+ResourceManager::ResourceManager(IEngine& engine, Config config)
+    : m_engine{ engine }
+    , m_config{ config }
+    , m_gpuBytesMetric{ MetricsRegistry::getGauge("resources.gpu_bytes") }
+    , m_cpuBytesMetric{ MetricsRegistry::getGauge("resources.cpu_bytes") }
+    , m_loadsCount{ MetricsRegistry::getCounter("resources.loads") }
+    , m_evictionsCount{ MetricsRegistry::getCounter("resources.evictions") }
+{
+}
+
+ResourceManager::Handle ResourceManager::acquireTexture(std::string_view name)
+{
+    return acquire(name, AssetType::texture);
+}
+
+ResourceManager::Handle ResourceManager::acquireSoundTrack(
+    std::string_view name)
+{
+    return acquire(name, AssetType::soundTrack);
+}
+
+ResourceManager::Handle ResourceManager::acquire(std::string_view name,
+                                                 AssetType        type)
+{
+    const auto assetIt = m_assets.try_emplace(std::string{ name }).first;
+    auto&      asset   = assetIt->second;
+    if (asset.referencesCount == 0 && !asset.isLoaded)
+    {
+        asset.type = type;
+        asset.name = assetIt->first;
+    }
+    else if (asset.type != type)
+    {
+        std::cerr << "Asset " << name << " is acquired as different type"
+                  << std::endl;
+        return Handle{};
+    }
+    return Handle{ asset };
+}
+
+TextureId ResourceManager::getTexture(const Handle& handle)
+{
+    const auto* asset = use(handle, AssetType::texture);
+    return asset != nullptr ? asset->texture : TextureId{};
+}
+
+ISoundTrack* ResourceManager::getSoundTrack(const Handle& handle)
+{
+    const auto* asset = use(handle, AssetType::soundTrack);
+    return asset != nullptr ? asset->soundTrack : nullptr;
+}
+
+ResourceManager::Asset* ResourceManager::use(const Handle& handle,
+                                             AssetType     type)
+{
+    if (!handle || handle.m_asset->type != type)
+    {
+        return nullptr;
+    }
+    auto& asset        = *handle.m_asset;
+    asset.lastUseFrame = m_framesCount;
+    if (!asset.isLoaded)
+    {
+        load(asset);
+    }
+    return &asset;
+}
+
+void ResourceManager::load(Asset& asset)
+{
+    // failed asset isn't loaded again on every get
+    asset.isLoaded = true;
+    if (asset.type == AssetType::texture)
+    {
+        asset.texture = m_config.isTextureLoadingAsync
+                            ? m_engine.addTextureAsync(asset.name)
+                            : m_engine.addTexture(asset.name);
+    }
+    else
+    {
+        asset.soundTrack = m_engine.addSoundTrack(asset.name);
+        asset.residentBytes =
+            asset.soundTrack != nullptr ? asset.soundTrack->getMemorySize() : 0;
+        m_cpuBytes += asset.residentBytes;
+    }
+    if (asset.residentBytesMetric == nullptr)
+    {
+        asset.residentBytesMetric = &MetricsRegistry::getGauge(
+            std::string{ "resources.bytes." }.append(asset.name));
+    }
+    m_loadsCount.add();
+    OM_LOG(debug, engine, "Asset is loaded: " << asset.name);
+}
+
+void ResourceManager::unload(Asset& asset)
+{
+    if (asset.texture.isInit())
+    {
+        m_engine.eraseTexture(asset.texture);
+    }
+    if (asset.soundTrack != nullptr)
+    {
+        m_engine.eraseSoundTrack(asset.soundTrack);
+    }
+    if (asset.residentBytesMetric != nullptr)
+    {
+        asset.residentBytesMetric->set(0);
+    }
+    asset.texture       = TextureId{};
+    asset.soundTrack    = nullptr;
+    asset.residentBytes = 0;
+    asset.isLoaded      = false;
+}
+
+void ResourceManager::evict(AssetType type, size_t budget, size_t& r_bytes)
+{
+    if (r_bytes <= budget)
+    {
+        return;
+    }
+    m_evictionCandidates.clear();
+    for (auto assetIt = m_assets.begin(); assetIt != m_assets.end(); ++assetIt)
+    {
+        const auto& asset = assetIt->second;
+        if (asset.type == type && asset.isLoaded && asset.referencesCount == 0)
+        {
+            m_evictionCandidates.push_back(assetIt);
+        }
+    }
+    std::sort(m_evictionCandidates.begin(), m_evictionCandidates.end(),
+              [](Assets::iterator first, Assets::iterator second) {
+                  return first->second.lastUseFrame <
+                         second->second.lastUseFrame;
+              });
+    for (auto assetIt : m_evictionCandidates)
+    {
+        if (r_bytes <= budget)
+        {
+            break;
+        }
+        OM_LOG(debug, engine,
+               "Asset is evicted: " << assetIt->first << ' '
+                                    << assetIt->second.residentBytes
+                                    << " bytes");
+        r_bytes -= assetIt->second.residentBytes;
+        unload(assetIt->second);
+        m_assets.erase(assetIt);
+        m_evictionsCount.add();
+    }
+}
+
+void ResourceManager::finishFrame()
+{
+    // sizes of textures grow while they are uploaded and streamed
+    m_gpuBytes = 0;
+    for (auto assetIt = m_assets.begin(); assetIt != m_assets.end();)
+    {
+        auto& asset = assetIt->second;
+        if (!asset.isLoaded && asset.referencesCount == 0)
+        {
+            // acquired and released without use
+            assetIt = m_assets.erase(assetIt);
+            continue;
+        }
+        if (asset.texture.isInit())
+        {
+            asset.residentBytes = m_engine.getTextureMemorySize(asset.texture);
+            m_gpuBytes += asset.residentBytes;
+        }
+        if (asset.residentBytesMetric != nullptr)
+        {
+            asset.residentBytesMetric->set(
+                static_cast<double>(asset.residentBytes));
+        }
+        ++assetIt;
+    }
+    evict(AssetType::texture, m_config.gpuBudgetBytes, m_gpuBytes);
+    evict(AssetType::soundTrack, m_config.cpuBudgetBytes, m_cpuBytes);
+
+    m_gpuBytesMetric.set(static_cast<double>(m_gpuBytes));
+    m_cpuBytesMetric.set(static_cast<double>(m_cpuBytes));
+    ++m_framesCount;
+}
+
+std::vector<ResourceManager::ReportEntry> ResourceManager::getReport() const
+{
+    std::vector<ReportEntry> report;
+    for (const auto& [name, asset] : m_assets)
+    {
+        if (asset.isLoaded)
+        {
+            report.push_back({ name, asset.type, asset.residentBytes,
+                               asset.referencesCount });
+        }
+    }
+    std::sort(report.begin(), report.end(),
+              [](const ReportEntry& first, const ReportEntry& second) {
+                  return first.residentBytes > second.residentBytes;
+              });
+    return report;
+}
+
+void ResourceManager::writeReport(std::ostream& stream) const
+{
+    stream << "Resident assets, gpu: " << m_gpuBytes
+           << " bytes, cpu: " << m_cpuBytes << " bytes" << std::endl;
+    for (const auto& entry : getReport())
+    {
+        stream << (entry.type == AssetType::texture ? "texture " : "sound ")
+               << entry.name << ' ' << entry.residentBytes
+               << " bytes, references: " << entry.referencesCount
+               << std::endl;
+    }
+}
+
+} // namespace om
@@ -0,0 +1,491 @@
+#include "software_rasterizer.hpp"
+#include "simd.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace om
+{
+
+static constexpr size_t rasterBytesPerPixel{ 4 };
+
+/// Index of texel for repeated texture coordinate
+static size_t wrapTexel(float coordinate, int size)
+{
+    // floor without library call, it is slow without SSE4.1
+    const auto scaled = coordinate * size;
+    auto       texel  = static_cast<int>(scaled);
+    texel -= scaled < texel;
+    texel %= size;
+    return static_cast<size_t>(texel < 0 ? texel + size : texel);
+}
+
+static std::uint8_t toByte(float value)
+{
+    return static_cast<std::uint8_t>(
+        std::lround(std::clamp(value, 0.f, 1.f) * 255.f));
+}
+
+// Color of pixel is one register of four channels in bytes range. Source
+// color is modulated by texel and blended over pixel by GL_SRC_ALPHA,
+// GL_ONE_MINUS_SRC_ALPHA for all channels, as by game shaders
+#if defined(OM_SIMD_SSE2)
+using Rgba = __m128;
+
+static Rgba makeRgba(float r, float g, float b, float a)
+{
+    return _mm_setr_ps(r, g, b, a);
+}
+
+static Rgba addRgba(Rgba first, Rgba second)
+{
+    return _mm_add_ps(first, second);
+}
+
+static Rgba loadRgba(const void* bytes)
+{
+    std::int32_t packed;
+    std::memcpy(&packed, bytes, sizeof(packed));
+    const auto zero   = _mm_setzero_si128();
+    const auto bytes8 = _mm_cvtsi32_si128(packed);
+    const auto words  = _mm_unpacklo_epi8(bytes8, zero);
+    return _mm_cvtepi32_ps(_mm_unpacklo_epi16(words, zero));
+}
+
+static void blendPixel(Rgba color, const std::byte* texel,
+                       std::uint8_t* pixel)
+{
+    const auto byteScale = _mm_set1_ps(1 / 255.f);
+    const auto one       = _mm_set1_ps(1.f);
+    auto       source    = color;
+    if (texel)
+    {
+        source = _mm_mul_ps(source, _mm_mul_ps(loadRgba(texel), byteScale));
+    }
+    auto alpha = _mm_shuffle_ps(source, source, 0b11111111);
+    alpha      = _mm_min_ps(
+        _mm_max_ps(_mm_mul_ps(alpha, byteScale), _mm_setzero_ps()), one);
+    const auto blended =
+        _mm_add_ps(_mm_mul_ps(source, alpha),
+                   _mm_mul_ps(loadRgba(pixel), _mm_sub_ps(one, alpha)));
+    const auto clamped = _mm_min_ps(_mm_max_ps(blended, _mm_setzero_ps()),
+                                    _mm_set1_ps(255.f));
+    const auto rounded =
+        _mm_cvttps_epi32(_mm_add_ps(clamped, _mm_set1_ps(0.5f)));
+    const auto words   = _mm_packs_epi32(rounded, rounded);
+    const auto packed  = _mm_cvtsi128_si32(_mm_packus_epi16(words, words));
+    std::memcpy(pixel, &packed, sizeof(packed));
+}
+#elif defined(OM_SIMD_NEON)
+using Rgba = float32x4_t;
+
+static Rgba makeRgba(float r, float g, float b, float a)
+{
+    const float channels[4]{ r, g, b, a };
+    return vld1q_f32(channels);
+}
+
+static Rgba addRgba(Rgba first, Rgba second)
+{
+    return vaddq_f32(first, second);
+}
+
+static Rgba loadRgba(const void* bytes)
+{
+    std::uint32_t packed;
+    std::memcpy(&packed, bytes, sizeof(packed));
+    const auto words = vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(packed)));
+    return vcvtq_f32_u32(vmovl_u16(vget_low_u16(words)));
+}
+
+static void blendPixel(Rgba color, const std::byte* texel,
+                       std::uint8_t* pixel)
+{
+    const auto byteScale = vdupq_n_f32(1 / 255.f);
+    const auto one       = vdupq_n_f32(1.f);
+    auto       source    = color;
+    if (texel)
+    {
+        source = vmulq_f32(source, vmulq_f32(loadRgba(texel), byteScale));
+    }
+    // multiplications and additions are not fused, as in scalar code
+    auto alpha = vdupq_laneq_f32(source, 3);
+    alpha      = vminq_f32(
+        vmaxq_f32(vmulq_f32(alpha, byteScale), vdupq_n_f32(0.f)), one);
+    const auto blended =
+        vaddq_f32(vmulq_f32(source, alpha),
+                  vmulq_f32(loadRgba(pixel), vsubq_f32(one, alpha)));
+    const auto clamped = vminq_f32(vmaxq_f32(blended, vdupq_n_f32(0.f)),
+                                   vdupq_n_f32(255.f));
+    const auto rounded = vcvtq_u32_f32(vaddq_f32(clamped, vdupq_n_f32(0.5f)));
+    const auto words   = vmovn_u32(rounded);
+    const auto bytes   = vmovn_u16(vcombine_u16(words, words));
+    const auto packed  = vget_lane_u32(vreinterpret_u32_u8(bytes), 0);
+    std::memcpy(pixel, &packed, sizeof(packed));
+}
+#else
+using Rgba = std::array<float, 4>;
+
+static Rgba makeRgba(float r, float g, float b, float a)
+{
+    return { r, g, b, a };
+}
+
+static Rgba addRgba(Rgba first, Rgba second)
+{
+    for (size_t channel = 0; channel < first.size(); ++channel)
+    {
+        first[channel] += second[channel];
+    }
+    return first;
+}
+
+static void blendPixel(Rgba color, const std::byte* texel,
+                       std::uint8_t* pixel)
+{
+    auto source = color;
+    if (texel)
+    {
+        for (size_t channel = 0; channel < source.size(); ++channel)
+        {
+            source[channel] *=
+                std::to_integer<std::uint8_t>(texel[channel]) * (1 / 255.f);
+        }
+    }
+    const auto alpha = std::clamp(source[3] * (1 / 255.f), 0.f, 1.f);
+    for (size_t channel = 0; channel < source.size(); ++channel)
+    {
+        const auto blended =
+            source[channel] * alpha + pixel[channel] * (1 - alpha);
+        pixel[channel] = static_cast<std::uint8_t>(
+            std::clamp(blended, 0.f, 255.f) + 0.5f);
+    }
+}
+#endif
+
+SoftwareRasterizer::SoftwareRasterizer(size_t w, size_t h,
+                                       size_t threadsCount)
+    : m_w{ w }
+    , m_h{ h }
+    , m_threadsCount{ std::max<size_t>(threadsCount, 1) }
+    , m_tilesW{ (w + tileSize - 1) / tileSize }
+    , m_tilesH{ (h + tileSize - 1) / tileSize }
+    , m_pixels(w * h * rasterBytesPerPixel)
+    , m_tilesTriangles(m_tilesW * m_tilesH)
+{
+    // calling thread of rasterize is one of workers
+    m_workers.reserve(m_threadsCount - 1);
+    for (size_t i = 1; i < m_threadsCount; ++i)
+    {
+        m_workers.emplace_back([this]() { runWorker(); });
+    }
+}
+
+SoftwareRasterizer::~SoftwareRasterizer()
+{
+    {
+        std::lock_guard lock{ m_workersMutex };
+        m_isStopping = true;
+    }
+    m_frameStarted.notify_all();
+    for (auto& worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+void SoftwareRasterizer::clear(Color color)
+{
+    m_clearColor = { toByte(color.get_r()), toByte(color.get_g()),
+                     toByte(color.get_b()), toByte(color.get_a()) };
+    m_triangles.clear();
+    for (auto& tileTriangles : m_tilesTriangles)
+    {
+        tileTriangles.clear();
+    }
+}
+
+void SoftwareRasterizer::addTriangle(
+    const std::array<ScreenVertex, 3>& vertices,
+    std::shared_ptr<const Texture>     texture)
+{
+    auto p = vertices;
+    // edges function is positive inside of triangle
+    auto area = (p[1].x - p[0].x) * (p[2].y - p[0].y) -
+                (p[1].y - p[0].y) * (p[2].x - p[0].x);
+    if (!(std::abs(area) > 0))
+    {
+        return;
+    }
+    if (area < 0)
+    {
+        std::swap(p[1], p[2]);
+        area = -area;
+    }
+
+    // bounds are clamped before conversion, vertices may be far outside
+    const auto toPixel = [](float coordinate, size_t size) {
+        return static_cast<int>(
+            std::clamp(coordinate, -1.f, static_cast<float>(size)));
+    };
+    RasterTriangle triangle;
+    triangle.minX = std::max(
+        0, toPixel(std::floor(std::min({ p[0].x, p[1].x, p[2].x })), m_w));
+    triangle.minY = std::max(
+        0, toPixel(std::floor(std::min({ p[0].y, p[1].y, p[2].y })), m_h));
+    triangle.maxX = std::min(
+        static_cast<int>(m_w) - 1,
+        toPixel(std::ceil(std::max({ p[0].x, p[1].x, p[2].x })), m_w));
+    triangle.maxY = std::min(
+        static_cast<int>(m_h) - 1,
+        toPixel(std::ceil(std::max({ p[0].y, p[1].y, p[2].y })), m_h));
+    if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY)
+    {
+        return;
+    }
+
+    // edge k is opposite to vertex k, its function is barycentric weight of
+    // vertex k multiplied by area
+    for (size_t k = 0; k < 3; ++k)
+    {
+        const auto& from = p[(k + 1) % 3];
+        const auto& to   = p[(k + 2) % 3];
+        auto&       edge = triangle.edges[k];
+        edge.a           = from.y - to.y;
+        edge.b           = to.x - from.x;
+        edge.c           = -edge.a * from.x - edge.b * from.y;
+    }
+
+    const std::array<std::array<float, 3>, 6> values{ {
+        { p[0].u, p[1].u, p[2].u },
+        { p[0].v, p[1].v, p[2].v },
+        { p[0].color.get_r(), p[1].color.get_r(), p[2].color.get_r() },
+        { p[0].color.get_g(), p[1].color.get_g(), p[2].color.get_g() },
+        { p[0].color.get_b(), p[1].color.get_b(), p[2].color.get_b() },
+        { p[0].color.get_a(), p[1].color.get_a(), p[2].color.get_a() },
+    } };
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        auto& gradient = triangle.attributes[i];
+        for (size_t k = 0; k < 3; ++k)
+        {
+            gradient.a0 += triangle.edges[k].c * values[i][k] / area;
+            gradient.dadx += triangle.edges[k].a * values[i][k] / area;
+            gradient.dady += triangle.edges[k].b * values[i][k] / area;
+        }
+    }
+
+    if (texture)
+    {
+        // level with texel size close to pixel, as GL_NEAREST_MIPMAP_NEAREST
+        const auto& u         = triangle.attributes[0];
+        const auto& v         = triangle.attributes[1];
+        const auto  w         = static_cast<float>(texture->w);
+        const auto  h         = static_cast<float>(texture->h);
+        const auto  footprint = std::max(std::hypot(u.dadx * w, v.dadx * h),
+                                         std::hypot(u.dady * w, v.dady * h));
+        if (footprint > 1)
+        {
+            triangle.level = std::min(
+                static_cast<size_t>(std::log2(footprint) + 0.5f),
+                texture->levelsCount - 1);
+        }
+        triangle.texture = std::move(texture);
+    }
+
+    const auto triangleIndex = m_triangles.size();
+    m_triangles.push_back(std::move(triangle));
+    const auto& added = m_triangles.back();
+    for (auto tileY = added.minY / tileSize; tileY <= added.maxY / tileSize;
+         ++tileY)
+    {
+        for (auto tileX = added.minX / tileSize;
+             tileX <= added.maxX / tileSize; ++tileX)
+        {
+            m_tilesTriangles[tileY * m_tilesW + tileX].push_back(triangleIndex);
+        }
+    }
+}
+
+void SoftwareRasterizer::rasterize()
+{
+    const auto startTime = std::chrono::steady_clock::now();
+    m_nextTile           = 0;
+    m_framePixelsCount   = 0;
+    {
+        std::lock_guard lock{ m_workersMutex };
+        ++m_startedFramesCount;
+        m_busyWorkersCount = m_workers.size();
+    }
+    m_frameStarted.notify_all();
+    rasterizeTiles();
+    {
+        std::unique_lock lock{ m_workersMutex };
+        m_frameFinished.wait(lock,
+                             [this]() { return m_busyWorkersCount == 0; });
+    }
+
+    ++m_statistics.framesCount;
+    m_statistics.triangles += m_triangles.size();
+    m_statistics.pixels += m_framePixelsCount;
+    m_statistics.rasterizationTime += std::chrono::steady_clock::now() -
+                                      startTime;
+}
+
+void SoftwareRasterizer::runWorker()
+{
+    size_t framesCount{};
+    while (true)
+    {
+        {
+            std::unique_lock lock{ m_workersMutex };
+            m_frameStarted.wait(lock, [this, framesCount]() {
+                return m_isStopping || m_startedFramesCount != framesCount;
+            });
+            if (m_isStopping)
+            {
+                return;
+            }
+            framesCount = m_startedFramesCount;
+        }
+        rasterizeTiles();
+        {
+            std::lock_guard lock{ m_workersMutex };
+            --m_busyWorkersCount;
+        }
+        m_frameFinished.notify_one();
+    }
+}
+
+void SoftwareRasterizer::rasterizeTiles()
+{
+    for (auto tile = m_nextTile++; tile < m_tilesTriangles.size();
+         tile      = m_nextTile++)
+    {
+        m_framePixelsCount += rasterizeTile(tile);
+    }
+}
+
+size_t SoftwareRasterizer::rasterizeTile(size_t tileIndex)
+{
+    const auto tileX0 = static_cast<int>(tileIndex % m_tilesW * tileSize);
+    const auto tileY0 = static_cast<int>(tileIndex / m_tilesW * tileSize);
+    const auto tileX1 = std::min(tileX0 + static_cast<int>(tileSize),
+                                 static_cast<int>(m_w));
+    const auto tileY1 = std::min(tileY0 + static_cast<int>(tileSize),
+                                 static_cast<int>(m_h));
+
+    // the first row is cleared by pixels, others are copied from it
+    const auto rowSize  = (tileX1 - tileX0) * rasterBytesPerPixel;
+    auto*      firstRow =
+        &m_pixels[(tileY0 * m_w + tileX0) * rasterBytesPerPixel];
+    for (size_t offset = 0; offset < rowSize; offset += rasterBytesPerPixel)
+    {
+        std::copy(m_clearColor.begin(), m_clearColor.end(), firstRow + offset);
+    }
+    for (auto y = tileY0 + 1; y < tileY1; ++y)
+    {
+        std::copy(firstRow, firstRow + rowSize,
+                  &m_pixels[(y * m_w + tileX0) * rasterBytesPerPixel]);
+    }
+
+    size_t pixelsCount{};
+    for (const auto triangleIndex : m_tilesTriangles[tileIndex])
+    {
+        const auto& triangle = m_triangles[triangleIndex];
+        const auto  yBegin   = std::max(triangle.minY, tileY0);
+        const auto  yEnd     = std::min(triangle.maxY + 1, tileY1);
+        for (auto y = yBegin; y < yEnd; ++y)
+        {
+            // span of row is intersection of half planes of edges
+            const auto yCenter = y + 0.5f;
+            auto       xBegin  = std::max(triangle.minX, tileX0);
+            auto       xEnd    = std::min(triangle.maxX + 1, tileX1);
+            for (const auto& edge : triangle.edges)
+            {
+                // edge of opposite direction in neighbour triangle has
+                // opposite inclusion, so shared pixels are drawn once
+                const auto rowValue = edge.b * yCenter + edge.c;
+                if (edge.a == 0)
+                {
+                    if (rowValue < 0 || (rowValue == 0 && edge.b < 0))
+                    {
+                        xEnd = xBegin;
+                    }
+                    continue;
+                }
+                // pixel center x + 0.5 is on edge at bound
+                const auto bound = std::clamp(-rowValue / edge.a - 0.5f, -1.f,
+                                              static_cast<float>(m_w) + 1);
+                if (edge.a > 0)
+                {
+                    xBegin =
+                        std::max(xBegin, static_cast<int>(std::ceil(bound)));
+                }
+                else
+                {
+                    xEnd = std::min(xEnd, static_cast<int>(std::ceil(bound)));
+                }
+            }
+            if (xBegin < xEnd)
+            {
+                fillSpan(triangle, y, xBegin, xEnd);
+                pixelsCount += static_cast<size_t>(xEnd - xBegin);
+            }
+        }
+    }
+    return pixelsCount;
+}
+
+void SoftwareRasterizer::fillSpan(const RasterTriangle& triangle, int y,
+                                  int xBegin, int xEnd)
+{
+    const auto xCenter = xBegin + 0.5f;
+    const auto yCenter = y + 0.5f;
+
+    std::array<float, 6> values;
+    std::array<float, 6> steps;
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        const auto& gradient = triangle.attributes[i];
+        values[i] = gradient.a0 + gradient.dadx * xCenter +
+                    gradient.dady * yCenter;
+        steps[i] = gradient.dadx;
+    }
+
+    const std::byte* texels{};
+    int              levelW{ 1 };
+    int              levelH{ 1 };
+    if (triangle.texture)
+    {
+        levelW = static_cast<int>(triangle.texture->getLevelW(triangle.level));
+        levelH = static_cast<int>(triangle.texture->getLevelH(triangle.level));
+        texels = triangle.texture->data() +
+                 triangle.texture->getLevelOffset(triangle.level);
+    }
+
+    // blending is done in bytes range, so only source color is scaled
+    auto       color     = makeRgba(values[2] * 255.f, values[3] * 255.f,
+                                    values[4] * 255.f, values[5] * 255.f);
+    const auto colorStep = makeRgba(steps[2] * 255.f, steps[3] * 255.f,
+                                    steps[4] * 255.f, steps[5] * 255.f);
+    auto       u         = values[0];
+    auto       v         = values[1];
+
+    auto* pixel = &m_pixels[(y * m_w + xBegin) * rasterBytesPerPixel];
+    for (auto x = xBegin; x < xEnd; ++x)
+    {
+        const auto* texel =
+            texels ? texels + (wrapTexel(v, levelH) * levelW +
+                               wrapTexel(u, levelW)) *
+                                  rasterBytesPerPixel
+                   : nullptr;
+        blendPixel(color, texel, pixel);
+        pixel += rasterBytesPerPixel;
+        color = addRgba(color, colorStep);
+        u += steps[0];
+        v += steps[1];
+    }
+}
+
+} // namespace om
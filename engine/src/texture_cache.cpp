@@ -0,0 +1,202 @@
+#include "texture_cache.hpp"
+#include "file_utils.hpp"
+#include "mapped_file.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <optional>
+
+namespace om
+{
+
+struct CacheHeader
+{
+    std::array<char, 8> magic{};
+    std::uint64_t       sourceSize{};
+    std::int64_t        sourceModificationTime{};
+    std::uint64_t       sourceHash{};
+    std::uint64_t       w{};
+    std::uint64_t       h{};
+    std::uint64_t       levelsCount{};
+    std::uint64_t       pixelsSize{};
+    /// Offset of png in asset pack, 0 for loose file
+    std::uint64_t       packOffset{};
+};
+
+struct SourceStat
+{
+    std::uint64_t size{};
+    std::int64_t  modificationTime{};
+};
+
+static constexpr std::array<char, 8> cacheMagic{ 'O', 'M', 'T', 'E',
+                                                 'X', 'C', '0', '3' };
+
+static std::string cacheDirectory;
+
+static std::string getCachePath(const std::string_view filePath)
+{
+    std::string name{ filePath };
+    std::replace_if(
+        name.begin(), name.end(),
+        [](char symbol) { return symbol == '/' || symbol == '\\'; }, '_');
+    return cacheDirectory + name + ".rgba";
+}
+
+/// Nullopt if file is not in file system, as android assets
+static std::optional<SourceStat> getSourceStat(const std::string_view filePath)
+{
+    namespace fs = std::filesystem;
+    std::error_code error;
+    const fs::path  path{ filePath };
+    const auto      size = fs::file_size(path, error);
+    if (error)
+    {
+        return std::nullopt;
+    }
+    const auto modificationTime = fs::last_write_time(path, error);
+    if (error)
+    {
+        return std::nullopt;
+    }
+    return SourceStat{ size, static_cast<std::int64_t>(
+                                 modificationTime.time_since_epoch().count()) };
+}
+
+/// Maps cache file of png and fills image if isValid accepts its header
+template <typename Predicate>
+static bool loadCache(const std::string_view filePath, Predicate&& isValid,
+                      GlTexture::DecodedImage& r_image)
+{
+    if (cacheDirectory.empty())
+    {
+        return false;
+    }
+    const auto mapped = mapFile(getCachePath(filePath));
+    if (!mapped || mapped->size < sizeof(CacheHeader))
+    {
+        return false;
+    }
+    CacheHeader header;
+    std::memcpy(&header, mapped->data.get(), sizeof(header));
+    if (header.magic != cacheMagic ||
+        header.pixelsSize != mapped->size - sizeof(header) || !isValid(header))
+    {
+        return false;
+    }
+    GlTexture::DecodedImage image;
+    image.w           = header.w;
+    image.h           = header.h;
+    image.levelsCount = header.levelsCount;
+    // all levels should be inside of file
+    if (header.levelsCount == 0 ||
+        image.getLevelOffset(header.levelsCount) > header.pixelsSize)
+    {
+        return false;
+    }
+    // pixels share ownership of the whole mapping
+    image.mappedPixels = std::shared_ptr<const std::byte>{
+        mapped->data, mapped->data.get() + sizeof(header)
+    };
+    r_image = std::move(image);
+    return true;
+}
+
+void TextureCache::setDirectory(std::string directory)
+{
+    if (!directory.empty() && directory.back() != '/' &&
+        directory.back() != '\\')
+    {
+        directory += '/';
+    }
+    cacheDirectory = std::move(directory);
+}
+
+bool TextureCache::loadIfUnchanged(const std::string_view  filePath,
+                                   GlTexture::DecodedImage& r_image)
+{
+    const auto sourceStat = getSourceStat(filePath);
+    if (!sourceStat)
+    {
+        return false;
+    }
+    return loadCache(
+        filePath,
+        [&sourceStat](const CacheHeader& header) {
+            return header.sourceSize == sourceStat->size &&
+                   header.sourceModificationTime ==
+                       sourceStat->modificationTime &&
+                   header.packOffset == 0;
+        },
+        r_image);
+}
+
+bool TextureCache::loadIfUnchanged(const std::string_view   filePath,
+                                   ArrayView<std::byte>     png,
+                                   const PackedSource&      packedSource,
+                                   GlTexture::DecodedImage& r_image)
+{
+    return loadCache(
+        filePath,
+        [png, &packedSource](const CacheHeader& header) {
+            return header.sourceSize == png.size() &&
+                   header.sourceModificationTime ==
+                       packedSource.packModificationTime &&
+                   header.packOffset == packedSource.offset;
+        },
+        r_image);
+}
+
+bool TextureCache::loadIfSameContent(const std::string_view   filePath,
+                                     ArrayView<std::byte>     png,
+                                     GlTexture::DecodedImage& r_image)
+{
+    const auto hash = calcFnv1a(png);
+    return loadCache(
+        filePath,
+        [png, hash](const CacheHeader& header) {
+            return header.sourceSize == png.size() && header.sourceHash == hash;
+        },
+        r_image);
+}
+
+void TextureCache::store(const std::string_view             filePath,
+                         ArrayView<std::byte>               png,
+                         const GlTexture::DecodedImage&     image,
+                         const std::optional<PackedSource>& packedSource)
+{
+    if (cacheDirectory.empty())
+    {
+        return;
+    }
+    namespace fs = std::filesystem;
+    std::error_code error;
+    fs::create_directories(cacheDirectory, error);
+
+    const auto sourceStat =
+        packedSource ? SourceStat{ png.size(),
+                                   packedSource->packModificationTime }
+                     : getSourceStat(filePath).value_or(SourceStat{});
+    CacheHeader header;
+    header.magic                  = cacheMagic;
+    header.sourceSize             = png.size();
+    header.sourceModificationTime = sourceStat.modificationTime;
+    header.sourceHash             = calcFnv1a(png);
+    header.w                      = image.w;
+    header.h                      = image.h;
+    header.levelsCount            = image.levelsCount;
+    header.pixelsSize             = image.pixels.size();
+    header.packOffset             = packedSource ? packedSource->offset : 0;
+
+    AtomicFileWriter writer{ getCachePath(filePath) };
+    auto&            file = writer.getStream();
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(image.pixels.data()),
+               static_cast<std::streamsize>(image.pixels.size()));
+    writer.commit();
+}
+
+} // namespace om
@@ -0,0 +1,145 @@
+#include "trace.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace om
+{
+
+struct TraceEvent
+{
+    const char*   name{};
+    std::uint64_t startTime{};
+    std::uint64_t duration{};
+};
+
+/// Written by own thread, mutex isn't contended except while trace is written
+struct TraceThreadBuffer
+{
+    std::mutex              mutex;
+    std::vector<TraceEvent> events;
+    size_t                  nextIndex{};
+    size_t                  eventsCount{};
+    size_t                  threadId{};
+    std::string             threadName;
+};
+
+struct TraceStorage
+{
+    std::mutex                                      mutex;
+    std::vector<std::shared_ptr<TraceThreadBuffer>> buffers;
+};
+
+/// trace_event time is in microseconds
+static void writeMicroseconds(std::ostream& out, std::uint64_t nanoseconds)
+{
+    out << nanoseconds / 1000 << '.' << std::setw(3) << std::setfill('0')
+        << nanoseconds % 1000;
+}
+
+static TraceStorage& getStorage()
+{
+    static TraceStorage storage;
+    return storage;
+}
+
+static TraceThreadBuffer& getThreadBuffer()
+{
+    // storage keeps buffer after thread exit, so its events are written too
+    thread_local const auto buffer = []() {
+        auto newBuffer = std::make_shared<TraceThreadBuffer>();
+        newBuffer->events.resize(Trace::threadEventsCount);
+        auto&           storage = getStorage();
+        std::lock_guard lock{ storage.mutex };
+        newBuffer->threadId = storage.buffers.size() + 1;
+        storage.buffers.push_back(newBuffer);
+        return newBuffer;
+    }();
+    return *buffer;
+}
+
+void Trace::addEvent(const char* name, std::uint64_t startTime,
+                     std::uint64_t endTime)
+{
+    auto&           buffer = getThreadBuffer();
+    std::lock_guard lock{ buffer.mutex };
+    buffer.events[buffer.nextIndex] = { name, startTime, endTime - startTime };
+    buffer.nextIndex   = (buffer.nextIndex + 1) % buffer.events.size();
+    buffer.eventsCount = std::min(buffer.eventsCount + 1, buffer.events.size());
+}
+
+void Trace::setThreadName(const char* name)
+{
+    auto&           buffer = getThreadBuffer();
+    std::lock_guard lock{ buffer.mutex };
+    buffer.threadName = name;
+}
+
+bool Trace::writeChromeJson(std::string_view filePath)
+{
+    std::ofstream out{ std::string{ filePath } };
+    if (!out)
+    {
+        std::cerr << "Can't open trace file " << filePath << std::endl;
+        return false;
+    }
+
+    std::vector<std::shared_ptr<TraceThreadBuffer>> buffers;
+    {
+        auto&           storage = getStorage();
+        std::lock_guard lock{ storage.mutex };
+        buffers = storage.buffers;
+    }
+
+    // names are string literals of code, they don't need escaping
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    const char* separator = "";
+    size_t      eventsCount{};
+    for (const auto& buffer : buffers)
+    {
+        std::lock_guard lock{ buffer->mutex };
+        if (!buffer->threadName.empty())
+        {
+            out << separator
+                << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+                << buffer->threadId << ",\"args\":{\"name\":\""
+                << buffer->threadName << "\"}}";
+            separator = ",\n";
+        }
+        eventsCount += buffer->eventsCount;
+        // the oldest event is next to be overwritten
+        const auto size  = buffer->events.size();
+        const auto first = (buffer->nextIndex + size - buffer->eventsCount) %
+                           size;
+        for (size_t i = 0; i < buffer->eventsCount; ++i)
+        {
+            const auto& event = buffer->events[(first + i) % size];
+            out << separator << "{\"name\":\"" << event.name
+                << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId
+                << ",\"ts\":";
+            writeMicroseconds(out, event.startTime);
+            out << ",\"dur\":";
+            writeMicroseconds(out, event.duration);
+            out << '}';
+            separator = ",\n";
+        }
+        buffer->eventsCount = 0;
+    }
+    out << "\n]}\n";
+
+    if (!out)
+    {
+        std::cerr << "Error writing trace file " << filePath << std::endl;
+        return false;
+    }
+    std::clog << "Trace of " << eventsCount << " events is written to "
+              << filePath << std::endl;
+    return true;
+}
+
+} // namespace om
@@ -0,0 +1,17 @@
+#include "asset_pack.hpp"
+#include <cstdlib>
+#include <iostream>
+
+// usage: om_asset_packer <pack file> <resources directory>
+// assets are named by path relative to parent of directory, as res/...
+int main(int argc, char* argv[])
+{
+    if (argc != 3)
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " <pack file> <resources directory>" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return om::AssetPack::write(argv[1], argv[2]) ? EXIT_SUCCESS
+                                                  : EXIT_FAILURE;
+}
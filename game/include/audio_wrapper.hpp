@@ -2,6 +2,8 @@
 #include "world.hpp"
 #include <forward_list>
 #include <iengine.hpp>
+#include <resource_manager.hpp>
+#include <vector>
 
 struct RocketAudio
 {
@@ -20,7 +22,8 @@ struct RocketAudio
 class AudioWrapper
 {
 public:
-    explicit AudioWrapper(om::IEngine& engine);
+    /// Game over music is loaded only after death
+    AudioWrapper(om::IEngine& engine, om::ResourceManager& resources);
     void play(const Model::World& world);
     void playGameOver();
 
@@ -29,10 +32,14 @@ public:
     static constexpr om::myGlfloat enemiesRocketsVolume = 0.9;
     static constexpr om::myGlfloat explosionVolume      = 1.0;
 
+    /// Engines of farther rockets are silent
+    static constexpr om::myGlfloat rocketsHearableDistance = 2000.0;
+
 private:
     void checkRocketAudioConfig(const Model::World& world);
     void playBackground();
     void addAllTracks();
+    void stopGameOver();
     void playOneEvent(const Model::OutEvent& event,
                       om::myGlfloat volume = AudioWrapper::explosionVolume);
 
@@ -47,11 +54,16 @@ private:
     om::ISoundTrack*  m_soundTrackBackground;
     om::ISoundBuffer* m_soundBufferBackground;
 
-    om::ISoundTrack*  m_soundTrackBackgroundGameOver;
-    om::ISoundBuffer* m_soundBufferBackgroundGameOver;
+    std::vector<om::ResourceManager::Handle> m_soundTracks;
+
+    /// Empty while game goes on
+    om::ResourceManager::Handle m_soundTrackBackgroundGameOver;
+    om::ISoundBuffer*           m_soundBufferBackgroundGameOver{};
 
     std::list<RocketAudio> rocketAudios;
     RocketAudio            userRocketAudio;
+    /// Sorted by objects, keeps allocated memory between frames
+    std::vector<Model::SpatialIndex::Entry> m_hearableRockets;
 
     static constexpr std::string_view pathToSoundTrackBackground{
         "res/sounds/cosmic_music.wav"
@@ -82,4 +94,5 @@ private:
     std::forward_list<const Model::Rocket*> rockets;
     const Model::Rocket*                    userRocket{};
     om::IEngine&                            m_engine;
+    om::ResourceManager&                    m_resources;
 };
@@ -0,0 +1,69 @@
+#pragma once
+#include "world_objects.hpp"
+#include <array>
+
+namespace Model
+{
+
+/// Fixed capacity ring of bullets. All bullets have the same time to live,
+/// so creating order is also expiry order: new bullets are added to head and
+/// expired ones are dropped from tail. Destroyed bullets are only marked and
+/// are reclaimed when tail reaches them
+class BulletPool
+{
+public:
+    using seconds_t    = Timer::seconds_t;
+    using time_point_t = Timer::time_point_t;
+
+    /// Power of two, so ring index is calculated by mask
+    static constexpr size_t capacity{ 1024 };
+
+    /// Returns false if pool is full
+    [[nodiscard]] bool push(const Bullet& bullet);
+    /// Moves all bullets, ring is processed as two contiguous ranges
+    void update(seconds_t dt);
+    void removeExpired(time_point_t nowTime);
+
+    /// Alive bullets count
+    size_t size() const { return m_aliveCount; }
+    bool   empty() const { return m_aliveCount == 0; }
+
+    template <typename Function>
+    void forEach(Function function) const
+    {
+        for (size_t i = 0; i < m_count; ++i)
+        {
+            const auto& bullet = m_bullets[(m_tail + i) & indexMask];
+            if (!bullet.isDestroyed)
+            {
+                function(bullet);
+            }
+        }
+    }
+
+    /// Marks bullets, for which predicate returns true, as destroyed
+    template <typename Predicate>
+    void removeIf(Predicate predicate)
+    {
+        for (size_t i = 0; i < m_count; ++i)
+        {
+            auto& bullet = m_bullets[(m_tail + i) & indexMask];
+            if (!bullet.isDestroyed && predicate(bullet))
+            {
+                bullet.isDestroyed = true;
+                --m_aliveCount;
+            }
+        }
+    }
+
+private:
+    static constexpr size_t indexMask{ capacity - 1 };
+    static_assert((capacity & indexMask) == 0);
+
+    std::array<Bullet, capacity> m_bullets{};
+    size_t                       m_tail{};
+    size_t                       m_count{};
+    size_t                       m_aliveCount{};
+};
+
+} // namespace Model
@@ -1,6 +1,8 @@
 #pragma once
 #include "world_physics.hpp"
+#include <algorithm>
 #include <array>
+#include <limits>
 #include <math.h>
 
 namespace Model
@@ -42,5 +44,42 @@ public:
 
         return true;
     }
+
+    /// Objects move along straight lines during the step, pos is the end
+    /// position and move is the shift over the step. Catches objects which
+    /// pass through each other between checks
+    static bool isCollidedSweptAABB(
+        const InputObject& obj1, const std::array<worldCalcType, 2>& move1,
+        const InputObject& obj2, const std::array<worldCalcType, 2>& move2)
+    {
+        // in obj2 frame center of obj1 moves along segment, it is crossed
+        // with obj2 box enlarged by obj1 size, time of step is [0, 1]
+        worldCalcType enterTime{ 0 };
+        worldCalcType exitTime{ 1 };
+        for (size_t axis = 0; axis < 2; ++axis)
+        {
+            const auto halfSize  = (obj1.size[axis] + obj2.size[axis]) / 2;
+            const auto move      = move1[axis] - move2[axis];
+            const auto startDiff = obj1.pos[axis] - obj2.pos[axis] - move;
+            if (std::abs(move) < std::numeric_limits<worldCalcType>::epsilon())
+            {
+                if (std::abs(startDiff) > halfSize)
+                    return false;
+                continue;
+            }
+            auto axisEnterTime = (-halfSize - startDiff) / move;
+            auto axisExitTime  = (halfSize - startDiff) / move;
+            if (axisEnterTime > axisExitTime)
+            {
+                std::swap(axisEnterTime, axisExitTime);
+            }
+            enterTime = std::max(enterTime, axisEnterTime);
+            exitTime  = std::min(exitTime, axisExitTime);
+            if (enterTime > exitTime)
+                return false;
+        }
+
+        return true;
+    }
 };
 } // namespace Model
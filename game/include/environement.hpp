@@ -3,6 +3,7 @@
 #include "world.hpp"
 #include <functional>
 #include <iengine.hpp>
+#include <trace.hpp>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -34,7 +35,11 @@ public:
     }
 
 private:
+    /// Writes trace collected since the previous one to trace_<number>.json
+    void writeTrace();
+
     std::vector<om::myGlfloat> mouseParams{ 0.0, 0.0, Global::initialScale };
     bool                       m_isPause{};
     bool                       m_resetGame{};
+    size_t                     m_tracesCount{};
 };
@@ -1,13 +1,26 @@
 #pragma once
+#include "trajectory_predictor.hpp"
 #include "world.hpp"
 #include <iengine.hpp>
+#include <optional>
 
 class ImguiWrapper
 {
 public:
     explicit ImguiWrapper(om::IEngine& engine);
-    void createImguiObjects(Model::World& world);
+    void createImguiObjects(Model::World&                     world,
+                            const Model::TrajectoryPredictor& predictor);
+
+    /// Time warp chosen by user since last call, it is sent to world as
+    /// event, so replays keep it
+    [[nodiscard]] std::optional<Model::worldCalcType> takeTimeWarpRequest()
+    {
+        auto returnValue = m_timeWarpRequest;
+        m_timeWarpRequest.reset();
+        return returnValue;
+    }
 
 private:
-    om::IEngine& m_engine;
+    om::IEngine&                        m_engine;
+    std::optional<Model::worldCalcType> m_timeWarpRequest;
 };
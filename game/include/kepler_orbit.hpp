@@ -0,0 +1,65 @@
+#pragma once
+#include "utilities.hpp"
+#include "world_physics.hpp"
+#include <optional>
+
+namespace Model
+{
+
+/// Elliptic two body orbit around static attractor. State in any moment is
+/// calculated from orbital elements by solving Kepler equation, so there is
+/// no integration drift and any time step is allowed
+class KeplerOrbit
+{
+public:
+    using seconds_t    = Timer::seconds_t;
+    using time_point_t = Timer::time_point_t;
+
+    struct State
+    {
+        worldCalcType x{};
+        worldCalcType y{};
+        worldCalcType vx{};
+        worldCalcType vy{};
+    };
+
+    /// Builds orbit from state in world coordinates. mu is gravity constant
+    /// multiplied by attractor mass. Returns nullopt if orbit is not elliptic
+    static std::optional<KeplerOrbit> fromState(const State&  state,
+                                                worldCalcType centerX,
+                                                worldCalcType centerY,
+                                                worldCalcType mu,
+                                                time_point_t  time);
+
+    State getState(time_point_t time) const;
+
+    worldCalcType getSemiMajorAxis() const { return m_semiMajorAxis; }
+    worldCalcType getEccentricity() const { return m_eccentricity; }
+    worldCalcType getPeriapsis() const
+    {
+        return m_semiMajorAxis * (1 - m_eccentricity);
+    }
+
+    /// Eccentric anomaly E for mean anomaly M: E - e * sin(E) = M
+    static worldCalcType solveKeplerEquation(worldCalcType meanAnomaly,
+                                             worldCalcType eccentricity);
+
+private:
+    KeplerOrbit() = default;
+
+    worldCalcType m_centerX{};
+    worldCalcType m_centerY{};
+    worldCalcType m_semiMajorAxis{};
+    worldCalcType m_semiMinorAxis{};
+    worldCalcType m_eccentricity{};
+    worldCalcType m_meanMotion{};
+    worldCalcType m_meanAnomalyAtEpoch{};
+    /// Periapsis direction and perpendicular one in motion direction
+    worldCalcType m_periapsisX{};
+    worldCalcType m_periapsisY{};
+    worldCalcType m_normalX{};
+    worldCalcType m_normalY{};
+    time_point_t  m_epoch{};
+};
+
+} // namespace Model
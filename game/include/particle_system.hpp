@@ -0,0 +1,92 @@
+#pragma once
+#include "utilities.hpp"
+#include "world_physics.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace Model
+{
+
+/// Short living visual objects (trail clouds, hit and explosion animations).
+/// Particles are stored as structure of arrays with fixed budget, free slots
+/// are reused through free list
+class ParticleSystem
+{
+public:
+    using seconds_t    = Timer::seconds_t;
+    using time_point_t = Timer::time_point_t;
+
+    enum class Type : std::uint8_t
+    {
+        trailCloud,
+        hit,
+        explosion,
+        maxType
+    };
+
+    struct Particle
+    {
+        Type          type{};
+        worldCalcType x{};
+        worldCalcType y{};
+        worldCalcType angle{};
+        worldCalcType width{};
+        worldCalcType height{};
+        worldCalcType initPower{ 1 };
+        time_point_t  spawnTime{};
+        seconds_t     timeToLive{};
+
+        /// Part of life time which is passed, from 0 to 1
+        worldCalcType getAgeRatio(time_point_t nowTime) const;
+        /// Trail clouds fade out, animations keep initial power
+        worldCalcType getCurrentPower(time_point_t nowTime) const;
+    };
+
+    static constexpr size_t    budget{ 2048 };
+    static constexpr seconds_t trailCloudTimeToLive{ 3.0 };
+    static constexpr seconds_t hitTimeToLive{ 1.5 };
+    static constexpr seconds_t explosionTimeToLive{ 2.0 };
+
+    ParticleSystem();
+
+    /// Returns false and counts particle as dropped if budget is exhausted
+    bool spawn(const Particle& particle);
+    /// Frees slots of expired particles
+    void update(time_point_t nowTime);
+
+    size_t size() const { return budget - m_freeSlots.size(); }
+    size_t getDroppedCount() const { return m_droppedCount; }
+
+    template <typename Function>
+    void forEach(Function function) const
+    {
+        for (size_t i = 0; i < m_usedSlotsEnd; ++i)
+        {
+            if (m_isAlive[i])
+            {
+                function(get(i));
+            }
+        }
+    }
+
+private:
+    Particle get(size_t index) const;
+
+    std::vector<worldCalcType> m_x;
+    std::vector<worldCalcType> m_y;
+    std::vector<worldCalcType> m_angle;
+    std::vector<worldCalcType> m_width;
+    std::vector<worldCalcType> m_height;
+    std::vector<worldCalcType> m_initPower;
+    std::vector<time_point_t>  m_spawnTime;
+    std::vector<seconds_t>     m_timeToLive;
+    std::vector<Type>          m_type;
+    std::vector<std::uint8_t>  m_isAlive;
+
+    /// Iteration stops at m_usedSlotsEnd, it goes down when last slots die
+    std::vector<std::uint32_t> m_freeSlots;
+    size_t                     m_usedSlotsEnd{};
+    size_t                     m_droppedCount{};
+};
+
+} // namespace Model
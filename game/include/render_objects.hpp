@@ -5,10 +5,28 @@
 #include "sprite.hpp"
 #include "utilities.hpp"
 #include "world.hpp"
+#include <array>
+#include <vector>
 
 namespace renderObjects
 {
 
+/// Part of world seen on screen around user
+struct ViewRect
+{
+    Model::worldCalcType minX{};
+    Model::worldCalcType minY{};
+    Model::worldCalcType maxX{};
+    Model::worldCalcType maxY{};
+
+    static ViewRect getCurrent(om::IEngine& render);
+
+    /// Object can be seen with any angle, size is multiplied by scale
+    bool isVisible(Model::worldCalcType x, Model::worldCalcType y,
+                   Model::worldCalcType width, Model::worldCalcType height,
+                   Model::worldCalcType scale = 1) const;
+};
+
 class PhysicalObject
 {
 public:
@@ -29,8 +47,14 @@ public:
     virtual void draw(om::IEngine& render, const Model::PhysicalObject& object);
     void         draw(om::IEngine& render, const Model::PhysicalObject& object,
                       om::myGlfloat scaleWorldRelateToRender);
+    void         draw(om::IEngine& render, const Model::Bullet& bullet);
 
 protected:
+    void drawSprite(om::IEngine& render, Model::worldCalcType x,
+                    Model::worldCalcType y, Model::worldCalcType width,
+                    Model::worldCalcType height, Model::worldCalcType angle,
+                    om::myGlfloat scaleWorldRelateToRender);
+
     om::Vector<2>       m_pos{};
     om::myGlfloat       m_angle{};
     std::vector<Sprite> m_sprites{};
@@ -47,7 +71,6 @@ public:
     void draw(om::IEngine&                 render,
               const Model::PhysicalObject& object) override;
 
-private:
     static constexpr om::myGlfloat widerNess = 2.5;
 };
 
@@ -108,41 +131,44 @@ protected:
     Type                m_type{};
 };
 
-class Collisions
+/// Draws all particles of world, one render call for every texture
+class Particles
 {
 public:
-    Collisions() = default;
-
-    Collisions& operator=(const Collisions& collisions2);
+    Particles() = default;
 
-    Collisions(const Collisions& collisions2);
+    Particles(const std::string_view textureAttribureName,
+              const std::string_view moveMatrixUniformName,
+              const om::ProgramId& programId, const om::TextureId& texClouds,
+              const om::TextureId& texExplosion, const om::TextureId& texHit);
 
-    Collisions& operator=(const Collisions&& collisions2);
+    /// Particles outside of view are skipped
+    void draw(om::IEngine& render, const Model::ParticleSystem& particles,
+              Timer::time_point_t nowTime, const ViewRect& view);
 
-    Collisions(const Collisions&& collisions2);
-
-    Collisions(const std::string_view textureAttribureName,
-               const std::string_view moveMatrixUniformName,
-               const om::ProgramId&   programId,
-               const om::TextureId& texExplosion, const om::TextureId& texHit);
-
-    void addCollision(const Model::OutEvent& collision);
-    void addCollisions(const std::list<Model::OutEvent>& collisions);
-    void draw(om::IEngine& render, Timer::time_point_t nowTime);
+    size_t getLastDrawnCount() const { return m_lastDrawnCount; }
 
 private:
-    struct AnimationDescriptor
+    struct Batch
     {
-        Animation2D           animation;
-        Timer::time_point_t   time;
-        om::Vector<2>         pos;
-        om::Vector<2>         size;
-        Model::OutEvent::Type type;
+        std::vector<om::VertexTextured> vertices;
+        std::vector<om::myUint>         indices;
     };
 
-    std::list<AnimationDescriptor> collisionsAnimation;
-    std::vector<Sprite>            m_spritesHit{};
-    std::vector<Sprite>            m_spritesExplosion{};
+    void addToBatch(Batch& batch, const Sprite& sprite,
+                    const Model::ParticleSystem::Particle& particle,
+                    om::myGlfloat                          power);
+
+    std::vector<Sprite> m_spritesTrailCloud{};
+    std::vector<Sprite> m_spritesHit{};
+    std::vector<Sprite> m_spritesExplosion{};
+
+    using Batches = std::array<
+        Batch, static_cast<size_t>(Model::ParticleSystem::Type::maxType)>;
+
+    /// keeps allocated memory between frames, one batch per particle type
+    Batches m_batches{};
+    size_t  m_lastDrawnCount{};
 };
 
 class Rocket
@@ -153,8 +179,7 @@ public:
            const std::string_view moveMatrixUniformName,
            const om::ProgramId& programId, const om::TextureId& texMainCorpus,
            const om::TextureId& texMainEngineFire,
-           const om::TextureId& texSideEngineFire,
-           const om::TextureId& texClouds);
+           const om::TextureId& texSideEngineFire);
 
     void draw(om::IEngine& render, const Model::Rocket& rocket);
 
@@ -162,7 +187,6 @@ public:
     void                 setPos(const om::Vector<2>& pos);
     om::myGlfloat        getAngle() const;
     void                 setAngle(om::myGlfloat angle);
-    void drawClouds(om::IEngine& render, const Model::Rocket& rocket);
 
 protected:
     void drawEngineFire(om::IEngine& render, const Model::Rocket& rocket,
@@ -181,7 +205,6 @@ protected:
     RocketMainCorpus             mainCorpus{};
     EngineFire                   mainEngineFire{};
     std::array<EngineFire, 4>    sideEnginesFire{};
-    Sprite                       trailCloud{};
 };
 
 // class MainBackground
@@ -216,6 +239,16 @@ public:
                     const om::ProgramId& programId, const om::TextureId& tex,
                     om::myGlfloat parallaxCoef);
 
+    /// Nebulas of texture sheet are placed on grid of the same lines and
+    /// columns, which is defaultSizeX x defaultSizeY multiplied by
+    /// 1 / parallaxCoef and is repeated around
+    static constexpr int           sheetLinesCount{ 4 };
+    static constexpr int           sheetColumnsCount{ 4 };
+    static constexpr om::myGlfloat nebulaBaseSize{ 0.7 };
+    static constexpr om::myGlfloat defaultSizeY{ 6.0 };
+    static constexpr om::myGlfloat defaultSizeX{ defaultSizeY *
+                                                 Global::baseScaleXtoY };
+
     om::myGlfloat getAngle() const;
     void          setAngle(om::myGlfloat angle);
 
@@ -240,9 +273,34 @@ private:
     om::myGlfloat                  m_parallaxCoef{ 1.f };
     om::myGlfloat                  sizeY{ defaultSizeY };
     om::myGlfloat                  sizeX{ defaultSizeX };
-    static constexpr om::myGlfloat defaultSizeY{ 6.0 };
-    static constexpr om::myGlfloat defaultSizeX{ defaultSizeY *
-                                                 Global::baseScaleXtoY };
+};
+
+/// Layers of ParallaxNebulas drawn by one screen quad each. Shader finds
+/// nebula of texture sheet by position of fragment in layer, so layer costs
+/// the same for any number of visible nebulas. Software engine doesn't run
+/// shaders, there nebulas are drawn by ParallaxNebulas
+class ParallaxLayers
+{
+public:
+    ParallaxLayers() = default;
+
+    /// Layout of texture sheet is set to program once
+    ParallaxLayers(om::IEngine&               render,
+                   const std::string_view     textureAttribureName,
+                   const std::string_view     moveMatrixUniformName,
+                   const om::ProgramId&       programId,
+                   const om::TextureId&       tex,
+                   std::vector<om::myGlfloat> parallaxCoefs);
+
+    /// Layers are drawn from the farthest one, with one uniform per layer
+    void draw(om::IEngine& render) const;
+
+private:
+    std::string_view           m_textureAttribureName{};
+    std::string_view           m_moveMatrixUniformName{};
+    om::ProgramId              m_programId{};
+    om::TextureId              m_textureId{};
+    std::vector<om::myGlfloat> m_parallaxCoefs{};
 };
 
 } // namespace renderObjects
@@ -5,6 +5,7 @@
 #include "sprite.hpp"
 #include "world.hpp"
 #include <iengine.hpp>
+#include <resource_manager.hpp>
 
 #include <array>
 #include <vector>
@@ -12,12 +13,35 @@
 class RenderWrapper
 {
 public:
+    /// Objects and particles of the last rendered frame
+    struct CullingMetrics
+    {
+        size_t visible{};
+        size_t culled{};
+    };
+
+    enum class ParallaxMode
+    {
+        /// Screen quad per layer, needs engine running shaders
+        layers,
+        /// Sprite per nebula, as drawn by software engine
+        sprites,
+    };
+
+    /// Textures are held by handles of resources for whole game, except
+    /// game over background, which is loaded only after death
     RenderWrapper(om::IEngine&                 engine,
+                  om::ResourceManager&         resources,
                   std::array<om::myGlfloat, 3> color    = { 0, 1, 0 },
-                  om::myGlfloat                gridStep = 0.025);
+                  om::myGlfloat                gridStep = 0.025,
+                  ParallaxMode                 parallax = ParallaxMode::layers);
 
     void render(const Model::World& world);
     void renderGameOver();
+    /// Releases game over background on reset, so it may be evicted
+    void resetGameOver();
+
+    CullingMetrics getCullingMetrics() const { return m_cullingMetrics; }
 
 private:
     bool checkColor(std::array<om::myGlfloat, 3> color);
@@ -30,16 +54,24 @@ private:
 
     om::Vector<2> m_currentShiftRelateToUser{};
 
+    CullingMetrics m_cullingMetrics{};
+    /// Keep allocated memory between frames
+    std::vector<Model::SpatialIndex::Entry> m_cullingCandidates;
+    std::vector<const Model::Rocket*>       m_visibleRockets;
+    std::vector<const Model::Asteroid*>     m_visibleAsteroids;
+
     renderObjects::Rocket         m_rocket;
     renderObjects::PhysicalObject m_planet;
     renderObjects::PhysicalObject m_asteroid;
     renderObjects::PhysicalObject m_bullet;
     renderObjects::Star           m_star;
-    renderObjects::Collisions     m_collisions;
+    renderObjects::Particles      m_particles;
 
     Sprite                         m_backgroundSprite;
     Sprite                         m_backgroundGameOverSprite;
     renderObjects::ParallaxNebulas m_parallaxNebula;
+    renderObjects::ParallaxLayers  m_parallaxLayers;
+    ParallaxMode                   m_parallaxMode;
 
     om::ProgramId m_programIdShaderGrid;
     om::ProgramId m_programIdShaderMorph;
@@ -47,12 +79,12 @@ private:
     om::ProgramId m_programIdTexturedMoved;
     om::ProgramId m_programIdMorphedMoved;
     om::ProgramId m_programIdMoved;
+    om::ProgramId m_programIdParallax;
 
     om::TextureId m_textureIdRocketMainCorpus;
     om::TextureId m_textureIdFireMainEngine;
     om::TextureId m_textureIdFireSideEngine;
     om::TextureId m_textureIdBackground;
-    om::TextureId m_textureIdBackgroundGameOver;
     om::TextureId m_textureIdNebulas;
     om::TextureId m_textureIdTrailCloud;
     om::TextureId m_textureIdExplosion;
@@ -63,10 +95,28 @@ private:
     om::TextureId m_textureIdAsteroid;
     om::TextureId m_textureIdBullet;
 
-    om::IEngine& m_engine;
+    std::vector<om::ResourceManager::Handle> m_textures;
+
+    /// Empty while game goes on
+    om::ResourceManager::Handle m_textureBackgroundGameOver;
+
+    om::IEngine&         m_engine;
+    om::ResourceManager& m_resources;
+
+    static constexpr std::string_view pathToTextureBackgroundGameOver{
+        "res/textures/background_gameover.png"
+    };
 
     static constexpr std::string_view moveMatrixUniformName{ "u_move_matrix" };
 
+    static constexpr om::myGlfloat nebulasParallaxCoef{ 0.33f };
+
+    /// Engines fire is drawn outside of rocket corpus
+    static constexpr Model::worldCalcType rocketCullingScale{ 3 };
+    /// Spatial index is queried with view enlarged by it, so engines fire and
+    /// rotated corners of rockets and asteroids are not lost
+    static constexpr Model::worldCalcType cullingQueryMargin{ 200 };
+
     static const std::vector<std::string_view> textureAttributeNames;
 
     static const std::vector<std::pair<om::myUint, std::string_view>>
@@ -0,0 +1,70 @@
+#pragma once
+#include "world.hpp"
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// One game loop iteration: time passed to World::update and user commands
+struct ReplayFrame
+{
+    Timer::time_point_t       time;
+    Model::World::WorldEvents events;
+};
+
+/// Writes game session to text file: header with getRandom seed, world
+/// initial time and snapshot world was loaded from, then one line per
+/// World::update call
+class ReplayRecorder
+{
+public:
+    /// Empty snapshotPath if world was created new
+    ReplayRecorder(const std::string& path, std::uint32_t randomSeed,
+                   Timer::time_point_t initialTime,
+                   const std::string&  snapshotPath = {});
+
+    void record(Timer::time_point_t              time,
+                const Model::World::WorldEvents& events);
+
+private:
+    std::ofstream m_file;
+};
+
+/// Reads session written by ReplayRecorder and gives it back frame by frame
+class ReplayPlayer
+{
+public:
+    explicit ReplayPlayer(const std::string& path);
+
+    [[nodiscard]] bool  next(ReplayFrame& frame);
+    void                rewind() { m_currentFrame = 0; }
+    std::uint32_t       getRandomSeed() const { return m_randomSeed; }
+    Timer::time_point_t getInitialTime() const { return m_initialTime; }
+    size_t              getFramesCount() const { return m_frames.size(); }
+    const std::string&  getSnapshotPath() const { return m_snapshotPath; }
+
+    /// World of the recorded session start, loaded from the same snapshot if
+    /// session started from it. Throws if snapshot changed since recording
+    Model::World createInitialWorld() const;
+
+    static constexpr std::string_view fileSignature{ "mss-replay" };
+    /// Version 1 has no snapshot line
+    static constexpr int              fileVersion{ 2 };
+
+private:
+    std::uint32_t            m_randomSeed{};
+    Timer::time_point_t      m_initialTime{};
+    std::string              m_snapshotPath;
+    std::uint64_t            m_snapshotHash{};
+    std::vector<ReplayFrame> m_frames;
+    size_t                   m_currentFrame{};
+};
+
+/// Runs recorded session through World::update without engine and prints
+/// timings and final world state. Used as repeatable benchmark. setupWorld
+/// applies the same world options as the recorded session had
+int runHeadlessReplay(
+    ReplayPlayer&                             player,
+    const std::function<void(Model::World&)>& setupWorld = {});
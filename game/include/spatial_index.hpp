@@ -0,0 +1,138 @@
+#pragma once
+#include "world_objects.hpp"
+#include <cstdint>
+#include <limits>
+#include <list>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace Model
+{
+
+/// Uniform grid over rockets, asteroids, planets and stars. Object is kept
+/// in the cell of its center, queries are enlarged by the biggest object
+/// half size. update() moves only objects which changed cell, so it is
+/// cheap when called every frame. Queries test bounding boxes of objects,
+/// the same ones collisions use. Results are written to r_entries of caller
+/// after clearing it, so its memory is reused between frames
+class SpatialIndex
+{
+public:
+    enum class Kind : std::uint8_t
+    {
+        rocket   = 1 << 0,
+        asteroid = 1 << 1,
+        planet   = 1 << 2,
+        star     = 1 << 3
+    };
+
+    using KindMask = std::uint8_t;
+
+    static constexpr KindMask allKinds{ 0xF };
+
+    static constexpr KindMask mask(Kind kind)
+    {
+        return static_cast<KindMask>(kind);
+    }
+
+    struct Entry
+    {
+        const PhysicalObject* object{};
+        Kind                  kind{};
+    };
+
+    struct RaycastHit
+    {
+        Entry entry;
+        /// Distance from segment start to the box of object
+        worldCalcType distance{};
+    };
+
+    explicit SpatialIndex(worldCalcType cellSize = defaultCellSize);
+
+    /// Adds new objects, moves changed ones and removes destroyed ones
+    void update(const std::list<Rocket>&   rockets,
+                const std::list<Asteroid>& asteroids,
+                const std::list<Planet>&   planets,
+                const std::list<Star>&     stars);
+
+    /// Objects intersecting circle
+    void queryRadius(worldCalcType       x,
+                     worldCalcType       y,
+                     worldCalcType       radius,
+                     std::vector<Entry>& r_entries,
+                     KindMask            kinds = allKinds) const;
+    /// Objects intersecting box
+    void queryBox(worldCalcType       minX,
+                  worldCalcType       minY,
+                  worldCalcType       maxX,
+                  worldCalcType       maxY,
+                  std::vector<Entry>& r_entries,
+                  KindMask            kinds = allKinds) const;
+    /// Up to count objects with the nearest centers, nearest first
+    void findNearest(worldCalcType       x,
+                     worldCalcType       y,
+                     size_t              count,
+                     std::vector<Entry>& r_entries,
+                     KindMask            kinds = allKinds,
+                     worldCalcType maxDistance =
+                         std::numeric_limits<worldCalcType>::max()) const;
+    /// The first object crossed by segment, ignore is skipped (usually
+    /// object segment starts from)
+    std::optional<RaycastHit> raycast(worldCalcType x0, worldCalcType y0,
+                                      worldCalcType x1, worldCalcType y1,
+                                      KindMask kinds = allKinds,
+                                      const PhysicalObject* ignore = nullptr)
+        const;
+
+    size_t size() const { return m_records.size(); }
+    /// Objects moved to other cell by the last update
+    size_t getLastMovesCount() const { return m_lastMovesCount; }
+
+    static constexpr worldCalcType defaultCellSize{ 1000 };
+
+private:
+    using CellKey = std::uint64_t;
+
+    struct Candidate
+    {
+        worldCalcType distanceSquared;
+        Entry         entry;
+    };
+
+    struct Record
+    {
+        Kind     kind;
+        CellKey  cell;
+        unsigned generation;
+    };
+
+    std::int32_t toCell(worldCalcType coordinate) const;
+    static CellKey toKey(std::int32_t cellX, std::int32_t cellY);
+    void           add(const PhysicalObject& object, Kind kind);
+    void           removeFromCell(CellKey cell, const PhysicalObject* object);
+
+    /// Calls visitor for entries of cells in range, kinds are filtered
+    template <typename Visitor>
+    void forEachInCells(std::int32_t minCellX, std::int32_t minCellY,
+                        std::int32_t maxCellX, std::int32_t maxCellY,
+                        KindMask kinds, Visitor&& visitor) const;
+
+    worldCalcType                                     m_cellSize;
+    std::unordered_map<CellKey, std::vector<Entry>>   m_cells;
+    std::unordered_map<const PhysicalObject*, Record> m_records;
+    unsigned                                          m_generation{};
+    worldCalcType                                     m_maxHalfSize{};
+    size_t                                            m_lastMovesCount{};
+    /// Range of cells with objects, limits nearest search
+    std::int32_t m_minCellX{};
+    std::int32_t m_minCellY{};
+    std::int32_t m_maxCellX{};
+    std::int32_t m_maxCellY{};
+    /// Scratch of findNearest, keeps memory between calls. So findNearest
+    /// must not be called from several threads at once
+    mutable std::vector<Candidate> m_nearestCandidates;
+};
+
+} // namespace Model
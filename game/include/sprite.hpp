@@ -1,5 +1,6 @@
 #pragma once
 
+#include "affine2.hpp"
 #include "iengine.hpp"
 
 struct Rectangle
@@ -45,6 +46,7 @@ public:
     /// angle of sprite in degrees
     om::myGlfloat getBaseAngle() const;
     void          setBaseAngle(const om::myGlfloat angle);
+    om::Affine2   getBaseRotation() const;
 
     const std::string& getId() const;
     void               setId(std::string_view name);
@@ -71,11 +73,20 @@ private:
     Rectangle        m_spriteCoordinates{};
     om::myGlfloat    m_baseAngle{}; // rad
     om::myGlfloat    m_angle{};     // rad
+    // sine and cosine are computed only when angles change
+    om::myGlfloat    m_baseAngleSin{};
+    om::myGlfloat    m_baseAngleCos{ 1 };
+    om::myGlfloat    m_angleSin{};
+    om::myGlfloat    m_angleCos{ 1 };
     om::Color        m_mixColor{ defaultColor };
 
     static constexpr om::Color defaultColor{ 1.f, 1.f, 1.f, 1.f };
 };
 
+/// Compares composition of sprite transform and transform of its corners by
+/// Matrix<3, 3> and by Affine2 and prints results
+int runSpriteTransformBenchmark();
+
 inline bool operator==(const Rectangle& l, const Rectangle& r)
 {
     return l.pos == r.pos && l.size == r.size;
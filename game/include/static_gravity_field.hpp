@@ -0,0 +1,109 @@
+#pragma once
+#include "world_objects.hpp"
+#include <array>
+#include <list>
+#include <vector>
+
+namespace Model
+{
+
+/// Precomputed gravity acceleration of static attractors (stars never move).
+/// Around every star there are nested square levels with the same nodes
+/// count, each next level covers twice bigger area, so grid is finer near
+/// stars where field changes faster. Nodes keep sum of accelerations of all
+/// stars multiplied by cubed distance to level star: part of that star is
+/// linear and is interpolated without error, only far stars add error.
+/// Lookup is one bilinear interpolation for any stars count. Points near
+/// star (inner radius) and outside of the coarsest level are calculated
+/// exactly
+class StaticGravityField
+{
+public:
+    using Acceleration = std::array<worldCalcType, 2>;
+
+    struct Config
+    {
+        /// Max error of interpolated acceleration (see calcRelativeError),
+        /// checked on build
+        worldCalcType maxRelativeError{ 1e-3 };
+        /// Exact calculation around star, should be bigger than star radius
+        /// plus radius of the biggest attracted object
+        worldCalcType innerRadius{ 1000 };
+        /// Half size of level i is innerRadius * 2^(i + 1)
+        size_t levelsCount{ 8 };
+        /// Cells per level side start value, it is doubled until error fits
+        size_t cellsPerSide{ 8 };
+        size_t maxCellsPerSide{ 512 };
+    };
+
+    StaticGravityField() = default;
+    /// Throws std::runtime_error if error bound is not reached with
+    /// maxCellsPerSide
+    StaticGravityField(const std::list<Star>& stars, const Config& config);
+
+    bool empty() const { return m_attractors.empty(); }
+
+    /// Acceleration of object with radius r in point (x, y)
+    Acceleration calcAcceleration(worldCalcType x, worldCalcType y,
+                                  worldCalcType r) const;
+    /// Sum over all stars without grid, same math as World uses for planets
+    Acceleration calcExactAcceleration(worldCalcType x, worldCalcType y,
+                                       worldCalcType r) const;
+
+    /// Error of value in point (x, y) relative to sum of accelerations
+    /// lengths of all stars, so stars pulling in opposite directions don't
+    /// make it infinite
+    worldCalcType calcRelativeError(worldCalcType x, worldCalcType y,
+                                    worldCalcType       r,
+                                    const Acceleration& value) const;
+
+    /// Error measured in cells centers on build
+    worldCalcType getMaxRelativeError() const { return m_maxRelativeError; }
+    size_t        getCellsPerSide() const { return m_cellsPerSide; }
+    /// Half size of the coarsest level
+    worldCalcType getOuterHalfSize() const;
+
+private:
+    struct Attractor
+    {
+        worldCalcType x;
+        worldCalcType y;
+        worldCalcType m;
+        worldCalcType r;
+    };
+
+    struct Level
+    {
+        worldCalcType             originX;
+        worldCalcType             originY;
+        worldCalcType             cellSize;
+        size_t                    attractorIndex;
+        std::vector<Acceleration> nodes; // (cells + 1)^2, line by line
+    };
+
+    void build(size_t cellsPerSide);
+    /// Finest level containing point, nullptr if point should be calculated
+    /// exactly
+    const Level* findLevel(worldCalcType x, worldCalcType y,
+                           worldCalcType r) const;
+    Acceleration interpolate(const Level& level, worldCalcType x,
+                             worldCalcType y) const;
+    Acceleration calcScaledAcceleration(const Attractor& owner,
+                                        worldCalcType x, worldCalcType y) const;
+    worldCalcType measureMaxRelativeError() const;
+
+    Config                 m_config;
+    std::vector<Attractor> m_attractors;
+    /// Levels of star i are [i * levelsCount, (i + 1) * levelsCount), from
+    /// fine to coarse
+    std::vector<Level> m_levels;
+    size_t             m_cellsPerSide{};
+    worldCalcType      m_maxRelativeError{};
+};
+
+/// Compares cost and error of exact stars gravity and StaticGravityField on
+/// random points of game area and prints results
+int runGravityFieldBenchmark(const std::list<Star>&            stars,
+                             const StaticGravityField::Config& config);
+
+} // namespace Model
@@ -0,0 +1,154 @@
+#pragma once
+#include "kepler_orbit.hpp"
+#include "utilities.hpp"
+#include "world_physics.hpp"
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace Model
+{
+
+class World;
+
+/// Ballistic path of user ship (engines off) predicted on worker thread.
+/// update() copies ship and attractors state only when prediction becomes
+/// wrong: engines thrust changed or ship went away from predicted path.
+/// Otherwise worker continues from the end of existing path, so only the
+/// new part of horizon is integrated
+class TrajectoryPredictor
+{
+public:
+    using seconds_t      = Timer::seconds_t;
+    using milliseconds_t = Timer::milliseconds_t;
+    using time_point_t   = Timer::time_point_t;
+
+    struct Config
+    {
+        /// World time predicted ahead of the current one
+        seconds_t horizon{ 60 };
+        seconds_t step{ milliseconds_t{ 10 } };
+        /// Distance in time between polyline points
+        seconds_t samplePeriod{ 0.25 };
+        /// Worker publishes unfinished path after this real time and
+        /// continues it in the next job
+        seconds_t timeBudget{ milliseconds_t{ 2 } };
+        /// Path is recalculated if ship is farther than this from it
+        worldCalcType maxDeviation{ 50 };
+    };
+
+    struct Point
+    {
+        time_point_t  time;
+        worldCalcType x{};
+        worldCalcType y{};
+    };
+
+    struct Trajectory
+    {
+        std::vector<Point> points;
+        /// World time of ship state the path was calculated from
+        time_point_t baseTime{};
+
+        /// Linear interpolation between points, nullopt outside of path
+        std::optional<std::array<worldCalcType, 2>> getPosition(
+            time_point_t time) const;
+    };
+
+    struct Metrics
+    {
+        size_t fullRecalculations{};
+        size_t extensions{};
+        /// Jobs stopped by time budget
+        size_t    budgetExceededCount{};
+        seconds_t lastJobTime{};
+        seconds_t maxJobTime{};
+        /// World time since the last full recalculation
+        seconds_t staleness{};
+        /// Real time since path was published
+        seconds_t publishAge{};
+        /// Predicted world time ahead of the current one, less than horizon
+        /// if worker is late
+        seconds_t coverage{};
+    };
+
+    explicit TrajectoryPredictor(const Config& config);
+    ~TrajectoryPredictor();
+
+    TrajectoryPredictor(const TrajectoryPredictor&) = delete;
+    TrajectoryPredictor& operator=(const TrajectoryPredictor&) = delete;
+
+    /// Called after world update, never waits for worker
+    void update(const World& world);
+
+    /// The last published path, never null
+    std::shared_ptr<const Trajectory> getTrajectory() const;
+    Metrics                           getMetrics() const;
+
+private:
+    struct Body
+    {
+        worldCalcType x{};
+        worldCalcType y{};
+        worldCalcType vx{};
+        worldCalcType vy{};
+        worldCalcType m{};
+        worldCalcType r{};
+        worldCalcType k1{};
+        worldCalcType k2{};
+        /// Planets on rails are moved by orbit
+        std::optional<KeplerOrbit> orbit;
+    };
+
+    struct State
+    {
+        time_point_t      time{};
+        Body              ship;
+        std::vector<Body> planets;
+        std::vector<Body> stars;
+        /// Scratch of step, sized with planets, so steps don't allocate
+        std::vector<std::array<worldCalcType, 2>> planetsAccelerations;
+    };
+
+    struct Job
+    {
+        /// Set for full recalculation, otherwise path is extended
+        std::optional<State> state;
+        time_point_t         nowTime{};
+    };
+
+    void run();
+    void processJob(Job& job);
+    void step(State& state) const;
+    void publish(time_point_t nowTime, bool isFull, seconds_t jobTime,
+                 bool isBudgetExceeded);
+
+    const Config m_config;
+
+    mutable std::mutex                m_mutex;
+    std::condition_variable           m_jobAdded;
+    std::optional<Job>                m_pendingJob;
+    bool                              m_isStopping{};
+    std::shared_ptr<const Trajectory> m_trajectory;
+    Metrics                           m_metrics;
+    Timer::clock_t::time_point        m_publishTime{ Timer::clock_t::now() };
+
+    /// Main thread only
+    std::array<worldCalcType, 5> m_lastThrust{};
+    time_point_t                 m_lastNowTime{};
+
+    /// Worker only
+    State             m_tailState;
+    std::deque<Point> m_points;
+    time_point_t      m_baseTime{};
+    bool              m_isCalculated{};
+
+    std::thread m_worker;
+};
+
+} // namespace Model
@@ -1,6 +1,7 @@
 #pragma once
 #include <chrono>
 #include <cmath>
+#include <cstdint>
 
 class Timer
 {
@@ -37,3 +38,7 @@ bool almostEqual(T p1, T p2)
 }
 
 int getRandom(int lowRange, int highRange);
+
+/// Reseeds getRandom generator. Used to reproduce recorded game sessions
+void          setRandomSeed(std::uint32_t seed);
+std::uint32_t getRandomSeed();
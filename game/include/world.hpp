@@ -1,4 +1,7 @@
 #pragma once
+#include "bullet_pool.hpp"
+#include "spatial_index.hpp"
+#include "static_gravity_field.hpp"
 #include "utilities.hpp"
 #include "world_objects.hpp"
 #include "world_physics.hpp"
@@ -43,6 +46,8 @@ public:
         userCommandShipRotateLeft,
         userCommandShipRotateRight,
         userCommandShipAttack,
+        /// Parameter 0 is time warp factor
+        userCommandTimeWarp,
         maxType,
     };
 
@@ -58,6 +63,32 @@ public:
 
     [[nodiscard]] bool update(time_point_t nowTime, const WorldEvents& events);
 
+    /// Stars gravity is taken from precomputed grid instead of exact sum.
+    /// Throws std::runtime_error if error bound can't be reached
+    void enableStarsGravityField(const StaticGravityField::Config& config);
+
+    /// Planets pulled by other planets less than maxPerturbationRatio of
+    /// the strongest star gravity are moved along Kepler orbits around it.
+    /// They go back to integration when perturbation becomes bigger.
+    /// Zero disables on rails mode
+    void setPlanetsOnRails(worldCalcType maxPerturbationRatio);
+
+    static constexpr worldCalcType maxTimeWarp{ 1000 };
+    /// Warp is dropped if user ship comes closer than this to surface of
+    /// planet, star or asteroid
+    static constexpr worldCalcType timeWarpSafeDistance{ 500 };
+
+    /// World time goes factor times faster than time passed to update.
+    /// Factor is clamped to [1, maxTimeWarp]. Returns false and stays at 1
+    /// if user ship is near some body
+    bool          setTimeWarp(worldCalcType factor);
+    worldCalcType getTimeWarp() const { return timeWarp; }
+
+    /// Radius, box, nearest and raycast queries over rockets, asteroids,
+    /// planets and stars. Index is updated at the end of update, so it is
+    /// valid between updates
+    const SpatialIndex& getSpatialIndex() const { return spatialIndex; }
+
     /// TODO change to other container
     std::list<Rocket> rockets;
 
@@ -69,18 +100,62 @@ public:
 
     std::list<Asteroid> asteroids;
 
-    std::list<Bullet> bullets;
+    BulletPool bullets;
 
-    std::list<OutEvent> outEvents;
+    /// Capacity is kept after clear, so events don't allocate every frame
+    std::vector<OutEvent> outEvents;
+
+    ParticleSystem particles;
 
     time_point_t lastUpdateTime;
     seconds_t    dt{ milliseconds_t{ 4 } };
 
+    time_point_t lastAsteroidSpawnTime;
+
     friend std::ostream& operator<<(std::ostream& out, const World& world);
 
     bool gameOver{};
 
 private:
+    friend WorldSnapshot;
+
+    /// Empty world, filled by WorldSnapshot::load
+    World() = default;
+
+    /// Empty if stars gravity is summed exactly
+    StaticGravityField starsGravityField;
+
+    SpatialIndex spatialIndex;
+
+    static constexpr seconds_t railsCheckPeriod{ 0.25 };
+
+    worldCalcType planetsRailsMaxPerturbation{};
+    time_point_t  lastRailsCheckTime{};
+
+    /// How world is stepped for time warp factor
+    struct TimeWarpStrategy
+    {
+        /// Step is dt * stepScale
+        worldCalcType              stepScale{ 1 };
+        size_t                     stepsPerCollisionCheck{ 1 };
+        PhysicalObject::Integrator integrator{
+            PhysicalObject::Integrator::trapezoidal
+        };
+        /// On rails ratio used if it is bigger than planets one
+        worldCalcType railsMaxPerturbation{};
+    };
+
+    static TimeWarpStrategy getTimeWarpStrategy(worldCalcType factor);
+
+    worldCalcType    timeWarp{ 1 };
+    TimeWarpStrategy timeWarpStrategy;
+    /// Time passed to the last update and world time to step to
+    time_point_t lastInputTime;
+    time_point_t targetTime;
+    size_t       stepsSinceCollisionCheck{};
+    /// Zero if objects are checked in their current positions only
+    seconds_t collisionSweepTime{};
+
     void                         enemiesForward();
     void                         getUserRocketEvents(const WorldEvents& events);
     std::array<worldCalcType, 2> calcSumGravityForceToObject(
@@ -91,10 +166,15 @@ private:
     void detectCollisionsRockets();
     void detectCollisionsAsteroids();
     void detectCollisionsPlanets();
-    bool checkCollision(const Bullet& obj1, const Planet& obj2);
-    bool checkCollision(const Bullet& obj1, const Star& obj2);
+    bool checkCollision(const Bullet& obj1, const PhysicalObject& obj2,
+                        OutEvent::Type collisionType);
     bool checkCollision(const PhysicalObject& obj1, const PhysicalObject& obj2);
     void asteroidFunRandomizer();
+    worldCalcType getPlanetsRailsMaxPerturbation() const;
+    void          updatePlanetsRails(worldCalcType maxPerturbationRatio);
+    bool          isUserShipNearBody(const TimeWarpStrategy& strategy) const;
+    void emitCollisionParticles();
+    void updateSpatialIndex();
 };
 
 } // namespace Model
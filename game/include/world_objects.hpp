@@ -1,13 +1,17 @@
 #pragma once
+#include "kepler_orbit.hpp"
+#include "particle_system.hpp"
 #include "utilities.hpp"
 #include "world_physics.hpp"
 #include <array>
-#include <deque>
+#include <bitset>
+#include <initializer_list>
 #include <iosfwd>
-#include <unordered_set>
 
 namespace Model
 {
+class WorldSnapshot;
+
 class WorldObjectState
 {
 public:
@@ -33,6 +37,8 @@ public:
     }
 
 private:
+    friend WorldSnapshot;
+
     bool                m_state{};
     Timer::time_point_t m_changeStatetime{ Timer::clock_t::duration::max() };
     Timer::time_point_t m_currentTime{};
@@ -89,13 +95,23 @@ public:
 
     void teleportationHack(worldCalcType newX, worldCalcType newY);
 
-    virtual void update(seconds_t dt);
+    /// Trapezoidal moves with mean of old and new speed. Symplectic Euler
+    /// moves with new speed, it keeps orbit energy bounded on big steps
+    enum class Integrator
+    {
+        trapezoidal,
+        symplecticEuler
+    };
+
+    virtual void update(seconds_t dt, Integrator integrator);
 
     virtual void applyExternalForce(worldCalcType externalForceX,
                                     worldCalcType externalForceY,
                                     worldCalcType forceMoment);
 
 protected:
+    friend WorldSnapshot;
+
     seconds_t getDurationSinceLastUpdate() const
     {
         return std::chrono::duration_cast<seconds_t>(
@@ -127,49 +143,46 @@ public:
     worldCalcType       enginePercentThrust{ 100 };
 
 private:
+    friend WorldSnapshot;
+
     WorldObjectState m_engineState{};
     worldCalcType    m_engineHealth{ 100 };
 };
 
+/// Trail clouds are emitted by rockets into ParticleSystem
 struct TrailCloud
 {
-    worldCalcType                     x{};
-    worldCalcType                     y{};
-    worldCalcType                     angle{};
-    worldCalcType                     initPower{};
-    Timer::time_point_t               initialTime;
-    Timer::time_point_t               lastUpdateTime;
-    worldCalcType                     width{};
-    worldCalcType                     height{};
     static constexpr worldCalcType    widthDefault{ 45 };
     static constexpr worldCalcType    heightDefault{ 45 };
-    static constexpr Timer::seconds_t timeToLive{ 3.0 };
-    worldCalcType                     getCurrentPower() const;
+    static constexpr Timer::seconds_t timeToLive{
+        ParticleSystem::trailCloudTimeToLive
+    };
 };
 
-class Bullet : public PhysicalObject
+/// Bullet is not affected by forces, so it keeps only fields of linear
+/// motion and is stored in BulletPool
+struct Bullet
 {
-public:
-    Bullet()
-        : PhysicalObject(0.0, bulletDefaultSize, 0.0, bulletDefaultWidth,
-                         bulletDefaultHeight)
-    {
-    }
-
-    ~Bullet() override {}
-
-    bool isAlive(time_point_t nowTime) const
+    bool isAlive(Timer::time_point_t nowTime) const
     {
         auto dif = nowTime - creatingTime;
         return dif <= timeToLive;
     }
+    worldCalcType                     x{};
+    worldCalcType                     y{};
+    worldCalcType                     vx{};
+    worldCalcType                     vy{};
+    worldCalcType                     angle{};
     Timer::time_point_t               creatingTime;
+    bool                              isDestroyed{};
     static constexpr Timer::seconds_t timeToLive{ 3.0 };
     static constexpr worldCalcType    bulletDefaultSize{ 40.0 };
     static constexpr worldCalcType    bulletDefaultHeight{ bulletDefaultSize };
     static constexpr worldCalcType    bulletDefaultWidth{ bulletDefaultHeight /
                                                        4 };
     static constexpr worldCalcType    bulletRelativeSpeed{ 750.0 };
+    static constexpr worldCalcType    width{ bulletDefaultWidth };
+    static constexpr worldCalcType    height{ bulletDefaultHeight };
 };
 
 class Rocket : public PhysicalObject
@@ -181,6 +194,8 @@ public:
         commandRotateLeft,
         commandRotateRight
     };
+    static constexpr size_t eventsCount{ 3 };
+
     Rocket(worldCalcType in_m = defaultM, worldCalcType in_r = defaultR,
            worldCalcType in_c = defaultC, worldCalcType in_width = defaultWidth,
            worldCalcType in_height              = defaultHeight,
@@ -189,11 +204,32 @@ public:
 
     ~Rocket() override {}
 
-    using RocketEvents = std::unordered_set<Rocket::Events>;
+    /// Set of events without heap allocation, they are set every step
+    class RocketEvents
+    {
+    public:
+        RocketEvents() = default;
+        RocketEvents(std::initializer_list<Events> events)
+        {
+            for (const auto event : events)
+            {
+                insert(event);
+            }
+        }
+
+        void insert(Events event) { m_events.set(static_cast<size_t>(event)); }
+        bool contains(Events event) const
+        {
+            return m_events.test(static_cast<size_t>(event));
+        }
+
+    private:
+        std::bitset<eventsCount> m_events;
+    };
 
     void setEvents(const RocketEvents& newEvents);
 
-    void update(seconds_t dt) override;
+    void update(seconds_t dt, Integrator integrator) override;
     void applyExternalForce(worldCalcType externalForceX,
                             worldCalcType externalForceY,
                             worldCalcType externalForceMoment) override;
@@ -211,7 +247,6 @@ public:
                                                { sideEngineDefaultThrust },
                                                { sideEngineDefaultThrust },
                                                { sideEngineDefaultThrust } } };
-    std::deque<TrailCloud>         clouds{};
     static constexpr worldCalcType defaultWidth{ 60 };
     static constexpr worldCalcType defaultHeight{ defaultWidth * 2 };
     static constexpr worldCalcType mainEngineDefaultThrust{ 5000 };
@@ -220,12 +255,14 @@ public:
     static constexpr worldCalcType defaultR{ 0.3 };
     static constexpr worldCalcType defaultC{ 0.4 };
     Bullet                         getBullet();
+    void emitClouds(ParticleSystem& particles);
 
 private:
+    friend WorldSnapshot;
+
     RocketEvents                   events;
     static constexpr worldCalcType stabilizationAccuracy{ 0.003 };
 
-    void         handleClouds(time_point_t lastUpdateTime);
     void         handleEvents(const RocketEvents& events);
     time_point_t lastTimeClouds{};
     time_point_t lastTimeWeapon{};
@@ -257,6 +294,12 @@ public:
 
     ~Planet() override {}
 
+    /// Moves planet along orbit instead of integration
+    void moveOnRails(time_point_t worldTime, seconds_t dt);
+
+    /// Set while planet is on rails
+    std::optional<KeplerOrbit> orbit;
+
     static constexpr worldCalcType defaultR{ 250 };
     static constexpr worldCalcType defaultWidth{ defaultR };
     static constexpr worldCalcType defaultHeight{ defaultR };
@@ -0,0 +1,136 @@
+#pragma once
+#include "world.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <string>
+#include <vector>
+
+namespace Model
+{
+
+/// Binary snapshot of World. File is little-endian with fixed layout:
+/// Header, then arrays of RocketRecord, BodyRecord for stars, planets and
+/// asteroids, BulletRecord and ParticleRecord in that order. All records are
+/// 8 bytes aligned, so mapped file is used in place without parsing.
+/// Times are stored as nanoseconds since world clock epoch.
+class WorldSnapshot
+{
+public:
+    using Buffer = std::vector<std::byte>;
+
+    struct Header
+    {
+        char          signature[8];
+        std::uint32_t version;
+        std::uint32_t byteOrderMark;
+        std::int64_t  lastUpdateTime;
+        std::int64_t  lastAsteroidSpawnTime;
+        std::int64_t  dt;
+        std::uint32_t rocketsCount;
+        std::uint32_t starsCount;
+        std::uint32_t planetsCount;
+        std::uint32_t asteroidsCount;
+        std::uint32_t bulletsCount;
+        std::uint32_t particlesCount;
+        std::uint32_t userRocketIndex;
+        std::uint32_t reserved;
+    };
+
+    struct BodyRecord
+    {
+        double       x;
+        double       y;
+        double       width;
+        double       height;
+        double       vx;
+        double       vy;
+        double       ax;
+        double       ay;
+        double       angle;
+        double       angleSpeed;
+        double       angleAcceleration;
+        double       forceX;
+        double       forceY;
+        double       forceMoment;
+        double       m;
+        double       r;
+        double       c;
+        std::int64_t lastUpdateTime;
+    };
+
+    struct EngineRecord
+    {
+        double        engineMaxForce;
+        double        enginePercentThrust;
+        double        engineHealth;
+        std::int64_t  changeStateTime;
+        std::int64_t  currentTime;
+        std::uint32_t state;
+        std::uint32_t reserved;
+    };
+
+    struct RocketRecord
+    {
+        BodyRecord    body;
+        EngineRecord  mainEngine;
+        EngineRecord  sideEngines[4];
+        std::int64_t  lastTimeClouds;
+        std::int64_t  lastTimeWeapon;
+        std::uint32_t reserved;
+        std::uint8_t  stabilizationLevel1Enabled;
+        std::uint8_t  stabilizationLevel2Enabled;
+        std::uint16_t reserved2;
+    };
+
+    struct BulletRecord
+    {
+        double       x;
+        double       y;
+        double       vx;
+        double       vy;
+        double       angle;
+        std::int64_t creatingTime;
+    };
+
+    struct ParticleRecord
+    {
+        double        x;
+        double        y;
+        double        angle;
+        double        width;
+        double        height;
+        double        initPower;
+        std::int64_t  spawnTime;
+        double        timeToLive;
+        std::uint32_t type;
+        std::uint32_t reserved;
+    };
+
+    static constexpr char          signature[8]{ 'M', 'S', 'S', 'W',
+                                        'O', 'R', 'L', 'D' };
+    static constexpr std::uint32_t version{ 3 };
+    static constexpr std::uint32_t byteOrderMark{ 0x01020304 };
+
+    /// Copies world state to flat buffer with file layout
+    static Buffer serialize(const World& world);
+
+    static bool save(const World& world, const std::string& path);
+    /// Copies world state on calling thread and writes it from background one
+    static std::future<bool> saveAsync(const World& world, std::string path);
+
+    /// Maps file and builds world from it. All times are shifted so world
+    /// continues from initialTime. Throws std::runtime_error on bad file
+    static World load(const std::string& path, Timer::time_point_t initialTime);
+
+private:
+    static bool writeBuffer(const Buffer& buffer, const std::string& path);
+    static BodyRecord   toRecord(const PhysicalObject& object);
+    static EngineRecord toRecord(const RocketEngine& engine);
+    static void restore(PhysicalObject& object, const BodyRecord& record,
+                        std::int64_t timeShift);
+    static void restore(RocketEngine& engine, const EngineRecord& record,
+                        std::int64_t timeShift);
+};
+
+} // namespace Model
@@ -0,0 +1,24 @@
+#ifdef GL_ES
+precision highp float;
+#endif
+
+in vec4 v_color;
+in vec2 v_layer_position;
+layout(location = 0) out vec4 fragColor;
+
+uniform sampler2D s_texture;
+// xy - size of nebula in cells, zw - columns and lines of texture sheet
+uniform vec4 u_sheet;
+
+void main()
+{
+    // nebula is in center of cell, space around it is transparent
+    vec2 cell = floor(v_layer_position);
+    vec2 in_nebula = (v_layer_position - cell - 0.5) / u_sheet.xy + 0.5;
+    vec2 is_inside = step(vec2(0.0), in_nebula) * step(in_nebula, vec2(1.0));
+    // layer repeats the sheet, its lines are counted from top
+    vec2 sheet_cell = mod(cell, u_sheet.zw);
+    sheet_cell.y = u_sheet.w - 1.0 - sheet_cell.y;
+    vec4 color = texture(s_texture, (sheet_cell + in_nebula) / u_sheet.zw);
+    fragColor = color * v_color * is_inside.x * is_inside.y;
+}
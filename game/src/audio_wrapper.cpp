@@ -1,38 +1,48 @@
 #include "audio_wrapper.hpp"
 #include "global.hpp"
+#include "trace.hpp"
 #include <algorithm>
+#include <functional>
 #include <stdexcept>
 
-AudioWrapper::AudioWrapper(om::IEngine& engine)
+AudioWrapper::AudioWrapper(om::IEngine& engine, om::ResourceManager& resources)
     : userRocket{}
     , m_engine{ engine }
+    , m_resources{ resources }
 {
     addAllTracks();
 }
 
 void AudioWrapper::addAllTracks()
 {
-    m_soundTrackBackground = m_engine.addSoundTrack(pathToSoundTrackBackground);
+    const auto addSoundTrack = [this](std::string_view path) {
+        m_soundTracks.push_back(m_resources.acquireSoundTrack(path));
+        return m_resources.getSoundTrack(m_soundTracks.back());
+    };
+
+    m_soundTrackBackground  = addSoundTrack(pathToSoundTrackBackground);
     m_soundBufferBackground = m_engine.addSoundBuffer(m_soundTrackBackground);
     m_soundBufferBackground->setVolume(backgroundVolume);
 
-    m_soundTrackBackgroundGameOver =
-        m_engine.addSoundTrack(pathToSoundTrackBackgroundGameOver);
-    m_soundBufferBackgroundGameOver =
-        m_engine.addSoundBuffer(m_soundTrackBackgroundGameOver);
-    m_soundBufferBackgroundGameOver->setVolume(backgroundVolume);
-
-    m_soundTrackUserRocket = m_engine.addSoundTrack(pathToSoundTrackUserRocket);
+    m_soundTrackUserRocket  = addSoundTrack(pathToSoundTrackUserRocket);
     m_soundBufferUserRocket = m_engine.addSoundBuffer(m_soundTrackUserRocket);
 
-    m_soundTrackEnemyRocket =
-        m_engine.addSoundTrack(pathToSoundTrackEnemyRocket);
+    m_soundTrackEnemyRocket = addSoundTrack(pathToSoundTrackEnemyRocket);
 
-    m_soundTrackExplosion = m_engine.addSoundTrack(pathToSoundTrackExplosion);
+    m_soundTrackExplosion = addSoundTrack(pathToSoundTrackExplosion);
+    m_soundTrackHit       = addSoundTrack(pathToSoundTrackHit);
+    m_soundTrackShoot     = addSoundTrack(pathToSoundTrackShoot);
+}
 
-    m_soundTrackHit       = m_engine.addSoundTrack(pathToSoundTrackHit);
-    m_soundTrackExplosion = m_engine.addSoundTrack(pathToSoundTrackExplosion);
-    m_soundTrackShoot     = m_engine.addSoundTrack(pathToSoundTrackShoot);
+void AudioWrapper::stopGameOver()
+{
+    if (m_soundBufferBackgroundGameOver != nullptr)
+    {
+        // buffer is erased before its track may be evicted
+        m_engine.eraseSoundBuffer(m_soundBufferBackgroundGameOver);
+        m_soundBufferBackgroundGameOver = nullptr;
+        m_soundTrackBackgroundGameOver.reset();
+    }
 }
 
 void AudioWrapper::playBackground() {}
@@ -144,7 +154,7 @@ void playOneShip(RocketAudio&  rocketAudio,
 
     const auto distance = std::sqrt(distance2);
 
-    const auto maxHearableDistance = 2000.f;
+    const auto maxHearableDistance = AudioWrapper::rocketsHearableDistance;
 
     auto engineDistanceKoef = std::pow(
         1.f - std::min(distance, maxHearableDistance) / maxHearableDistance, 2);
@@ -244,17 +254,47 @@ void AudioWrapper::playOneEvent(const Model::OutEvent& event,
 
 void AudioWrapper::play(const Model::World& world)
 {
+    OM_TRACE_SCOPE("AudioWrapper::play");
     if (userRocketAudio.rocketPtr == nullptr)
     {
-        m_soundBufferBackgroundGameOver->stop();
+        stopGameOver();
         m_soundBufferBackground->play(om::ISoundBuffer::properties::looped);
     }
 
     checkRocketAudioConfig(world);
     playOneShip(userRocketAudio, AudioWrapper::userRocketsVolume);
+
+    using Model::SpatialIndex;
+    const auto userWorldPos    = Global::getUserWorldPosition();
+    world.getSpatialIndex().queryRadius(
+        userWorldPos[0], userWorldPos[1], rocketsHearableDistance,
+        m_hearableRockets, SpatialIndex::mask(SpatialIndex::Kind::rocket));
+    // sorted once, so every rocket is found by binary search
+    const auto isLess = [](const SpatialIndex::Entry&  entry,
+                           const Model::PhysicalObject* object) {
+        return std::less<const Model::PhysicalObject*>{}(entry.object, object);
+    };
+    std::sort(m_hearableRockets.begin(), m_hearableRockets.end(),
+              [&isLess](const SpatialIndex::Entry& first,
+                        const SpatialIndex::Entry& second) {
+                  return isLess(first, second.object);
+              });
     for (auto& audioRocket : rocketAudios)
     {
-        playOneShip(audioRocket, AudioWrapper::enemiesRocketsVolume);
+        const auto hearableIt =
+            std::lower_bound(m_hearableRockets.begin(), m_hearableRockets.end(),
+                             audioRocket.rocketPtr, isLess);
+        const auto isHearable = hearableIt != m_hearableRockets.end() &&
+                                hearableIt->object == audioRocket.rocketPtr;
+        if (isHearable)
+        {
+            playOneShip(audioRocket, AudioWrapper::enemiesRocketsVolume);
+        }
+        else if (audioRocket.isEnable)
+        {
+            audioRocket.isEnable = false;
+            audioRocket.audioBuffer->stop();
+        }
     }
 
     for (const auto& event : world.outEvents)
@@ -275,6 +315,11 @@ void AudioWrapper::playGameOver()
             rocketAudios.begin(), rocketAudios.end(),
             [](RocketAudio& rocketAudio) { rocketAudio.audioBuffer->stop(); });
         rocketAudios.clear();
+        m_soundTrackBackgroundGameOver =
+            m_resources.acquireSoundTrack(pathToSoundTrackBackgroundGameOver);
+        m_soundBufferBackgroundGameOver = m_engine.addSoundBuffer(
+            m_resources.getSoundTrack(m_soundTrackBackgroundGameOver));
+        m_soundBufferBackgroundGameOver->setVolume(backgroundVolume);
         m_soundBufferBackgroundGameOver->play(
             om::ISoundBuffer::properties::looped);
     }
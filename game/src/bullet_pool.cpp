@@ -0,0 +1,57 @@
+#include "bullet_pool.hpp"
+#include <algorithm>
+
+namespace Model
+{
+
+bool BulletPool::push(const Bullet& bullet)
+{
+    if (m_count == capacity)
+    {
+        return false;
+    }
+    m_bullets[(m_tail + m_count) & indexMask] = bullet;
+    ++m_count;
+    ++m_aliveCount;
+    return true;
+}
+
+static void moveBullets(Bullet* first, Bullet* last, worldCalcType dt)
+{
+    for (; first != last; ++first)
+    {
+        first->x += first->vx * dt;
+        first->y += first->vy * dt;
+    }
+}
+
+void BulletPool::update(seconds_t dt)
+{
+    const auto dtCount    = static_cast<worldCalcType>(dt.count());
+    const auto firstCount = std::min(m_count, capacity - m_tail);
+
+    moveBullets(m_bullets.data() + m_tail,
+                m_bullets.data() + m_tail + firstCount, dtCount);
+    moveBullets(m_bullets.data(), m_bullets.data() + (m_count - firstCount),
+                dtCount);
+}
+
+void BulletPool::removeExpired(time_point_t nowTime)
+{
+    while (m_count != 0)
+    {
+        const auto& bullet = m_bullets[m_tail];
+        if (!bullet.isDestroyed)
+        {
+            if (bullet.isAlive(nowTime))
+            {
+                break;
+            }
+            --m_aliveCount;
+        }
+        m_tail = (m_tail + 1) & indexMask;
+        --m_count;
+    }
+}
+
+} // namespace Model
@@ -1,5 +1,6 @@
 #include "environement.hpp"
 #include <iostream>
+#include <logger.hpp>
 #include <memory>
 #include <sstream>
 
@@ -15,6 +16,7 @@ bool Environement::input(om::IEngine&                engine,
                          Model::World::WorldEvents*& retWorldEvents,
                          eventSet&                   environementEvents)
 {
+    OM_TRACE_SCOPE("Environement::input");
     using namespace Model;
     static auto worldEvents{ std::make_unique<Model::World::WorldEvents>(
         static_cast<size_t>(Model::World::Events::maxType)) };
@@ -31,9 +33,7 @@ bool Environement::input(om::IEngine&                engine,
     om::Event event;
     while (engine.read_input(event))
     {
-#ifdef DEBUG_CONFIGURATION
-        std::cout << event.type << std::endl;
-#endif
+        OM_LOG(debug, input, event.type);
         switch (event.type)
         {
             case om::EventType::turn_off:
@@ -103,6 +103,9 @@ bool Environement::input(om::IEngine&                engine,
             case om::EventType::start_pressed:
                 environementEvents.insert(event);
                 break;
+            case om::EventType::button3_pressed:
+                environementEvents.insert(event);
+                break;
             default:
                 break;
         }
@@ -110,10 +113,22 @@ bool Environement::input(om::IEngine&                engine,
     return true;
 }
 
+void Environement::writeTrace()
+{
+    if (!om::Trace::isEnabled)
+    {
+        std::clog << "Trace isn't recorded, build with OM_TRACING option"
+                  << std::endl;
+        return;
+    }
+    std::ostringstream path;
+    path << "trace_" << m_tracesCount++ << ".json";
+    om::Trace::writeChromeJson(path.str());
+}
+
 bool Environement::handleEnvironementEvents(
     [[maybe_unused]] om::IEngine& engine, eventSet envEvents)
 {
-    std::stringstream debugStream{};
     for (const auto& event : envEvents)
     {
         switch (event.type)
@@ -121,7 +136,7 @@ bool Environement::handleEnvironementEvents(
             case om::EventType::cursor_motion:
                 mouseParams[0] = event.parameters.p0;
                 mouseParams[1] = event.parameters.p1;
-                debugStream << mouseParams[0] << " " << mouseParams[1] << "\n";
+                OM_LOG(debug, input, mouseParams[0] << " " << mouseParams[1]);
                 // engine.setUniform("u_mouse", mouseParams, { 1 });
                 break;
             case om::EventType::wheel_rolled:
@@ -137,30 +152,28 @@ bool Environement::handleEnvironementEvents(
                 }
 
                 Global::currentWorldScale = mouseParams[2];
-                debugStream << "Scaling: " << mouseParams[2] << "\n";
+                OM_LOG(debug, input, "Scaling: " << mouseParams[2]);
                 break;
             case om::EventType::button2_pressed:
                 mouseParams[2]            = Global::initialScale;
                 Global::currentWorldScale = mouseParams[2];
-                debugStream << "Reset to default scale: " << mouseParams[2]
-                            << "\n";
+                OM_LOG(debug, input,
+                       "Reset to default scale: " << mouseParams[2]);
                 break;
             case om::EventType::select_pressed:
                 m_isPause = !m_isPause;
-                debugStream << "pause "
-                            << "\n";
+                OM_LOG(debug, input, "pause");
                 break;
             case om::EventType::start_pressed:
                 m_resetGame = true;
-                debugStream << "Reset game "
-                            << "\n";
+                OM_LOG(debug, input, "Reset game");
+                break;
+            case om::EventType::button3_pressed:
+                writeTrace();
                 break;
             default:
                 break;
         }
     }
-#ifdef DEBUG_CONFIGURATION
-    std::clog << debugStream.str();
-#endif
     return true;
 }
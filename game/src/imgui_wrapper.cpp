@@ -1,8 +1,14 @@
 #include "imgui_wrapper.hpp"
+#include "frame_arena.hpp"
+#include "global.hpp"
 #include "matrix.hpp"
+#include "metrics_registry.hpp"
+#include "trace.hpp"
 #include <imgui.h>
 
 #include <algorithm>
+#include <array>
+#include <string>
 
 template <typename T>
 static T findAbsoluteValue(T value1, T value2)
@@ -10,13 +16,13 @@ static T findAbsoluteValue(T value1, T value2)
     return std::sqrt(value1 * value1 + value2 * value2);
 }
 
-static std::vector<ImVec2> rotateImVec2Array(std::vector<ImVec2> inputImVectors,
-                                             float angle, ImVec2 center)
+static om::FrameVector<ImVec2> rotateImVec2Array(
+    const om::FrameVector<ImVec2>& inputImVectors, float angle, ImVec2 center)
 {
     const auto shipOrientationRotationMatrix =
         om::MatrixFunctor::getRotateMatrix(angle, { center.x, center.y });
 
-    std::vector<om::Vector<3>> lineWithArrowNormalizedOmPos;
+    om::FrameVector<om::Vector<3>> lineWithArrowNormalizedOmPos;
     lineWithArrowNormalizedOmPos.reserve(inputImVectors.size());
 
     const auto getOmVecFromImVec = [](ImVec2 imVec) {
@@ -27,8 +33,8 @@ static std::vector<ImVec2> rotateImVec2Array(std::vector<ImVec2> inputImVectors,
                    std::back_inserter(lineWithArrowNormalizedOmPos),
                    getOmVecFromImVec);
 
-    std::vector<om::Vector<3>> lineWithArrowRotatedOmPos;
-    lineWithArrowNormalizedOmPos.reserve(inputImVectors.size());
+    om::FrameVector<om::Vector<3>> lineWithArrowRotatedOmPos;
+    lineWithArrowRotatedOmPos.reserve(inputImVectors.size());
 
     const auto rotateOmVec =
         [&shipOrientationRotationMatrix](om::Vector<3> omVec) {
@@ -39,7 +45,7 @@ static std::vector<ImVec2> rotateImVec2Array(std::vector<ImVec2> inputImVectors,
                    lineWithArrowNormalizedOmPos.end(),
                    std::back_inserter(lineWithArrowRotatedOmPos), rotateOmVec);
 
-    std::vector<ImVec2> lineWithArrowRotatedImPos;
+    om::FrameVector<ImVec2> lineWithArrowRotatedImPos;
     lineWithArrowRotatedImPos.reserve(inputImVectors.size());
 
     const auto getImVecFromOmVec = [](om::Vector<3> omVec) {
@@ -65,7 +71,7 @@ static void drawNaviArrow(float length, float angle, ImVec2 center,
     const auto sideLineDx{ sideLinesLengts * std::sin(sideLinesAngle) };
     const auto sideLineDy{ sideLinesLengts * std::cos(sideLinesAngle) };
 
-    std::vector<ImVec2> arrowNormalizedPos;
+    om::FrameVector<ImVec2> arrowNormalizedPos;
     arrowNormalizedPos.reserve(numberOfElements);
     arrowNormalizedPos.emplace_back(center.x,
                                     center.y - length / 2.f); // upper main
@@ -98,7 +104,7 @@ static void drawNaviLineWithArrow(float length, float angle, ImVec2 center,
 
     drawNaviArrow(length, angle, center, color);
 
-    std::vector<ImVec2> lineWithArrowNormalizedPos;
+    om::FrameVector<ImVec2> lineWithArrowNormalizedPos;
     lineWithArrowNormalizedPos.reserve(numberOfElements);
     lineWithArrowNormalizedPos.emplace_back(center.x,
                                             center.y -
@@ -274,16 +280,153 @@ static void createShipMetersWindow(Model::Rocket& userShip)
     ImGui::PopStyleColor();
 }
 
+static void drawPredictedTrajectory(
+    om::IEngine&                                  render,
+    const Model::TrajectoryPredictor::Trajectory& trajectory)
+{
+    constexpr float thickness{ 1.5f };
+    const ImColor   color{ 0.f, 1.f, 0.f, 0.6f };
+
+    // same transformation as sprites use, from NDC to window pixels
+    const auto displaySize  = ImGui::GetIO().DisplaySize;
+    const auto userPosition = Global::getUserNdcPosition();
+    const auto scale        = Global::getCurrentWorldScaleY();
+    const auto screenSize   = render.getDrawableInchesSize();
+    const auto aspect       = screenSize[1] / screenSize[0];
+
+    om::FrameVector<ImVec2> points;
+    points.reserve(trajectory.points.size());
+    for (const auto& point : trajectory.points)
+    {
+        const auto ndcX =
+            static_cast<float>(point.x) * scale - userPosition.elements[0];
+        const auto ndcY =
+            static_cast<float>(point.y) * scale - userPosition.elements[1];
+        points.emplace_back(
+            displaySize.x / 2 * (1 + ndcX * aspect),
+            displaySize.y / 2 * (1 - ndcY));
+    }
+    ImGui::GetBackgroundDrawList()->AddPolyline(
+        points.data(), static_cast<int>(points.size()), color, false,
+        thickness);
+}
+
+static std::optional<Model::worldCalcType> createTimeWarpWindow(
+    const Model::World& world)
+{
+    constexpr std::array<Model::worldCalcType, 7> factors{ 1,  2,   5,   10,
+                                                           50, 100, 1000 };
+    const std::string      timeWarpWindowName{ "Time warp" };
+    const ImVec4           backgroundColor{ 0.f, 0.f, 0.f, 0.6f };
+    const ImGuiWindowFlags windowCreatingFlags{
+        ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoScrollWithMouse |
+        ImGuiWindowFlags_NoDecoration
+    };
+
+    ImGui::PushStyleColor(ImGuiCol_WindowBg, backgroundColor);
+    ImGui::Begin(timeWarpWindowName.c_str(), nullptr, windowCreatingFlags);
+
+    const ImVec2 windowDesiredSize{ 400, 60 };
+    ImGui::SetWindowSize(timeWarpWindowName.c_str(), windowDesiredSize);
+    ImGui::SetWindowPos(timeWarpWindowName.c_str(), { 0, 0 });
+
+    ImGui::Text("Time warp: x%.0f", world.getTimeWarp());
+    std::optional<Model::worldCalcType> request;
+    for (const auto factor : factors)
+    {
+        const auto label = "x" + std::to_string(static_cast<int>(factor));
+        if (ImGui::Button(label.c_str()))
+        {
+            request = factor;
+        }
+        ImGui::SameLine();
+    }
+
+    ImGui::End();
+    ImGui::PopStyleColor();
+    return request;
+}
+
+static void createMetricsWindow()
+{
+    using Entry = om::MetricsRegistry::Entry;
+    const std::string metricsWindowName{ "Metrics" };
+    const ImVec4      backgroundColor{ 0.f, 0.f, 0.f, 0.6f };
+
+    const auto nextColumnText = [](std::uint64_t value) {
+        ImGui::Text("%llu", static_cast<unsigned long long>(value));
+        ImGui::NextColumn();
+    };
+
+    // window is collapsed at start, so it doesn't hide game
+    const auto displaySize = ImGui::GetIO().DisplaySize;
+    ImGui::SetNextWindowPos({ displaySize.x - 520, 0 }, ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize({ 520, 400 }, ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowCollapsed(true, ImGuiCond_FirstUseEver);
+    ImGui::PushStyleColor(ImGuiCol_WindowBg, backgroundColor);
+    if (ImGui::Begin(metricsWindowName.c_str()))
+    {
+        ImGui::Columns(6, "metricscolumns");
+        for (const auto title :
+             { "name", "value/count", "frame/mean", "p50", "p99", "max" })
+        {
+            ImGui::Text("%s", title);
+            ImGui::NextColumn();
+        }
+        ImGui::Separator();
+        for (const auto& entry : om::MetricsRegistry::getSnapshot())
+        {
+            ImGui::Text("%s", entry.name.c_str());
+            ImGui::NextColumn();
+            if (entry.type == Entry::Type::histogram)
+            {
+                nextColumnText(entry.count);
+                ImGui::Text("%.1f", entry.mean);
+                ImGui::NextColumn();
+                nextColumnText(entry.p50);
+                nextColumnText(entry.p99);
+                nextColumnText(entry.max);
+                continue;
+            }
+            ImGui::Text("%.6g", entry.value);
+            ImGui::NextColumn();
+            if (entry.type == Entry::Type::counter)
+            {
+                nextColumnText(entry.lastFrameValue);
+            }
+            else
+            {
+                ImGui::NextColumn();
+            }
+            // quantiles are only for histograms
+            ImGui::NextColumn();
+            ImGui::NextColumn();
+            ImGui::NextColumn();
+        }
+        ImGui::Columns(1);
+    }
+    ImGui::End();
+    ImGui::PopStyleColor();
+}
+
 ImguiWrapper::ImguiWrapper(om::IEngine& engine)
     : m_engine{ engine }
 {
 }
 
-void ImguiWrapper::createImguiObjects(Model::World& world)
+void ImguiWrapper::createImguiObjects(
+    Model::World& world, const Model::TrajectoryPredictor& predictor)
 {
+    OM_TRACE_SCOPE("ImguiWrapper::createImguiObjects");
     m_engine.uiNewFrame();
 
     auto& userShip = *world.userShipPtr;
 
+    drawPredictedTrajectory(m_engine, *predictor.getTrajectory());
     createShipMetersWindow(userShip);
+    if (const auto request = createTimeWarpWindow(world))
+    {
+        m_timeWarpRequest = request;
+    }
+    createMetricsWindow();
 }
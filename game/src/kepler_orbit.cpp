@@ -0,0 +1,125 @@
+#include "kepler_orbit.hpp"
+#include <cmath>
+
+namespace Model
+{
+
+std::optional<KeplerOrbit> KeplerOrbit::fromState(const State&  state,
+                                                  worldCalcType centerX,
+                                                  worldCalcType centerY,
+                                                  worldCalcType mu,
+                                                  time_point_t  time)
+{
+    const auto rx       = state.x - centerX;
+    const auto ry       = state.y - centerY;
+    const auto distance = std::sqrt(rx * rx + ry * ry);
+    if (mu <= 0 || distance < std::numeric_limits<worldCalcType>::epsilon())
+    {
+        return std::nullopt;
+    }
+
+    const auto speedSquared = state.vx * state.vx + state.vy * state.vy;
+    const auto energy       = speedSquared / 2 - mu / distance;
+    if (energy >= 0)
+    {
+        return std::nullopt;
+    }
+
+    // eccentricity vector points to periapsis
+    const auto radialSpeed  = rx * state.vx + ry * state.vy;
+    const auto radialPart   = speedSquared - mu / distance;
+    const auto ex           = (radialPart * rx - radialSpeed * state.vx) / mu;
+    const auto ey           = (radialPart * ry - radialSpeed * state.vy) / mu;
+    const auto eccentricity = std::sqrt(ex * ex + ey * ey);
+    if (eccentricity >= 1)
+    {
+        return std::nullopt;
+    }
+
+    KeplerOrbit orbit;
+    orbit.m_centerX       = centerX;
+    orbit.m_centerY       = centerY;
+    orbit.m_semiMajorAxis = -mu / (2 * energy);
+    orbit.m_semiMinorAxis =
+        orbit.m_semiMajorAxis * std::sqrt(1 - eccentricity * eccentricity);
+    orbit.m_eccentricity = eccentricity;
+    orbit.m_meanMotion   = std::sqrt(mu / (orbit.m_semiMajorAxis *
+                                         orbit.m_semiMajorAxis *
+                                         orbit.m_semiMajorAxis));
+    orbit.m_epoch        = time;
+
+    // circular orbit has no periapsis, any direction is fine
+    const auto periapsisAngle =
+        eccentricity > std::numeric_limits<worldCalcType>::epsilon()
+            ? std::atan2(ey, ex)
+            : std::atan2(ry, rx);
+    const auto motionDirection = (rx * state.vy - ry * state.vx) < 0 ? -1 : 1;
+    orbit.m_periapsisX         = std::cos(periapsisAngle);
+    orbit.m_periapsisY         = std::sin(periapsisAngle);
+    orbit.m_normalX            = -orbit.m_periapsisY * motionDirection;
+    orbit.m_normalY            = orbit.m_periapsisX * motionDirection;
+
+    const auto periapsisPart =
+        rx * orbit.m_periapsisX + ry * orbit.m_periapsisY;
+    const auto normalPart = rx * orbit.m_normalX + ry * orbit.m_normalY;
+    const auto eccentricAnomaly =
+        std::atan2(normalPart / orbit.m_semiMinorAxis,
+                   periapsisPart / orbit.m_semiMajorAxis + eccentricity);
+    orbit.m_meanAnomalyAtEpoch =
+        eccentricAnomaly - eccentricity * std::sin(eccentricAnomaly);
+    return orbit;
+}
+
+KeplerOrbit::State KeplerOrbit::getState(time_point_t time) const
+{
+    const seconds_t sinceEpoch = time - m_epoch;
+    const auto      meanAnomaly =
+        std::remainder(m_meanAnomalyAtEpoch + m_meanMotion * sinceEpoch.count(),
+                       2 * M_PI);
+    const auto eccentricAnomaly =
+        solveKeplerEquation(meanAnomaly, m_eccentricity);
+
+    const auto cosE = std::cos(eccentricAnomaly);
+    const auto sinE = std::sin(eccentricAnomaly);
+    // dE/dt from derivative of Kepler equation
+    const auto eccentricAnomalySpeed =
+        m_meanMotion / (1 - m_eccentricity * cosE);
+
+    const auto periapsisPart = m_semiMajorAxis * (cosE - m_eccentricity);
+    const auto normalPart    = m_semiMinorAxis * sinE;
+    const auto periapsisSpeed =
+        -m_semiMajorAxis * sinE * eccentricAnomalySpeed;
+    const auto normalSpeed = m_semiMinorAxis * cosE * eccentricAnomalySpeed;
+
+    return { m_centerX + periapsisPart * m_periapsisX + normalPart * m_normalX,
+             m_centerY + periapsisPart * m_periapsisY + normalPart * m_normalY,
+             periapsisSpeed * m_periapsisX + normalSpeed * m_normalX,
+             periapsisSpeed * m_periapsisY + normalSpeed * m_normalY };
+}
+
+worldCalcType KeplerOrbit::solveKeplerEquation(worldCalcType meanAnomaly,
+                                               worldCalcType eccentricity)
+{
+    static constexpr int           maxIterations{ 32 };
+    static constexpr worldCalcType tolerance{ 1e-13 };
+
+    // Newton method, start from pi for very eccentric orbits to converge
+    worldCalcType eccentricAnomaly =
+        eccentricity < 0.8 ? meanAnomaly + eccentricity * std::sin(meanAnomaly)
+                           : (meanAnomaly < 0 ? -M_PI : M_PI);
+    for (int i = 0; i < maxIterations; ++i)
+    {
+        const auto delta =
+            (eccentricAnomaly - eccentricity * std::sin(eccentricAnomaly) -
+             meanAnomaly) /
+            (1 - eccentricity * std::cos(eccentricAnomaly));
+        eccentricAnomaly -= delta;
+        if (std::abs(delta) < tolerance)
+        {
+            break;
+        }
+    }
+    return eccentricAnomaly;
+}
+
+} // namespace Model
@@ -1,14 +1,27 @@
 #include "audio_wrapper.hpp"
 #include "environement.hpp"
 #include "render_wrapper.hpp"
+#include "replay.hpp"
+#include "sprite.hpp"
+#include "trajectory_predictor.hpp"
 #include "utilities.hpp"
 #include "world.hpp"
+#include "world_snapshot.hpp"
+#include <allocation_tracker.hpp>
 #include <engine_handler.hpp>
+#include <logger.hpp>
+#include <metrics_registry.hpp>
+#include <resource_manager.hpp>
+#include <trace.hpp>
 
+#include <cctype>
 #include <chrono>
 #include <cstdlib>
 #include <fstream>
+#include <future>
 #include <iostream>
+#include <memory>
+#include <random>
 #include <unordered_set>
 
 #ifdef __ANDROID__
@@ -16,32 +29,307 @@
 extern "C" int android_main(int argc, char* argv[]);
 #endif
 
-int internal_main(int /*argc*/, char* /*argv*/[])
+int internal_main(int argc, char* argv[])
 {
     using namespace om;
-    constexpr auto             engineType = IEngine::EngineTypes::sdl;
+    // --record <file> saves session, --replay <file> [--headless] plays it
+    // --load <file> starts every game from snapshot, --save <file> writes
+    // snapshot checkpoints
+    // --gravity-field <max error> takes stars gravity from precomputed grid,
+    // --gravity-benchmark compares it with exact sum
+    // --transform-benchmark compares sprite transforms by Matrix and Affine2
+    // --kepler-rails <max perturbation> moves planets along Kepler orbits
+    // --time-warp <factor> starts game with time warp, if ship is far from
+    // other bodies
+    // --serial-textures loads textures one by one before the first frame, to
+    // compare startup time with parallel loading
+    // --null-engine <frames> runs game loop without window for given number of
+    // frames and reports render statistics, with --replay it is deterministic
+    // --software-engine <frames> draws frames by CPU without window,
+    // --png-frames <directory> [<period>] writes them for image comparison,
+    // software engine draws nebulas by sprites as it doesn't run shaders
+    // --sprite-parallax draws nebulas by sprites instead of layer quads
+    // --metrics <file> writes engine and game metrics at exit, as json if
+    // file has .json extension, otherwise as csv
+    // --zero-allocation-frames <warmup frames> [abort] reports call sites of
+    // allocations in game loop after warmup, build with OM_ALLOCATION_TRACKING
+    // --log <category>=<level>[,...] filters log, e.g. all=warning,world=debug
+    // --gpu-budget <MiB>, --cpu-budget <MiB> limit memory of released
+    // textures and sound tracks kept as cache, --resources-report writes
+    // resident bytes per asset at exit
+    // replay should be run with the same world options as recorded session,
+    // session started by --load is replayed from the same snapshot file
+    std::string recordPath;
+    std::string replayPath;
+    std::string snapshotLoadPath;
+    std::string snapshotSavePath;
+    bool        isHeadless{};
+    bool        isGravityFieldEnabled{};
+    bool        isGravityBenchmark{};
+    bool        isTransformBenchmark{};
+    bool        isSpriteParallax{};
+    double      planetsRailsMaxPerturbation{};
+    double      timeWarp{ 1 };
+    std::string nullEngineFrames;
+    std::string softwareEngineFrames;
+    std::string pngFramesDirectory;
+    std::string pngFramesPeriod;
+    std::string metricsPath;
+    int         zeroAllocationWarmupFrames{ -1 };
+    bool        isResourcesReport{};
+
+    ResourceManager::Config resourcesConfig;
+
+    Model::StaticGravityField::Config gravityFieldConfig;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg{ argv[i] };
+        if (arg == "--record" && i + 1 < argc)
+        {
+            recordPath = argv[++i];
+        }
+        else if (arg == "--replay" && i + 1 < argc)
+        {
+            replayPath = argv[++i];
+        }
+        else if (arg == "--headless")
+        {
+            isHeadless = true;
+        }
+        else if (arg == "--load" && i + 1 < argc)
+        {
+            snapshotLoadPath = argv[++i];
+        }
+        else if (arg == "--save" && i + 1 < argc)
+        {
+            snapshotSavePath = argv[++i];
+        }
+        else if (arg == "--gravity-field" && i + 1 < argc)
+        {
+            isGravityFieldEnabled = true;
+            gravityFieldConfig.maxRelativeError = std::atof(argv[++i]);
+        }
+        else if (arg == "--gravity-benchmark")
+        {
+            isGravityBenchmark = true;
+        }
+        else if (arg == "--transform-benchmark")
+        {
+            isTransformBenchmark = true;
+        }
+        else if (arg == "--kepler-rails" && i + 1 < argc)
+        {
+            planetsRailsMaxPerturbation = std::atof(argv[++i]);
+        }
+        else if (arg == "--time-warp" && i + 1 < argc)
+        {
+            timeWarp = std::atof(argv[++i]);
+        }
+        else if (arg == "--serial-textures")
+        {
+            resourcesConfig.isTextureLoadingAsync = false;
+        }
+        else if (arg == "--sprite-parallax")
+        {
+            isSpriteParallax = true;
+        }
+        else if (arg == "--null-engine" && i + 1 < argc)
+        {
+            nullEngineFrames = argv[++i];
+        }
+        else if (arg == "--software-engine" && i + 1 < argc)
+        {
+            softwareEngineFrames = argv[++i];
+        }
+        else if (arg == "--png-frames" && i + 1 < argc)
+        {
+            pngFramesDirectory = argv[++i];
+            if (i + 1 < argc &&
+                std::isdigit(static_cast<unsigned char>(*argv[i + 1])))
+            {
+                pngFramesPeriod = argv[++i];
+            }
+        }
+        else if (arg == "--metrics" && i + 1 < argc)
+        {
+            metricsPath = argv[++i];
+        }
+        else if (arg == "--zero-allocation-frames" && i + 1 < argc)
+        {
+            zeroAllocationWarmupFrames = std::atoi(argv[++i]);
+            if (i + 1 < argc && std::string_view{ argv[i + 1] } == "abort")
+            {
+                ++i;
+                AllocationTracker::setZeroAllocationAction(
+                    AllocationTracker::ZeroAllocationAction::abort);
+            }
+            if (!AllocationTracker::isEnabled)
+            {
+                std::clog << "Zero allocation check requires build with "
+                             "OM_ALLOCATION_TRACKING option"
+                          << std::endl;
+            }
+        }
+        else if (arg == "--gpu-budget" && i + 1 < argc)
+        {
+            resourcesConfig.gpuBudgetBytes =
+                static_cast<size_t>(std::atof(argv[++i]) * 1024 * 1024);
+        }
+        else if (arg == "--cpu-budget" && i + 1 < argc)
+        {
+            resourcesConfig.cpuBudgetBytes =
+                static_cast<size_t>(std::atof(argv[++i]) * 1024 * 1024);
+        }
+        else if (arg == "--resources-report")
+        {
+            isResourcesReport = true;
+        }
+        else if (arg == "--log" && i + 1 < argc)
+        {
+            if (!Logger::setFilter(argv[++i]))
+            {
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    const auto writeMetrics = [&metricsPath]() {
+        if (!metricsPath.empty() &&
+            MetricsRegistry::writeToFile(metricsPath))
+        {
+            std::clog << "Metrics are written to " << metricsPath << std::endl;
+        }
+    };
+
+    auto setupWorld = [&](Model::World& world) {
+        if (isGravityFieldEnabled)
+        {
+            world.enableStarsGravityField(gravityFieldConfig);
+        }
+        world.setPlanetsOnRails(planetsRailsMaxPerturbation);
+        if (!world.setTimeWarp(timeWarp))
+        {
+            std::clog << "Time warp is not allowed near other bodies"
+                      << std::endl;
+        }
+    };
+
+    if (isGravityBenchmark)
+    {
+        const Model::World world{ Timer::time_point_t{} };
+        return Model::runGravityFieldBenchmark(world.stars,
+                                               gravityFieldConfig);
+    }
+
+    if (isTransformBenchmark)
+    {
+        return runSpriteTransformBenchmark();
+    }
+
+    std::unique_ptr<ReplayPlayer>   replayPlayer;
+    std::unique_ptr<ReplayRecorder> replayRecorder;
+    if (!replayPath.empty())
+    {
+        replayPlayer = std::make_unique<ReplayPlayer>(replayPath);
+        if (isHeadless)
+        {
+            const auto result = runHeadlessReplay(*replayPlayer, setupWorld);
+            writeMetrics();
+            return result;
+        }
+    }
+
+    const bool isSoftwareEngine = !softwareEngineFrames.empty();
+    const bool isNullEngine     = !nullEngineFrames.empty() || isSoftwareEngine;
+    const auto engineType =
+        isSoftwareEngine ? IEngine::EngineTypes::software
+        : isNullEngine   ? IEngine::EngineTypes::null
+                         : IEngine::EngineTypes::sdl;
+    // fields of software engine config are separated by new lines, as
+    // directory may contain spaces
     constexpr std::string_view gameTitle{ "Mini space simulator" };
-    constexpr std::string_view config{};
-    EngineHandler              engine(engineType, gameTitle, config);
+    const std::string          config =
+        isSoftwareEngine ? softwareEngineFrames + '\n' + pngFramesDirectory +
+                               '\n' + pngFramesPeriod
+                         : nullEngineFrames;
+    EngineHandler engine(engineType, gameTitle, config);
+    OM_TRACE_THREAD_NAME("main");
+
+    const auto parallaxMode = isSoftwareEngine || isSpriteParallax
+                                  ? RenderWrapper::ParallaxMode::sprites
+                                  : RenderWrapper::ParallaxMode::layers;
 
-    Environement  environement;
-    RenderWrapper renderWrapper{ *engine, { 0, 1, 0 }, 0.05 };
-    ImguiWrapper  imguiWrapper{ *engine };
-    AudioWrapper  audioWrapper{ *engine };
+    Timer           startupTimer;
+    ResourceManager resources{ *engine, resourcesConfig };
+    Environement    environement;
+    RenderWrapper   renderWrapper{
+        *engine, resources, { 0, 1, 0 }, 0.05, parallaxMode
+    };
+    ImguiWrapper    imguiWrapper{ *engine };
+    AudioWrapper    audioWrapper{ *engine, resources };
+    std::clog << "Startup before the first frame: "
+              << startupTimer.elapsed().count() << " s" << std::endl;
+    bool isTexturesLoaded{};
+
+    constexpr Timer::seconds_t checkpointPeriod{ 30 };
+    std::future<bool>          checkpointSaving;
 
 // Type enter to reset game, esc to pause
 RESET:
     Timer gameTime;
 
-    Model::World world{ gameTime.timerNow() };
+    if (replayPlayer)
+    {
+        replayPlayer->rewind();
+        setRandomSeed(replayPlayer->getRandomSeed());
+    }
+    else
+    {
+        setRandomSeed(std::random_device{}());
+    }
+
+    Model::World world =
+        replayPlayer ? replayPlayer->createInitialWorld()
+        : snapshotLoadPath.empty()
+            ? Model::World{ gameTime.timerNow() }
+            : Model::WorldSnapshot::load(snapshotLoadPath, gameTime.timerNow());
+    setupWorld(world);
+    auto lastCheckpointTime = world.lastUpdateTime;
+
+    if (!recordPath.empty())
+    {
+        // file always keeps the last session since reset
+        replayRecorder = std::make_unique<ReplayRecorder>(
+            recordPath, getRandomSeed(), world.lastUpdateTime,
+            replayPlayer ? replayPlayer->getSnapshotPath() : snapshotLoadPath);
+    }
+
+    ReplayFrame replayFrame{ world.lastUpdateTime, {} };
+
+    Model::TrajectoryPredictor trajectoryPredictor{
+        Model::TrajectoryPredictor::Config{}
+    };
 
     bool isContinueLoop = true;
     bool isGameOver     = false;
 
     int loopCount{};
+    int framesSinceReset{};
+
+    auto& inputTimeMetric = MetricsRegistry::getHistogram("frame.input_us");
+    auto& envEventsTimeMetric =
+        MetricsRegistry::getHistogram("frame.env_events_us");
+    auto& worldUpdateTimeMetric =
+        MetricsRegistry::getHistogram("frame.world_update_us");
+    auto& renderTimeMetric = MetricsRegistry::getHistogram("frame.render_us");
+    auto& fullTimeMetric   = MetricsRegistry::getHistogram("frame.full_us");
 
     while (isContinueLoop)
     {
+        // game loop allocates only while world and caches are growing
+        AllocationTracker::setZeroAllocationCheck(
+            zeroAllocationWarmupFrames >= 0 &&
+            framesSinceReset++ >= zeroAllocationWarmupFrames);
         Timer                      loopTimer;
         Model::World::WorldEvents* worldEvents;
         Environement::eventSet     environementEvents;
@@ -49,11 +337,18 @@ RESET:
         Timer tempTimer;
         isContinueLoop =
             environement.input(*engine, worldEvents, environementEvents);
+        if (const auto timeWarpRequest = imguiWrapper.takeTimeWarpRequest())
+        {
+            worldEvents->insert({ Model::World::Events::userCommandTimeWarp,
+                                  { *timeWarpRequest, 0 } });
+        }
         [[maybe_unused]] const auto inputTime = tempTimer.elapsed().count();
+        inputTimeMetric.recordDuration(tempTimer.elapsed());
         tempTimer.reset();
 
         environement.handleEnvironementEvents(*engine, environementEvents);
         [[maybe_unused]] const auto envEventsTime = tempTimer.elapsed().count();
+        envEventsTimeMetric.recordDuration(tempTimer.elapsed());
         tempTimer.reset();
 
         if (!isGameOver)
@@ -63,10 +358,42 @@ RESET:
                 gameTime.pause();
             }
             gameTime.proceed();
-            isGameOver = !world.update(gameTime.timerNow(), *worldEvents);
+            auto worldTime = gameTime.timerNow();
+            if (replayPlayer)
+            {
+                if (!environement.isPause() && !replayPlayer->next(replayFrame))
+                {
+                    std::clog << "Replay finished" << std::endl;
+                    break;
+                }
+                worldTime   = replayFrame.time;
+                worldEvents = &replayFrame.events;
+            }
+            else if (replayRecorder)
+            {
+                replayRecorder->record(worldTime, *worldEvents);
+            }
+            isGameOver = !world.update(worldTime, *worldEvents);
+
+            const auto isCheckpointSaved =
+                !checkpointSaving.valid() ||
+                checkpointSaving.wait_for(std::chrono::seconds{ 0 }) ==
+                    std::future_status::ready;
+            if (!isGameOver && !snapshotSavePath.empty() &&
+                isCheckpointSaved &&
+                world.lastUpdateTime - lastCheckpointTime >= checkpointPeriod)
+            {
+                checkpointSaving = Model::WorldSnapshot::saveAsync(
+                    world, snapshotSavePath);
+                lastCheckpointTime = world.lastUpdateTime;
+            }
+            if (!isGameOver)
+            {
+                trajectoryPredictor.update(world);
+            }
             audioWrapper.play(world);
             renderWrapper.render(world);
-            imguiWrapper.createImguiObjects(world);
+            imguiWrapper.createImguiObjects(world, trajectoryPredictor);
         }
         else
         {
@@ -78,35 +405,76 @@ RESET:
 
         [[maybe_unused]] const auto worldUpdateTime =
             tempTimer.elapsed().count();
+        worldUpdateTimeMetric.recordDuration(tempTimer.elapsed());
         tempTimer.reset();
 
         engine->updateWindow({ 0.f, 0.0f, 0.0f, 0.f });
+        if (!isTexturesLoaded && engine->getPendingTexturesCount() == 0)
+        {
+            isTexturesLoaded = true;
+            std::clog << "All textures are loaded after "
+                      << startupTimer.elapsed().count() << " s" << std::endl;
+        }
 
         [[maybe_unused]] const auto renderTime = tempTimer.elapsed().count();
+        renderTimeMetric.recordDuration(tempTimer.elapsed());
         tempTimer.reset();
 
 #ifdef DEBUG_CONFIGURATION
         if (loopCount == 20)
         {
-            std::clog << world;
-            std::clog << " Full time: " << loopTimer.elapsed().count()
-                      << " Input time: " << inputTime
-                      << " EnviromentEventsTime: " << envEventsTime
-                      << " WorldUpdateTime: " << worldUpdateTime
-                      << " RenderTime : " << renderTime << '\n';
+            OM_LOG(debug, general,
+                   world << " Full time: " << loopTimer.elapsed().count()
+                         << " Input time: " << inputTime
+                         << " EnviromentEventsTime: " << envEventsTime
+                         << " WorldUpdateTime: " << worldUpdateTime
+                         << " RenderTime : " << renderTime);
+            const auto prediction = trajectoryPredictor.getMetrics();
+            OM_LOG(debug, general,
+                   "Prediction full: "
+                       << prediction.fullRecalculations
+                       << " extended: " << prediction.extensions
+                       << " over budget: " << prediction.budgetExceededCount
+                       << " job time: " << prediction.lastJobTime.count()
+                       << " max: " << prediction.maxJobTime.count()
+                       << " staleness: " << prediction.staleness.count()
+                       << " age: " << prediction.publishAge.count()
+                       << " coverage: " << prediction.coverage.count());
+            const auto culling = renderWrapper.getCullingMetrics();
+            OM_LOG(debug, general,
+                   "Render visible: " << culling.visible
+                                      << " culled: " << culling.culled);
             loopCount = 0;
         }
 #endif
 
-        normalizeLoopDuration(loopTimer.elapsed(),
-                              engine->getDisplayRefreshRate());
+        // sleeping for refresh rate isn't counted
+        fullTimeMetric.recordDuration(loopTimer.elapsed());
+        AllocationTracker::setZeroAllocationCheck(false);
+        AllocationTracker::finishFrame();
+        resources.finishFrame();
+        MetricsRegistry::finishFrame();
+
+        if (!replayPlayer && !isNullEngine)
+        {
+            normalizeLoopDuration(loopTimer.elapsed(),
+                                  engine->getDisplayRefreshRate());
+        }
         ++loopCount;
         if (environement.isReset())
         {
+            renderWrapper.resetGameOver();
             goto RESET;
         }
     }
 
+    // log of the last frames goes before reports written at exit
+    Logger::flush();
+    if (isResourcesReport)
+    {
+        resources.writeReport(std::clog);
+    }
+    writeMetrics();
     return EXIT_SUCCESS;
 }
 
@@ -136,14 +504,7 @@ private:
         {
             if (c == '\n')
             {
-#ifdef __ANDROID__
-                // android log function add '\n' on every print itself
-                __android_log_print(ANDROID_LOG_ERROR, "OM", "%s",
-                                    message.c_str());
-#else
-                std::printf("%s\n", message.c_str()); // TODO test only
-#endif
-                message.clear();
+                printMessage();
             }
             else
             {
@@ -153,8 +514,34 @@ private:
         }
     }
 
+    // batch of log messages is split by lines, not put by characters
+    std::streamsize xsputn(const char* text, std::streamsize count) override
+    {
+        std::string_view rest{ text, static_cast<size_t>(count) };
+        for (auto end = rest.find('\n'); end != std::string_view::npos;
+             end      = rest.find('\n'))
+        {
+            message.append(rest.substr(0, end));
+            printMessage();
+            rest.remove_prefix(end + 1);
+        }
+        message.append(rest);
+        return count;
+    }
+
     int sync() override { return 0; }
 
+    void printMessage()
+    {
+#ifdef __ANDROID__
+        // android log function add '\n' on every print itself
+        __android_log_print(ANDROID_LOG_ERROR, "OM", "%s", message.c_str());
+#else
+        std::printf("%s\n", message.c_str()); // TODO test only
+#endif
+        message.clear();
+    }
+
     std::string message;
 };
 
@@ -179,6 +566,8 @@ int android_main(int argc, char* argv[])
         std::cerr << ex.what() << std::endl;
         result = EXIT_FAILURE;
     }
+    // background thread of log writes to redirected buffer too
+    om::Logger::flush();
     std::cout.rdbuf(cout_buf);
     std::cerr.rdbuf(cerr_buf);
     std::clog.rdbuf(clog_buf);
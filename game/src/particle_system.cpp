@@ -0,0 +1,92 @@
+#include "particle_system.hpp"
+#include <algorithm>
+
+namespace Model
+{
+
+worldCalcType ParticleSystem::Particle::getAgeRatio(time_point_t nowTime) const
+{
+    const auto ageRatio = (nowTime - spawnTime) / timeToLive;
+    return std::clamp(ageRatio, 0.0, 1.0);
+}
+
+worldCalcType ParticleSystem::Particle::getCurrentPower(
+    time_point_t nowTime) const
+{
+    if (type != Type::trailCloud)
+    {
+        return initPower;
+    }
+    return initPower * (1 - getAgeRatio(nowTime));
+}
+
+ParticleSystem::ParticleSystem()
+    : m_x(budget)
+    , m_y(budget)
+    , m_angle(budget)
+    , m_width(budget)
+    , m_height(budget)
+    , m_initPower(budget)
+    , m_spawnTime(budget)
+    , m_timeToLive(budget)
+    , m_type(budget)
+    , m_isAlive(budget)
+{
+    m_freeSlots.reserve(budget);
+    // lowest slots are taken first while nothing died, later freed slots are
+    // reused in any order
+    for (size_t i = budget; i > 0; --i)
+    {
+        m_freeSlots.push_back(static_cast<std::uint32_t>(i - 1));
+    }
+}
+
+bool ParticleSystem::spawn(const Particle& particle)
+{
+    if (m_freeSlots.empty())
+    {
+        ++m_droppedCount;
+        return false;
+    }
+    const size_t slot = m_freeSlots.back();
+    m_freeSlots.pop_back();
+
+    m_x[slot]          = particle.x;
+    m_y[slot]          = particle.y;
+    m_angle[slot]      = particle.angle;
+    m_width[slot]      = particle.width;
+    m_height[slot]     = particle.height;
+    m_initPower[slot]  = particle.initPower;
+    m_spawnTime[slot]  = particle.spawnTime;
+    m_timeToLive[slot] = particle.timeToLive;
+    m_type[slot]       = particle.type;
+    m_isAlive[slot]    = true;
+
+    m_usedSlotsEnd = std::max(m_usedSlotsEnd, slot + 1);
+    return true;
+}
+
+void ParticleSystem::update(time_point_t nowTime)
+{
+    for (size_t i = 0; i < m_usedSlotsEnd; ++i)
+    {
+        if (m_isAlive[i] && (nowTime - m_spawnTime[i] > m_timeToLive[i]))
+        {
+            m_isAlive[i] = false;
+            m_freeSlots.push_back(static_cast<std::uint32_t>(i));
+        }
+    }
+    while (m_usedSlotsEnd > 0 && !m_isAlive[m_usedSlotsEnd - 1])
+    {
+        --m_usedSlotsEnd;
+    }
+}
+
+ParticleSystem::Particle ParticleSystem::get(size_t index) const
+{
+    return { m_type[index],      m_x[index],         m_y[index],
+             m_angle[index],     m_width[index],     m_height[index],
+             m_initPower[index], m_spawnTime[index], m_timeToLive[index] };
+}
+
+} // namespace Model
@@ -1,7 +1,12 @@
 #include "render_objects.hpp"
 #include "global.hpp"
 #include "utilities.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <iterator>
 #include <stdexcept>
+#include <utility>
 
 namespace renderObjects
 {
@@ -49,6 +54,29 @@ static std::vector<Sprite> loadGridSprites(
     return allSprites;
 }
 
+ViewRect ViewRect::getCurrent(om::IEngine& render)
+{
+    const auto screenSize = render.getDrawableInchesSize();
+    const Model::worldCalcType halfHeight =
+        Global::ndcSize / 2 / Global::getCurrentWorldScaleForRender();
+    // window aspect stretches ndc by width to height ratio
+    const auto halfWidth = halfHeight * screenSize[0] / screenSize[1];
+    const auto center    = Global::getUserWorldPosition();
+    return { center[0] - halfWidth, center[1] - halfHeight,
+             center[0] + halfWidth, center[1] + halfHeight };
+}
+
+bool ViewRect::isVisible(Model::worldCalcType x, Model::worldCalcType y,
+                         Model::worldCalcType width,
+                         Model::worldCalcType height,
+                         Model::worldCalcType scale) const
+{
+    // half of diagonal covers any rotation
+    const auto reach = std::hypot(width, height) / 2 * scale;
+    return x + reach >= minX && x - reach <= maxX && y + reach >= minY &&
+           y - reach <= maxY;
+}
+
 PhysicalObject::PhysicalObject(const std::string_view textureAttribureName,
                                const std::string_view moveMatrixUniformName,
                                const om::ProgramId&   programId,
@@ -97,12 +125,29 @@ void PhysicalObject::draw(om::IEngine&                 render,
 void PhysicalObject::draw(om::IEngine&                 render,
                           const Model::PhysicalObject& object,
                           om::myGlfloat                scaleWorldRelateToRender)
+{
+    drawSprite(render, object.x, object.y, object.width, object.height,
+               object.angle, scaleWorldRelateToRender);
+}
+
+void PhysicalObject::draw(om::IEngine& render, const Model::Bullet& bullet)
+{
+    drawSprite(render, bullet.x, bullet.y, bullet.width, bullet.height,
+               bullet.angle, 1.0);
+}
+
+void PhysicalObject::drawSprite(om::IEngine& render, Model::worldCalcType x,
+                                Model::worldCalcType y,
+                                Model::worldCalcType width,
+                                Model::worldCalcType height,
+                                Model::worldCalcType angle,
+                                om::myGlfloat        scaleWorldRelateToRender)
 {
     auto rocketNdcX =
-        static_cast<om::myGlfloat>(object.x) * Global::getCurrentWorldScaleY();
+        static_cast<om::myGlfloat>(x) * Global::getCurrentWorldScaleY();
 
     auto rocketNdcY =
-        static_cast<om::myGlfloat>(object.y) * Global::getCurrentWorldScaleY();
+        static_cast<om::myGlfloat>(y) * Global::getCurrentWorldScaleY();
 
     const auto userPosition = Global::getUserNdcPosition();
 
@@ -110,16 +155,16 @@ void PhysicalObject::draw(om::IEngine&                 render,
     rocketNdcY -= userPosition.elements[1];
 
     const auto rocketSizeX =
-        static_cast<float>(object.width * Global::getCurrentWorldScaleY());
+        static_cast<float>(width * Global::getCurrentWorldScaleY());
 
     const auto rocketSizeY =
-        static_cast<float>(object.height * Global::getCurrentWorldScaleY());
+        static_cast<float>(height * Global::getCurrentWorldScaleY());
 
     m_sprites[0].setSpriteSize({ rocketSizeX * scaleWorldRelateToRender,
                                  rocketSizeY * scaleWorldRelateToRender });
     m_sprites[0].setSpritePos({ rocketNdcX, rocketNdcY });
 
-    m_sprites[0].setAngle(object.angle);
+    m_sprites[0].setAngle(angle);
     m_sprites[0].draw(render);
 }
 
@@ -331,12 +376,17 @@ void EngineFire::draw(om::IEngine&               render,
 
 ///////////////////////////////////////////////////////////////////////////////
 
-Collisions::Collisions(const std::string_view textureAttribureName,
-                       const std::string_view moveMatrixUniformName,
-                       const om::ProgramId&   programId,
-                       const om::TextureId&   texExplosion,
-                       const om::TextureId&   texHit)
+Particles::Particles(const std::string_view textureAttribureName,
+                     const std::string_view moveMatrixUniformName,
+                     const om::ProgramId&   programId,
+                     const om::TextureId&   texClouds,
+                     const om::TextureId&   texExplosion,
+                     const om::TextureId&   texHit)
 {
+    m_spritesTrailCloud =
+        loadGridSprites(textureAttribureName, moveMatrixUniformName, programId,
+                        texClouds, 1, 1, "cloud");
+
     const auto textureNumberOfLinesExplosion   = 5;
     const auto textureNumberOfColumnsExplosion = 8;
 
@@ -353,138 +403,123 @@ Collisions::Collisions(const std::string_view textureAttribureName,
                                    textureNumberOfColumnsHit, "collision");
 }
 
-Collisions& Collisions::operator=(const Collisions& collisions2)
-{
-    this->m_spritesHit       = collisions2.m_spritesHit;
-    this->m_spritesExplosion = collisions2.m_spritesExplosion;
-
-    this->collisionsAnimation = collisions2.collisionsAnimation;
-
-    std::for_each(this->collisionsAnimation.begin(),
-                  this->collisionsAnimation.end(),
-                  [this](AnimationDescriptor& animation) {
-                      if (animation.type == Model::OutEvent::Type::hit)
-                          animation.animation.sprites(this->m_spritesHit);
-                      else
-                          animation.animation.sprites(this->m_spritesExplosion);
-                  });
-    return *this;
-}
-
-Collisions::Collisions(const Collisions& collisions2)
-{
-    this->m_spritesHit       = collisions2.m_spritesHit;
-    this->m_spritesExplosion = collisions2.m_spritesExplosion;
-
-    this->collisionsAnimation = collisions2.collisionsAnimation;
-
-    std::for_each(this->collisionsAnimation.begin(),
-                  this->collisionsAnimation.end(),
-                  [this](AnimationDescriptor& animation) {
-                      if (animation.type == Model::OutEvent::Type::hit)
-                          animation.animation.sprites(this->m_spritesHit);
-                      else
-                          animation.animation.sprites(this->m_spritesExplosion);
-                  });
-}
-
-Collisions& Collisions::operator=(const Collisions&& collisions2)
-{
-    this->m_spritesHit       = std::move(collisions2.m_spritesHit);
-    this->m_spritesExplosion = std::move(collisions2.m_spritesExplosion);
-
-    this->collisionsAnimation = collisions2.collisionsAnimation;
-
-    std::for_each(this->collisionsAnimation.begin(),
-                  this->collisionsAnimation.end(),
-                  [this](AnimationDescriptor& animation) {
-                      if (animation.type == Model::OutEvent::Type::hit)
-                          animation.animation.sprites(this->m_spritesHit);
-                      else
-                          animation.animation.sprites(this->m_spritesExplosion);
-                  });
-    return *this;
-}
-
-Collisions::Collisions(const Collisions&& collisions2)
-{
-    this->m_spritesHit       = std::move(collisions2.m_spritesHit);
-    this->m_spritesExplosion = std::move(collisions2.m_spritesExplosion);
-
-    this->collisionsAnimation = collisions2.collisionsAnimation;
-
-    std::for_each(this->collisionsAnimation.begin(),
-                  this->collisionsAnimation.end(),
-                  [this](AnimationDescriptor& animation) {
-                      if (animation.type == Model::OutEvent::Type::hit)
-                          animation.animation.sprites(this->m_spritesHit);
-                      else
-                          animation.animation.sprites(this->m_spritesExplosion);
-                  });
-}
-
-void Collisions::addCollision(const Model::OutEvent& collision)
+void Particles::addToBatch(Batch& batch, const Sprite& sprite,
+                           const Model::ParticleSystem::Particle& particle,
+                           om::myGlfloat                          power)
 {
-    auto xCollision = static_cast<om::myGlfloat>(collision.x);
-    auto yCollision = static_cast<om::myGlfloat>(collision.y);
-
-    auto sizeXCollision = static_cast<om::myGlfloat>(collision.sizeX);
-    auto sizeYCollision = static_cast<om::myGlfloat>(collision.sizeY);
+    const auto userPosition      = Global::getUserNdcPosition();
+    const auto currentWorldScale = Global::getCurrentWorldScaleForRender();
 
-    collisionsAnimation.push_back({ {},
-                                    { collision.time },
-                                    { xCollision, yCollision },
-                                    { sizeXCollision, sizeYCollision },
-                                    collision.type });
+    const om::Vector<2> position{
+        static_cast<om::myGlfloat>(particle.x) * currentWorldScale -
+            userPosition.elements[0],
+        static_cast<om::myGlfloat>(particle.y) * currentWorldScale -
+            userPosition.elements[1]
+    };
+    const om::Vector<2> size{
+        static_cast<om::myGlfloat>(particle.width) * currentWorldScale,
+        static_cast<om::myGlfloat>(particle.height) * currentWorldScale
+    };
 
-    if (collision.type == Model::OutEvent::Type::hit)
+    auto transform = om::Affine2::getShift(position);
+    transform
+        .compose(om::Affine2::getRotation(
+            static_cast<om::myGlfloat>(particle.angle)))
+        .compose(sprite.getBaseRotation());
+
+    auto spritePositions =
+        Rectangle{ {}, size }.getPointsPosNormalizedCentered();
+    const auto texturePositions =
+        sprite.getTextureCoord().getPointsPosDownLeft();
+    const om::Color color{ 1, 1, 1, std::clamp(power, 0.f, 1.f) };
+
+    // corners are transformed in place
+    om::transformPoints(transform, spritePositions.columns,
+                        std::size(spritePositions.columns),
+                        spritePositions.columns);
+
+    const auto firstIndex = static_cast<om::myUint>(batch.vertices.size());
+    for (size_t i = 0; i < std::size(spritePositions.columns); ++i)
     {
-        collisionsAnimation.back().animation.sprites(m_spritesHit);
+        const auto& pos = spritePositions.columns[i];
+
+        om::VertexTextured vertex;
+        vertex.position     = { pos.elements[0], pos.elements[1] };
+        vertex.position_tex = { texturePositions.columns[i].elements[0],
+                                texturePositions.columns[i].elements[1] };
+        vertex.color        = color;
+        batch.vertices.push_back(vertex);
     }
-    else
+
+    for (const om::myUint index : { 0, 1, 3, 0, 2, 3 })
     {
-        collisionsAnimation.back().animation.sprites(m_spritesExplosion);
+        batch.indices.push_back(firstIndex + index);
     }
-    collisionsAnimation.back().animation.setFps(20);
-    collisionsAnimation.back().animation.setMode(Animation2D::Mode::once);
-}
-
-void Collisions::addCollisions(const std::list<Model::OutEvent>& collisions)
-{
-    std::for_each(collisions.begin(), collisions.end(),
-                  [this](const Model::OutEvent& collision) {
-                      if ((collision.type == Model::OutEvent::Type::hit) ||
-                          (collision.type == Model::OutEvent::Type::explosion))
-                          this->addCollision(collision);
-                  });
 }
 
-void Collisions::draw(om::IEngine& render, Timer::time_point_t nowTime)
+void Particles::draw(om::IEngine&                  render,
+                     const Model::ParticleSystem& particles,
+                     Timer::time_point_t nowTime, const ViewRect& view)
 {
-    collisionsAnimation.remove_if(
-        [nowTime](const AnimationDescriptor& currentAnimation) {
-            const auto time = nowTime - currentAnimation.time;
-            return (currentAnimation.animation.getCurrentSprite(time) ==
-                    nullptr);
-        });
+    for (auto& batch : m_batches)
+    {
+        batch.vertices.clear();
+        batch.indices.clear();
+    }
+    m_lastDrawnCount = 0;
 
-    const auto userPosition = Global::getUserWorldPosition();
-    auto       userPositionVector =
-        om::Vector<2>{ static_cast<om::myGlfloat>(userPosition[0]),
-                       static_cast<om::myGlfloat>(userPosition[1]) };
+    particles.forEach([this, nowTime, &view](
+                          const Model::ParticleSystem::Particle& particle) {
+        if (!view.isVisible(particle.x, particle.y, particle.width,
+                            particle.height))
+        {
+            return;
+        }
+        const std::vector<Sprite>* sprites = &m_spritesTrailCloud;
+        if (particle.type == Model::ParticleSystem::Type::hit)
+        {
+            sprites = &m_spritesHit;
+        }
+        else if (particle.type == Model::ParticleSystem::Type::explosion)
+        {
+            sprites = &m_spritesExplosion;
+        }
+        if (sprites->empty())
+        {
+            return;
+        }
 
-    for (auto& collisionAnimation : collisionsAnimation)
+        const auto framesCount = sprites->size();
+        const auto frame =
+            std::min(static_cast<size_t>(particle.getAgeRatio(nowTime) *
+                                         static_cast<double>(framesCount)),
+                     framesCount - 1);
+        addToBatch(m_batches[static_cast<size_t>(particle.type)],
+                   (*sprites)[frame], particle,
+                   static_cast<om::myGlfloat>(
+                       particle.getCurrentPower(nowTime)));
+        ++m_lastDrawnCount;
+    });
+
+    const auto screenSize   = render.getDrawableInchesSize();
+    const auto windowAspect = om::MatrixFunctor::getScaleMatrix(
+        { screenSize[1] / screenSize[0], 1.0 });
+
+    // one draw call per texture
+    const std::array<const std::vector<Sprite>*, std::tuple_size_v<Batches>>
+        sprites{ &m_spritesTrailCloud, &m_spritesHit, &m_spritesExplosion };
+    for (size_t i = 0; i < m_batches.size(); ++i)
     {
-        const auto time = nowTime - collisionAnimation.time;
-        auto       currentSprite =
-            collisionAnimation.animation.getCurrentSprite(time);
-        const auto position = (collisionAnimation.pos - userPositionVector) *
-                              Global::getCurrentWorldScaleForRender();
-        currentSprite->setSpritePos(position);
-        const auto size =
-            (collisionAnimation.size) * Global::getCurrentWorldScaleForRender();
-        currentSprite->setSpriteSize(size);
-        currentSprite->draw(render);
+        const auto& batch = m_batches[i];
+        if (batch.indices.empty())
+        {
+            continue;
+        }
+        const auto& sprite = sprites[i]->front();
+        render.render(batch.vertices, batch.indices, { sprite.getTextureId() },
+                      { sprite.getTextureAttributeName() }, windowAspect,
+                      sprite.getmoveMatrixUniformName(),
+                      sprite.getProgramId());
     }
 }
 
@@ -495,8 +530,7 @@ Rocket::Rocket(const std::string_view textureAttribureName,
                const om::ProgramId&   programId,
                const om::TextureId&   texMainCorpus,
                const om::TextureId&   texMainEngineFire,
-               const om::TextureId&   texSideEngineFire,
-               const om::TextureId&   texClouds)
+               const om::TextureId&   texSideEngineFire)
     : m_mainCorpusRelativePos{ 0.f, 0.f }
 
     , m_mainEngineFireRelativePos{ 0.f, 0.40f }
@@ -530,20 +564,6 @@ Rocket::Rocket(const std::string_view textureAttribureName,
                          { textureAttribureName, moveMatrixUniformName,
                            programId, texSideEngineFire,
                            EngineFire::Type::right } } }
-    , trailCloud{
-        "cloud",
-        textureAttribureName,
-        moveMatrixUniformName,
-        programId,
-        texClouds,
-        { { 0, 0 }, { 1, 1 } },
-        { { 0, 0 },
-          { static_cast<om::myGlfloat>(Model::TrailCloud::widthDefault) *
-                Global::getCurrentScale(),
-            static_cast<om::myGlfloat>(Model::TrailCloud::heightDefault) *
-                Global::getCurrentScale() } },
-        0
-    }
 {
 }
 
@@ -623,32 +643,6 @@ void Rocket::draw(om::IEngine& render, const Model::Rocket& rocket)
     mainCorpus.draw(render, rocket);
 }
 
-void Rocket::drawClouds(om::IEngine& render, const Model::Rocket& rocket)
-{
-    const auto userPosition      = Global::getUserNdcPosition();
-    const auto currentWorldScale = Global::getCurrentWorldScaleForRender();
-
-    for (const auto& cloud : rocket.clouds)
-    {
-        auto ndcXCloud =
-            static_cast<om::myGlfloat>(cloud.x * currentWorldScale);
-        auto ndcYCloud =
-            static_cast<om::myGlfloat>(cloud.y * currentWorldScale);
-        ndcXCloud -= userPosition.elements[0];
-        ndcYCloud -= userPosition.elements[1];
-
-        trailCloud.setSpritePos({ ndcXCloud, ndcYCloud });
-        trailCloud.setAngle(cloud.angle);
-        trailCloud.setSpriteSize(
-            { static_cast<om::myGlfloat>(cloud.width) * currentWorldScale,
-              static_cast<om::myGlfloat>(cloud.height) * currentWorldScale });
-        const auto powerOfCloud =
-            static_cast<om::myGlfloat>(cloud.getCurrentPower());
-        trailCloud.setMixColor({ 1, 1, 1, powerOfCloud });
-        trailCloud.draw(render);
-    }
-}
-
 // MainBackground::MainBackground(const std::string_view
 // textureAttribureName,
 //                               const std::string_view
@@ -870,15 +864,15 @@ ParallaxNebulas::ParallaxNebulas(const std::string_view textureAttribureName,
     , sizeX{ defaultSizeX / parallaxCoef }
 
 {
-    const auto textureNumberOfLines   = 4;
-    const auto textureNumberOfColumns = 4;
+    const auto textureNumberOfLines   = sheetLinesCount;
+    const auto textureNumberOfColumns = sheetColumnsCount;
 
     const om::myGlfloat textureStepX = 1.0 / textureNumberOfColumns;
     const om::myGlfloat textureStepY = 1.0 / textureNumberOfLines;
 
     const om::myGlfloat renderStepX    = sizeX / textureNumberOfColumns;
     const om::myGlfloat renderStepY    = sizeY / textureNumberOfLines;
-    const om::myGlfloat renderBaseSize = 0.7 / parallaxCoef;
+    const om::myGlfloat renderBaseSize = nebulaBaseSize / parallaxCoef;
 
     const om::Vector<2> textureSpriteSize{ textureStepX, textureStepY };
 
@@ -985,4 +979,117 @@ void ParallaxNebulas::draw(om::IEngine& render)
     }
 }
 
+/// Size of nebula relative to cell of layer grid, the same for all layers
+static om::Vector<2> getNebulaSizeInCells()
+{
+    return { ParallaxNebulas::nebulaBaseSize *
+                 ParallaxNebulas::sheetColumnsCount /
+                 ParallaxNebulas::defaultSizeX,
+             ParallaxNebulas::nebulaBaseSize *
+                 ParallaxNebulas::sheetLinesCount /
+                 ParallaxNebulas::defaultSizeY };
+}
+
+ParallaxLayers::ParallaxLayers(om::IEngine&               render,
+                               const std::string_view     textureAttribureName,
+                               const std::string_view     moveMatrixUniformName,
+                               const om::ProgramId&       programId,
+                               const om::TextureId&       tex,
+                               std::vector<om::myGlfloat> parallaxCoefs)
+    : m_textureAttribureName{ textureAttribureName }
+    , m_moveMatrixUniformName{ moveMatrixUniformName }
+    , m_programId{ programId }
+    , m_textureId{ tex }
+    , m_parallaxCoefs{ std::move(parallaxCoefs) }
+{
+    // the farthest layer moves slowest
+    std::sort(m_parallaxCoefs.begin(), m_parallaxCoefs.end());
+
+    const auto nebulaSize = getNebulaSizeInCells();
+    render.setUniform(
+        "u_sheet",
+        { nebulaSize.elements[0], nebulaSize.elements[1],
+          static_cast<om::myGlfloat>(ParallaxNebulas::sheetColumnsCount),
+          static_cast<om::myGlfloat>(ParallaxNebulas::sheetLinesCount) },
+        m_programId);
+}
+
+void ParallaxLayers::draw(om::IEngine& render) const
+{
+    if (!m_textureId.isInit())
+    {
+        std::cerr << "Texture id has not been initialazed." << std::endl;
+        return;
+    }
+
+    const auto screenSize = render.getDrawableInchesSize();
+    const auto aspect     = screenSize[1] / screenSize[0];
+
+    const auto userPosUnscaled =
+        Global::getUserNdcPosition() * (1 / Global::getCurrentScale());
+
+    const auto          nebulaSize = getNebulaSizeInCells();
+    const om::Color     layerColor{ 1.f, 1.f, 1.f, 1.f };
+    const om::Vector<2> sheetCells{
+        static_cast<om::myGlfloat>(ParallaxNebulas::sheetColumnsCount),
+        static_cast<om::myGlfloat>(ParallaxNebulas::sheetLinesCount)
+    };
+
+    for (const auto parallaxCoef : m_parallaxCoefs)
+    {
+        const auto parallaxDist = (1 - parallaxCoef) / parallaxCoef;
+        const auto scale = 1 / (1 / Global::getCurrentScale() + parallaxDist);
+
+        // positions in layer are in cells of grid, starting from corner of
+        // the first sheet
+        const om::Vector<2> cellSize{
+            ParallaxNebulas::defaultSizeX / sheetCells.elements[0] /
+                parallaxCoef,
+            ParallaxNebulas::defaultSizeY / sheetCells.elements[1] /
+                parallaxCoef
+        };
+        const om::Vector<2> cellToNdc{ aspect * scale * cellSize.elements[0],
+                                       scale * cellSize.elements[1] };
+        // center is wrapped to the first sheet, so precision of fragment
+        // positions doesn't depend on distance from start
+        om::Vector<2> center;
+        for (size_t i = 0; i < 2; ++i)
+        {
+            center.elements[i] = std::fmod(
+                userPosUnscaled.elements[i] / cellSize.elements[i] +
+                    sheetCells.elements[i] / 2,
+                sheetCells.elements[i]);
+        }
+
+        const Rectangle screen{ center,
+                                { 2 / cellToNdc.elements[0],
+                                  2 / cellToNdc.elements[1] } };
+        const auto      corners = screen.getPointsPosCentered();
+
+        // texture coordinates aren't sampled by shader, they let engine
+        // estimate texture detail needed for nebulas
+        std::array<om::VertexTextured, 4> vertices;
+        for (size_t i = 0; i < vertices.size(); ++i)
+        {
+            const auto& corner       = corners.columns[i].elements;
+            vertices[i].position     = { corner[0], corner[1] };
+            vertices[i].position_tex = {
+                corner[0] / (sheetCells.elements[0] * nebulaSize.elements[0]),
+                corner[1] / (sheetCells.elements[1] * nebulaSize.elements[1])
+            };
+            vertices[i].color = layerColor;
+        }
+
+        const auto layerToNdc =
+            om::Affine2::getScale(cellToNdc).compose(
+                om::Affine2::getShift(-center));
+
+        static constexpr std::array<om::myUint, 6> indices{ 0, 1, 3, 0, 2, 3 };
+
+        render.render(vertices, indices, { m_textureId },
+                      { m_textureAttribureName }, layerToNdc.toMatrix(),
+                      m_moveMatrixUniformName, m_programId);
+    }
+}
+
 } // namespace renderObjects
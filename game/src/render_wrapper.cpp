@@ -1,5 +1,6 @@
 ﻿#include "render_wrapper.hpp"
 #include "global.hpp"
+#include "trace.hpp"
 #include "utilities.hpp"
 
 #include <algorithm>
@@ -42,37 +43,42 @@ const std::vector<std::string_view> RenderWrapper::textureAttributeNames{
 using namespace renderObjects;
 
 RenderWrapper::RenderWrapper(om::IEngine&                 engine,
+                             om::ResourceManager&         resources,
                              std::array<om::myGlfloat, 3> color,
-                             om::myGlfloat                gridStep)
-    : m_engine{ engine }
+                             om::myGlfloat                gridStep,
+                             ParallaxMode                 parallax)
+    : m_parallaxMode{ parallax }
+    , m_engine{ engine }
+    , m_resources{ resources }
 {
+    const auto addTexture = [this](std::string_view path) {
+        m_textures.push_back(m_resources.acquireTexture(path));
+        return m_resources.getTexture(m_textures.back());
+    };
+
     m_programIdTexturedMoved =
         m_engine.addProgram("res/shaders/game_vertex_shader.vert",
                             "res/shaders/game_fragment_shader.frag",
                             vertexTexturedAttributePositions);
 
     m_textureIdBackground =
-        m_engine.addTexture("res/textures/background_nasa_photo.png");
-    m_textureIdBackgroundGameOver =
-        m_engine.addTexture("res/textures/background_gameover.png");
+        addTexture("res/textures/background_nasa_photo.png");
     m_textureIdNebulas =
-        m_engine.addTexture("res/textures/proc_sheet_nebula_transp.png");
+        addTexture("res/textures/proc_sheet_nebula_transp.png");
 
-    m_textureIdRocketMainCorpus =
-        m_engine.addTexture("res/textures/topdownfighter.png");
-    m_textureIdFireMainEngine =
-        m_engine.addTexture("res/textures/flame_fire.png");
+    m_textureIdRocketMainCorpus = addTexture("res/textures/topdownfighter.png");
+    m_textureIdFireMainEngine   = addTexture("res/textures/flame_fire.png");
     m_textureIdFireSideEngine =
-        m_engine.addTexture("res/textures/flame_blueish_flame.png");
-    m_textureIdTrailCloud = m_engine.addTexture("res/textures/trail_cloud.png");
+        addTexture("res/textures/flame_blueish_flame.png");
+    m_textureIdTrailCloud = addTexture("res/textures/trail_cloud.png");
 
-    m_textureIdPlanet   = m_engine.addTexture("res/textures/planet.png");
-    m_textureIdStar     = m_engine.addTexture("res/textures/blue_star.png");
-    m_textureIdAsteroid = m_engine.addTexture("res/textures/asteroid.png");
-    m_textureIdBullet   = m_engine.addTexture("res/textures/bullet.png");
+    m_textureIdPlanet   = addTexture("res/textures/planet.png");
+    m_textureIdStar     = addTexture("res/textures/blue_star.png");
+    m_textureIdAsteroid = addTexture("res/textures/asteroid.png");
+    m_textureIdBullet   = addTexture("res/textures/bullet.png");
 
-    m_textureIdExplosion = m_engine.addTexture("res/textures/explosion.png");
-    m_textureIdHit       = m_engine.addTexture("res/textures/hit.png");
+    m_textureIdExplosion = addTexture("res/textures/explosion.png");
+    m_textureIdHit       = addTexture("res/textures/hit.png");
 
     m_backgroundSprite =
         Sprite("backgorund", textureAttributeNames[0], moveMatrixUniformName,
@@ -84,19 +90,31 @@ RenderWrapper::RenderWrapper(om::IEngine&                 engine,
     m_backgroundGameOverSprite =
         Sprite("backgorundGameOver", textureAttributeNames[0],
                moveMatrixUniformName, m_programIdTexturedMoved,
-               m_textureIdBackgroundGameOver, { { 0.f, 0.f }, { 1.f, 1.f } },
+               om::TextureId{}, { { 0.f, 0.f }, { 1.f, 1.f } },
                { { 0.f, 0.f }, { 2.f * Global::baseScaleXtoY, 2.f } }, 0,
                { 1.f, 1.f, 1.f, 1.f });
 
-    m_parallaxNebula = renderObjects::ParallaxNebulas(
-        textureAttributeNames[0], moveMatrixUniformName,
-        m_programIdTexturedMoved, m_textureIdNebulas, 0.33f);
+    if (m_parallaxMode == ParallaxMode::layers)
+    {
+        m_programIdParallax =
+            m_engine.addProgram("res/shaders/parallax_vertex_shader.vert",
+                                "res/shaders/parallax_fragment_shader.frag",
+                                vertexTexturedAttributePositions);
+        m_parallaxLayers = renderObjects::ParallaxLayers(
+            m_engine, textureAttributeNames[0], moveMatrixUniformName,
+            m_programIdParallax, m_textureIdNebulas, { nebulasParallaxCoef });
+    }
+    else
+    {
+        m_parallaxNebula = renderObjects::ParallaxNebulas(
+            textureAttributeNames[0], moveMatrixUniformName,
+            m_programIdTexturedMoved, m_textureIdNebulas, nebulasParallaxCoef);
+    }
 
     m_rocket = renderObjects::Rocket(
         textureAttributeNames[0], moveMatrixUniformName,
         m_programIdTexturedMoved, m_textureIdRocketMainCorpus,
-        m_textureIdFireMainEngine, m_textureIdFireSideEngine,
-        m_textureIdTrailCloud);
+        m_textureIdFireMainEngine, m_textureIdFireSideEngine);
 
     m_asteroid = renderObjects::PhysicalObject(
         textureAttributeNames[0], moveMatrixUniformName,
@@ -114,9 +132,10 @@ RenderWrapper::RenderWrapper(om::IEngine&                 engine,
         renderObjects::Star(textureAttributeNames[0], moveMatrixUniformName,
                             m_programIdTexturedMoved, m_textureIdStar);
 
-    m_collisions = renderObjects::Collisions(
+    m_particles = renderObjects::Particles(
         textureAttributeNames[0], moveMatrixUniformName,
-        m_programIdTexturedMoved, m_textureIdExplosion, m_textureIdHit);
+        m_programIdTexturedMoved, m_textureIdTrailCloud, m_textureIdExplosion,
+        m_textureIdHit);
 
     m_engine.setCurrentDefaultProgram(m_programIdTexturedMoved);
 
@@ -134,50 +153,117 @@ bool RenderWrapper::checkColor(std::array<om::myGlfloat, 3> color)
 
 void RenderWrapper::render(const Model::World& world)
 {
+    OM_TRACE_SCOPE("RenderWrapper::render");
     m_backgroundSprite.draw(m_engine);
 
-    m_parallaxNebula.draw(m_engine);
+    if (m_parallaxMode == ParallaxMode::layers)
+    {
+        m_parallaxLayers.draw(m_engine);
+    }
+    else
+    {
+        m_parallaxNebula.draw(m_engine);
+    }
 
     renderWorld(world);
 }
 
 void RenderWrapper::renderWorld(const Model::World& world)
 {
-    m_collisions.addCollisions(world.outEvents);
-
-    for (const auto& currentRocket : world.rockets)
+    using Kind = Model::SpatialIndex::Kind;
+
+    const auto view  = renderObjects::ViewRect::getCurrent(m_engine);
+    const auto total = world.rockets.size() + world.asteroids.size() +
+                       world.planets.size() + world.stars.size() +
+                       world.bullets.size() + world.particles.size();
+    m_cullingMetrics = {};
+    m_visibleRockets.clear();
+    m_visibleAsteroids.clear();
+
+    // rockets and asteroids are many, only ones near view are visited
+    world.getSpatialIndex().queryBox(
+        view.minX - cullingQueryMargin, view.minY - cullingQueryMargin,
+        view.maxX + cullingQueryMargin, view.maxY + cullingQueryMargin,
+        m_cullingCandidates,
+        Model::SpatialIndex::mask(Kind::rocket) |
+            Model::SpatialIndex::mask(Kind::asteroid));
+    for (const auto& candidate : m_cullingCandidates)
     {
-        m_rocket.draw(m_engine, currentRocket);
+        const auto& object   = *candidate.object;
+        const auto  isRocket = candidate.kind == Kind::rocket;
+        if (view.isVisible(object.x, object.y, object.width, object.height,
+                           isRocket ? rocketCullingScale : 1))
+        {
+            if (isRocket)
+            {
+                m_visibleRockets.push_back(
+                    static_cast<const Model::Rocket*>(&object));
+            }
+            else
+            {
+                m_visibleAsteroids.push_back(
+                    static_cast<const Model::Asteroid*>(&object));
+            }
+        }
     }
+    m_cullingMetrics.visible =
+        m_visibleRockets.size() + m_visibleAsteroids.size();
 
-    for (const auto& planet : world.planets)
+    for (const auto* currentRocket : m_visibleRockets)
     {
-        m_planet.draw(m_engine, planet);
+        m_rocket.draw(m_engine, *currentRocket);
     }
 
-    for (const auto& asteroid : world.asteroids)
+    for (const auto& planet : world.planets)
     {
-        m_asteroid.draw(m_engine, asteroid);
+        if (view.isVisible(planet.x, planet.y, planet.width, planet.height))
+        {
+            m_planet.draw(m_engine, planet);
+            ++m_cullingMetrics.visible;
+        }
     }
 
-    for (const auto& currentBullet : world.bullets)
+    for (const auto* asteroid : m_visibleAsteroids)
     {
-        m_bullet.draw(m_engine, currentBullet);
+        m_asteroid.draw(m_engine, *asteroid);
     }
 
-    for (const auto& currentRocket : world.rockets)
-    {
-        m_rocket.drawClouds(m_engine, currentRocket);
-    }
+    world.bullets.forEach([this, &view](const Model::Bullet& currentBullet) {
+        if (view.isVisible(currentBullet.x, currentBullet.y,
+                           currentBullet.width, currentBullet.height))
+        {
+            m_bullet.draw(m_engine, currentBullet);
+            ++m_cullingMetrics.visible;
+        }
+    });
 
     for (const auto& star : world.stars)
     {
-        m_star.draw(m_engine, star);
+        if (view.isVisible(star.x, star.y, star.width, star.height,
+                           renderObjects::Star::widerNess))
+        {
+            m_star.draw(m_engine, star);
+            ++m_cullingMetrics.visible;
+        }
     }
-    m_collisions.draw(m_engine, world.lastUpdateTime);
+    m_particles.draw(m_engine, world.particles, world.lastUpdateTime, view);
+    m_cullingMetrics.visible += m_particles.getLastDrawnCount();
+    m_cullingMetrics.culled = total - m_cullingMetrics.visible;
 }
 
 void RenderWrapper::renderGameOver()
 {
+    if (!m_textureBackgroundGameOver)
+    {
+        m_textureBackgroundGameOver =
+            m_resources.acquireTexture(pathToTextureBackgroundGameOver);
+    }
+    m_backgroundGameOverSprite.setTextureId(
+        m_resources.getTexture(m_textureBackgroundGameOver));
     m_backgroundGameOverSprite.draw(m_engine);
 }
+
+void RenderWrapper::resetGameOver()
+{
+    m_textureBackgroundGameOver.reset();
+}
@@ -0,0 +1,181 @@
+#include "replay.hpp"
+#include "file_utils.hpp"
+#include "mapped_file.hpp"
+#include "world_snapshot.hpp"
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+/// Replay of session started from snapshot is valid only with the same one
+static std::uint64_t calcSnapshotHash(const std::string& path)
+{
+    const auto file = om::mapFile(path);
+    if (!file)
+    {
+        throw std::runtime_error("Error: can't open snapshot: " + path);
+    }
+    return om::calcFnv1a({ file->data.get(), file->size });
+}
+
+ReplayRecorder::ReplayRecorder(const std::string&  path,
+                               std::uint32_t       randomSeed,
+                               Timer::time_point_t initialTime,
+                               const std::string&  snapshotPath)
+    : m_file{ path }
+{
+    if (!m_file)
+    {
+        throw std::runtime_error("Error: can't open replay file for write: " +
+                                 path);
+    }
+    m_file << std::setprecision(
+        std::numeric_limits<Model::worldCalcType>::max_digits10);
+    m_file << ReplayPlayer::fileSignature << ' ' << ReplayPlayer::fileVersion
+           << '\n'
+           << "seed " << randomSeed << '\n'
+           << "start " << initialTime.time_since_epoch().count() << '\n'
+           << "snapshot "
+           << (snapshotPath.empty() ? 0 : calcSnapshotHash(snapshotPath))
+           << ' ' << std::quoted(snapshotPath) << '\n';
+}
+
+void ReplayRecorder::record(Timer::time_point_t              time,
+                            const Model::World::WorldEvents& events)
+{
+    m_file << time.time_since_epoch().count() << ' ' << events.size();
+    for (const auto& [event, parameters] : events)
+    {
+        m_file << ' ' << static_cast<size_t>(event) << ' ' << parameters[0]
+               << ' ' << parameters[1];
+    }
+    m_file << '\n';
+}
+
+ReplayPlayer::ReplayPlayer(const std::string& path)
+{
+    std::ifstream file{ path };
+    if (!file)
+    {
+        throw std::runtime_error("Error: can't open replay file: " + path);
+    }
+
+    std::string         signature;
+    int                 version{};
+    std::string         seedTag;
+    std::string         startTag;
+    Timer::clock_t::rep initialTicks{};
+    std::string         snapshotTag{ "snapshot" };
+    file >> signature >> version >> seedTag >> m_randomSeed >> startTag >>
+        initialTicks;
+    if (version >= 2)
+    {
+        file >> snapshotTag >> m_snapshotHash >> std::quoted(m_snapshotPath);
+    }
+    if (!file || signature != fileSignature || version < 1 ||
+        version > fileVersion || seedTag != "seed" || startTag != "start" ||
+        snapshotTag != "snapshot")
+    {
+        throw std::runtime_error("Error: wrong replay file header: " + path);
+    }
+    m_initialTime =
+        Timer::time_point_t{ Timer::clock_t::duration{ initialTicks } };
+
+    Timer::clock_t::rep ticks{};
+    while (file >> ticks)
+    {
+        ReplayFrame frame;
+        frame.time = Timer::time_point_t{ Timer::clock_t::duration{ ticks } };
+        size_t eventsCount{};
+        file >> eventsCount;
+        for (size_t i = 0; i < eventsCount && file; ++i)
+        {
+            size_t                              event{};
+            std::array<Model::worldCalcType, 2> parameters{};
+            file >> event >> parameters[0] >> parameters[1];
+            if (event >= static_cast<size_t>(Model::World::Events::maxType))
+            {
+                std::stringstream serr;
+                serr << "Error: wrong event " << event << " in replay frame "
+                     << m_frames.size() << " of file: " << path;
+                throw std::runtime_error(serr.str());
+            }
+            frame.events.insert(
+                { static_cast<Model::World::Events>(event), parameters });
+        }
+        if (!file)
+        {
+            std::stringstream serr;
+            serr << "Error: truncated replay frame " << m_frames.size()
+                 << " in file: " << path;
+            throw std::runtime_error(serr.str());
+        }
+        m_frames.push_back(std::move(frame));
+    }
+}
+
+Model::World ReplayPlayer::createInitialWorld() const
+{
+    if (m_snapshotPath.empty())
+    {
+        return Model::World{ m_initialTime };
+    }
+    if (calcSnapshotHash(m_snapshotPath) != m_snapshotHash)
+    {
+        throw std::runtime_error("Error: snapshot " + m_snapshotPath +
+                                 " differs from recorded session one");
+    }
+    return Model::WorldSnapshot::load(m_snapshotPath, m_initialTime);
+}
+
+bool ReplayPlayer::next(ReplayFrame& frame)
+{
+    if (m_currentFrame >= m_frames.size())
+    {
+        return false;
+    }
+    frame = m_frames[m_currentFrame++];
+    return true;
+}
+
+int runHeadlessReplay(ReplayPlayer&                                player,
+                      const std::function<void(Model::World&)>& setupWorld)
+{
+    setRandomSeed(player.getRandomSeed());
+    player.rewind();
+
+    Model::World world = player.createInitialWorld();
+    if (setupWorld)
+    {
+        setupWorld(world);
+    }
+    ReplayFrame  frame;
+    size_t       framesCount{};
+    bool         isGameOver = false;
+
+    Timer replayTimer;
+    while (!isGameOver && player.next(frame))
+    {
+        isGameOver = !world.update(frame.time, frame.events);
+        ++framesCount;
+    }
+    const auto updateTime = replayTimer.elapsed();
+
+    const Timer::seconds_t worldTime =
+        world.lastUpdateTime - player.getInitialTime();
+    std::clog << world;
+    std::clog << "Replay finished. Frames: " << framesCount << '/'
+              << player.getFramesCount()
+              << " World time: " << worldTime.count()
+              << " Game over: " << std::boolalpha << isGameOver
+              << " Rockets: " << world.rockets.size()
+              << " Planets: " << world.planets.size()
+              << " Asteroids: " << world.asteroids.size()
+              << " Bullets: " << world.bullets.size()
+              << " WorldUpdateTime: " << updateTime.count() << " Per frame: "
+              << (framesCount ? updateTime.count() / framesCount : 0.0)
+              << '\n';
+    return EXIT_SUCCESS;
+}
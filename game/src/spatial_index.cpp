@@ -0,0 +1,398 @@
+#include "spatial_index.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace Model
+{
+
+static bool isKindInMask(SpatialIndex::Kind kind, SpatialIndex::KindMask kinds)
+{
+    return (SpatialIndex::mask(kind) & kinds) != 0;
+}
+
+static worldCalcType getHalfSize(const PhysicalObject& object)
+{
+    return std::max(object.width, object.height) / 2;
+}
+
+/// Segment parameter in [0, 1] where it enters object box, nullopt if it
+/// misses the box
+static std::optional<worldCalcType> crossSegmentWithBox(
+    worldCalcType x0, worldCalcType y0, worldCalcType dx, worldCalcType dy,
+    const PhysicalObject& object)
+{
+    const std::array<worldCalcType, 2> start{ x0 - object.x, y0 - object.y };
+    const std::array<worldCalcType, 2> move{ dx, dy };
+    const std::array<worldCalcType, 2> halfSize{ object.width / 2,
+                                                 object.height / 2 };
+    worldCalcType enterTime{ 0 };
+    worldCalcType exitTime{ 1 };
+    for (size_t axis = 0; axis < 2; ++axis)
+    {
+        if (std::abs(move[axis]) <
+            std::numeric_limits<worldCalcType>::epsilon())
+        {
+            if (std::abs(start[axis]) > halfSize[axis])
+                return std::nullopt;
+            continue;
+        }
+        auto axisEnterTime = (-halfSize[axis] - start[axis]) / move[axis];
+        auto axisExitTime  = (halfSize[axis] - start[axis]) / move[axis];
+        if (axisEnterTime > axisExitTime)
+        {
+            std::swap(axisEnterTime, axisExitTime);
+        }
+        enterTime = std::max(enterTime, axisEnterTime);
+        exitTime  = std::min(exitTime, axisExitTime);
+        if (enterTime > exitTime)
+            return std::nullopt;
+    }
+    return enterTime;
+}
+
+SpatialIndex::SpatialIndex(worldCalcType cellSize)
+    : m_cellSize{ cellSize }
+{
+}
+
+std::int32_t SpatialIndex::toCell(worldCalcType coordinate) const
+{
+    // objects thrown far away shouldn't overflow cell index
+    static constexpr worldCalcType maxCell{ 1 << 30 };
+    return static_cast<std::int32_t>(
+        std::clamp(std::floor(coordinate / m_cellSize), -maxCell, maxCell));
+}
+
+SpatialIndex::CellKey SpatialIndex::toKey(std::int32_t cellX,
+                                          std::int32_t cellY)
+{
+    return (static_cast<CellKey>(static_cast<std::uint32_t>(cellX)) << 32) |
+           static_cast<std::uint32_t>(cellY);
+}
+
+void SpatialIndex::add(const PhysicalObject& object, Kind kind)
+{
+    const auto cellX = toCell(object.x);
+    const auto cellY = toCell(object.y);
+    const auto key   = toKey(cellX, cellY);
+
+    m_maxHalfSize = std::max(m_maxHalfSize, getHalfSize(object));
+    m_minCellX    = std::min(m_minCellX, cellX);
+    m_minCellY    = std::min(m_minCellY, cellY);
+    m_maxCellX    = std::max(m_maxCellX, cellX);
+    m_maxCellY    = std::max(m_maxCellY, cellY);
+
+    auto [recordIt, isNew] =
+        m_records.try_emplace(&object, Record{ kind, key, m_generation });
+    auto& record = recordIt->second;
+    if (isNew)
+    {
+        m_cells[key].push_back({ &object, kind });
+        return;
+    }
+    record.generation = m_generation;
+    // address of destroyed object can be taken by new one of other kind
+    if (record.cell != key || record.kind != kind)
+    {
+        removeFromCell(record.cell, &object);
+        m_cells[key].push_back({ &object, kind });
+        record.cell = key;
+        record.kind = kind;
+        ++m_lastMovesCount;
+    }
+}
+
+void SpatialIndex::removeFromCell(CellKey cell, const PhysicalObject* object)
+{
+    auto cellIt = m_cells.find(cell);
+    if (cellIt == m_cells.end())
+    {
+        return;
+    }
+    auto& entries = cellIt->second;
+    auto  entryIt = std::find_if(
+        entries.begin(), entries.end(),
+        [object](const Entry& entry) { return entry.object == object; });
+    if (entryIt != entries.end())
+    {
+        *entryIt = entries.back();
+        entries.pop_back();
+    }
+    if (entries.empty())
+    {
+        m_cells.erase(cellIt);
+    }
+}
+
+void SpatialIndex::update(const std::list<Rocket>&   rockets,
+                          const std::list<Asteroid>& asteroids,
+                          const std::list<Planet>&   planets,
+                          const std::list<Star>&     stars)
+{
+    ++m_generation;
+    m_lastMovesCount = 0;
+    m_maxHalfSize    = 0;
+    m_minCellX       = std::numeric_limits<std::int32_t>::max();
+    m_minCellY       = std::numeric_limits<std::int32_t>::max();
+    m_maxCellX       = std::numeric_limits<std::int32_t>::min();
+    m_maxCellY       = std::numeric_limits<std::int32_t>::min();
+
+    for (const auto& rocket : rockets)
+    {
+        add(rocket, Kind::rocket);
+    }
+    for (const auto& asteroid : asteroids)
+    {
+        add(asteroid, Kind::asteroid);
+    }
+    for (const auto& planet : planets)
+    {
+        add(planet, Kind::planet);
+    }
+    for (const auto& star : stars)
+    {
+        add(star, Kind::star);
+    }
+
+    // objects not seen in this update are destroyed
+    for (auto recordIt = m_records.begin(); recordIt != m_records.end();)
+    {
+        if (recordIt->second.generation != m_generation)
+        {
+            removeFromCell(recordIt->second.cell, recordIt->first);
+            recordIt = m_records.erase(recordIt);
+        }
+        else
+        {
+            ++recordIt;
+        }
+    }
+}
+
+template <typename Visitor>
+void SpatialIndex::forEachInCells(std::int32_t minCellX, std::int32_t minCellY,
+                                  std::int32_t maxCellX, std::int32_t maxCellY,
+                                  KindMask kinds, Visitor&& visitor) const
+{
+    minCellX = std::max(minCellX, m_minCellX);
+    minCellY = std::max(minCellY, m_minCellY);
+    maxCellX = std::min(maxCellX, m_maxCellX);
+    maxCellY = std::min(maxCellY, m_maxCellY);
+    for (auto cellX = minCellX; cellX <= maxCellX; ++cellX)
+    {
+        for (auto cellY = minCellY; cellY <= maxCellY; ++cellY)
+        {
+            const auto cellIt = m_cells.find(toKey(cellX, cellY));
+            if (cellIt == m_cells.end())
+            {
+                continue;
+            }
+            for (const auto& entry : cellIt->second)
+            {
+                if (isKindInMask(entry.kind, kinds))
+                {
+                    visitor(entry);
+                }
+            }
+        }
+    }
+}
+
+void SpatialIndex::queryRadius(worldCalcType       x,
+                               worldCalcType       y,
+                               worldCalcType       radius,
+                               std::vector<Entry>& r_entries,
+                               KindMask            kinds) const
+{
+    r_entries.clear();
+    const auto reach = radius + m_maxHalfSize;
+    forEachInCells(toCell(x - reach), toCell(y - reach), toCell(x + reach),
+                   toCell(y + reach), kinds, [&](const Entry& entry) {
+                       const auto& object = *entry.object;
+                       // distance to the nearest point of box
+                       const auto dx =
+                           std::max(std::abs(x - object.x) - object.width / 2,
+                                    worldCalcType{ 0 });
+                       const auto dy =
+                           std::max(std::abs(y - object.y) - object.height / 2,
+                                    worldCalcType{ 0 });
+                       if (dx * dx + dy * dy <= radius * radius)
+                       {
+                           r_entries.push_back(entry);
+                       }
+                   });
+}
+
+void SpatialIndex::queryBox(worldCalcType       minX,
+                            worldCalcType       minY,
+                            worldCalcType       maxX,
+                            worldCalcType       maxY,
+                            std::vector<Entry>& r_entries,
+                            KindMask            kinds) const
+{
+    r_entries.clear();
+    forEachInCells(toCell(minX - m_maxHalfSize), toCell(minY - m_maxHalfSize),
+                   toCell(maxX + m_maxHalfSize), toCell(maxY + m_maxHalfSize),
+                   kinds, [&](const Entry& entry) {
+                       const auto& object = *entry.object;
+                       if (object.x + object.width / 2 >= minX &&
+                           object.x - object.width / 2 <= maxX &&
+                           object.y + object.height / 2 >= minY &&
+                           object.y - object.height / 2 <= maxY)
+                       {
+                           r_entries.push_back(entry);
+                       }
+                   });
+}
+
+void SpatialIndex::findNearest(worldCalcType       x,
+                               worldCalcType       y,
+                               size_t              count,
+                               std::vector<Entry>& r_entries,
+                               KindMask            kinds,
+                               worldCalcType       maxDistance) const
+{
+    r_entries.clear();
+    auto& candidates = m_nearestCandidates;
+    candidates.clear();
+    if (count == 0 || m_records.empty())
+    {
+        return;
+    }
+
+    const auto isCloser = [](const Candidate& left, const Candidate& right) {
+        return left.distanceSquared < right.distanceSquared;
+    };
+    const auto centerCellX = toCell(x);
+    const auto centerCellY = toCell(y);
+    // centers are in their cells, so ring cells are not closer than ring - 1
+    // cells from point
+    for (std::int32_t ring = 0;; ++ring)
+    {
+        const auto ringDistance = (ring - 1) * m_cellSize;
+        if (ringDistance > maxDistance)
+        {
+            break;
+        }
+        if (candidates.size() >= count)
+        {
+            std::nth_element(candidates.begin(), candidates.begin() + count - 1,
+                             candidates.end(), isCloser);
+            if (ringDistance > 0 &&
+                ringDistance * ringDistance >
+                    candidates[count - 1].distanceSquared)
+            {
+                break;
+            }
+        }
+        if (centerCellX - ring < m_minCellX &&
+            centerCellX + ring > m_maxCellX &&
+            centerCellY - ring < m_minCellY && centerCellY + ring > m_maxCellY)
+        {
+            break;
+        }
+
+        const auto addCandidate = [&](const Entry& entry) {
+            const auto dx              = entry.object->x - x;
+            const auto dy              = entry.object->y - y;
+            const auto distanceSquared = dx * dx + dy * dy;
+            if (distanceSquared <= maxDistance * maxDistance)
+            {
+                candidates.push_back({ distanceSquared, entry });
+            }
+        };
+        const auto minCellX = centerCellX - ring;
+        const auto maxCellX = centerCellX + ring;
+        const auto minCellY = centerCellY - ring;
+        const auto maxCellY = centerCellY + ring;
+        // top and bottom lines of ring, then left and right columns
+        forEachInCells(minCellX, minCellY, maxCellX, minCellY, kinds,
+                       addCandidate);
+        if (ring > 0)
+        {
+            forEachInCells(minCellX, maxCellY, maxCellX, maxCellY, kinds,
+                           addCandidate);
+            forEachInCells(minCellX, minCellY + 1, minCellX, maxCellY - 1,
+                           kinds, addCandidate);
+            forEachInCells(maxCellX, minCellY + 1, maxCellX, maxCellY - 1,
+                           kinds, addCandidate);
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end(), isCloser);
+    for (size_t i = 0; i < candidates.size() && i < count; ++i)
+    {
+        r_entries.push_back(candidates[i].entry);
+    }
+}
+
+std::optional<SpatialIndex::RaycastHit> SpatialIndex::raycast(
+    worldCalcType x0, worldCalcType y0, worldCalcType x1, worldCalcType y1,
+    KindMask kinds, const PhysicalObject* ignore) const
+{
+    const auto dx     = x1 - x0;
+    const auto dy     = y1 - y0;
+    const auto length = std::sqrt(dx * dx + dy * dy);
+
+    std::optional<RaycastHit> hit;
+    const auto                testEntry = [&](const Entry& entry) {
+        if (entry.object == ignore)
+        {
+            return;
+        }
+        const auto enterTime =
+            crossSegmentWithBox(x0, y0, dx, dy, *entry.object);
+        if (enterTime && (!hit || *enterTime * length < hit->distance))
+        {
+            hit = RaycastHit{ entry, *enterTime * length };
+        }
+    };
+
+    // cells along segment (grid traversal), each with neighbours objects
+    // from which can reach it
+    const auto reach =
+        static_cast<std::int32_t>(std::ceil(m_maxHalfSize / m_cellSize));
+    auto       cellX    = toCell(x0);
+    auto       cellY    = toCell(y0);
+    const auto endCellX = toCell(x1);
+    const auto endCellY = toCell(y1);
+    const auto stepX    = dx > 0 ? 1 : -1;
+    const auto stepY    = dy > 0 ? 1 : -1;
+
+    constexpr auto infinity = std::numeric_limits<worldCalcType>::infinity();
+    auto nextTimeX  = dx != 0 ? ((cellX + (stepX > 0)) * m_cellSize - x0) / dx
+                              : infinity;
+    auto nextTimeY  = dy != 0 ? ((cellY + (stepY > 0)) * m_cellSize - y0) / dy
+                              : infinity;
+    const auto stepTimeX = dx != 0 ? m_cellSize / std::abs(dx) : infinity;
+    const auto stepTimeY = dy != 0 ? m_cellSize / std::abs(dy) : infinity;
+    // objects of neighbour cells can be hit before the current cell
+    const auto margin = (reach + 1) * m_cellSize * M_SQRT2;
+
+    auto stepsLeft = std::abs(endCellX - cellX) + std::abs(endCellY - cellY);
+    while (true)
+    {
+        forEachInCells(cellX - reach, cellY - reach, cellX + reach,
+                       cellY + reach, kinds, testEntry);
+
+        const auto nextTime = std::min(nextTimeX, nextTimeY);
+        if (stepsLeft-- <= 0 || nextTime > 1 ||
+            (hit && nextTime * length > hit->distance + margin))
+        {
+            break;
+        }
+        if (nextTimeX < nextTimeY)
+        {
+            cellX += stepX;
+            nextTimeX += stepTimeX;
+        }
+        else
+        {
+            cellY += stepY;
+            nextTimeY += stepTimeY;
+        }
+    }
+    return hit;
+}
+
+} // namespace Model
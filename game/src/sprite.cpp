@@ -1,6 +1,12 @@
 #include "sprite.hpp"
+#include "utilities.hpp"
 #include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
+#include <random>
+#include <vector>
 
 om::Matrix<2, 4> Rectangle::getPointsPosCentered() const
 {
@@ -58,6 +64,8 @@ Sprite::Sprite(const std::string_view id,
     , m_texCoordinates{ rectangleTexture }
     , m_spriteCoordinates{ rectangleSprite }
     , m_angle(angle)
+    , m_angleSin{ std::sin(angle) }
+    , m_angleCos{ std::cos(angle) }
     , m_mixColor{ mixColor }
 
 {
@@ -85,7 +93,7 @@ void Sprite::draw(om::IEngine& render, om::Vector<2> basePoint) const
 
     using namespace om;
 
-    std::vector<VertexTextured> vertexes;
+    std::array<VertexTextured, 4> vertexes;
 
     const auto spritePositions =
         m_spriteCoordinates.getPointsPosNormalizedCentered();
@@ -102,8 +110,7 @@ void Sprite::draw(om::IEngine& render, om::Vector<2> basePoint) const
     };
 
     std::transform(spritePositions.begin(), spritePositions.end(),
-                   texturePositions.begin(), std::back_inserter(vertexes),
-                   formVertex);
+                   texturePositions.begin(), vertexes.begin(), formVertex);
 
     auto setColor = [this](VertexTextured& vertex) {
         vertex.color = m_mixColor;
@@ -115,20 +122,16 @@ void Sprite::draw(om::IEngine& render, om::Vector<2> basePoint) const
 
     const auto aspect = screen_size[1] / screen_size[0];
 
-    const auto window_aspect = MatrixFunctor::getScaleMatrix({ aspect, 1.0 });
+    // window_aspect * move * rotation * rotationBase
+    auto world_transform = Affine2::getScale({ aspect, 1.0 });
+    world_transform.compose(Affine2::getShift(m_spriteCoordinates.pos))
+        .compose(Affine2::getRotationSinCos(m_angleSin, m_angleCos, basePoint))
+        .compose(getBaseRotation());
 
-    const auto rotationBase = MatrixFunctor::getRotateMatrix(m_baseAngle);
-
-    const auto rotation = MatrixFunctor::getRotateMatrix(m_angle, basePoint);
-
-    const auto move = MatrixFunctor::getShiftMatrix(m_spriteCoordinates.pos);
-
-    const auto world_transform = window_aspect * move * rotation * rotationBase;
-
-    std::vector<myUint> indices{ 0, 1, 3, 0, 2, 3 };
+    static constexpr std::array<myUint, 6> indices{ 0, 1, 3, 0, 2, 3 };
 
     render.render(vertexes, indices, { m_textureId },
-                  { m_textureAttribureName }, world_transform,
+                  { m_textureAttribureName }, world_transform.toMatrix(),
                   m_moveMatrixUniformName, m_programId);
 }
 
@@ -179,7 +182,12 @@ float Sprite::getAngle() const
 
 void Sprite::setAngle(const om::myGlfloat angle)
 {
-    m_angle = angle;
+    if (angle != m_angle)
+    {
+        m_angle    = angle;
+        m_angleSin = std::sin(angle);
+        m_angleCos = std::cos(angle);
+    }
 }
 
 float Sprite::getBaseAngle() const
@@ -189,7 +197,14 @@ float Sprite::getBaseAngle() const
 
 void Sprite::setBaseAngle(const om::myGlfloat baseAngle)
 {
-    m_baseAngle = baseAngle;
+    m_baseAngle    = baseAngle;
+    m_baseAngleSin = std::sin(baseAngle);
+    m_baseAngleCos = std::cos(baseAngle);
+}
+
+om::Affine2 Sprite::getBaseRotation() const
+{
+    return om::Affine2::getRotationSinCos(m_baseAngleSin, m_baseAngleCos);
 }
 
 const std::string& Sprite::getId() const
@@ -237,3 +252,92 @@ void Sprite::setMixColor(const om::Color& mixColor)
 {
     m_mixColor = mixColor;
 }
+
+int runSpriteTransformBenchmark()
+{
+    using namespace om;
+
+    struct SpriteState
+    {
+        Vector<2> position;
+        myGlfloat angle;
+        myGlfloat baseAngle;
+        myGlfloat baseAngleSin;
+        myGlfloat baseAngleCos;
+    };
+
+    constexpr size_t    spritesCount{ 1'000'000 };
+    constexpr size_t    cornersCount{ 4 };
+    constexpr myGlfloat aspect{ 9.f / 16.f };
+
+    // fixed seed, so every run uses the same sprites
+    std::mt19937                              generator{ 1 };
+    std::uniform_real_distribution<myGlfloat> distribution{ -1, 1 };
+    std::vector<SpriteState>                  sprites(spritesCount);
+    // sine and cosine of base angle are cached as by Sprite
+    for (auto& sprite : sprites)
+    {
+        sprite.position     = { distribution(generator),
+                                distribution(generator) };
+        sprite.angle        = distribution(generator) * 3.14f;
+        sprite.baseAngle    = distribution(generator) * 3.14f;
+        sprite.baseAngleSin = std::sin(sprite.baseAngle);
+        sprite.baseAngleCos = std::cos(sprite.baseAngle);
+    }
+    const auto corners =
+        Rectangle{ {}, { 0.1f, 0.2f } }.getPointsPosNormalizedCentered();
+
+    std::vector<Vector<2>> matrixResults(spritesCount * cornersCount);
+    Timer                  matrixTimer;
+    for (size_t i = 0; i < spritesCount; ++i)
+    {
+        const auto& sprite = sprites[i];
+        const auto  transform =
+            MatrixFunctor::getScaleMatrix({ aspect, 1 }) *
+            MatrixFunctor::getShiftMatrix(sprite.position) *
+            MatrixFunctor::getRotateMatrix(sprite.angle) *
+            MatrixFunctor::getRotateMatrix(sprite.baseAngle);
+        for (size_t j = 0; j < cornersCount; ++j)
+        {
+            const auto& corner = corners.columns[j].elements;
+            const auto  point =
+                transform * Vector<3>{ corner[0], corner[1], 1 };
+            matrixResults[i * cornersCount + j] = { point.elements[0],
+                                                    point.elements[1] };
+        }
+    }
+    const auto matrixTime = matrixTimer.elapsed().count();
+
+    std::vector<Vector<2>> affineResults(spritesCount * cornersCount);
+    Timer                  affineTimer;
+    for (size_t i = 0; i < spritesCount; ++i)
+    {
+        const auto& sprite    = sprites[i];
+        auto        transform = Affine2::getScale({ aspect, 1 });
+        transform.compose(Affine2::getShift(sprite.position))
+            .compose(Affine2::getRotation(sprite.angle))
+            .compose(Affine2::getRotationSinCos(sprite.baseAngleSin,
+                                                sprite.baseAngleCos));
+        transformPoints(transform, corners.columns, cornersCount,
+                        &affineResults[i * cornersCount]);
+    }
+    const auto affineTime = affineTimer.elapsed().count();
+
+    myGlfloat maxError{};
+    for (size_t i = 0; i < affineResults.size(); ++i)
+    {
+        const auto difference = affineResults[i] - matrixResults[i];
+        for (const auto coordinate : difference.elements)
+        {
+            maxError = std::max(maxError, std::abs(coordinate));
+        }
+    }
+
+    constexpr auto nanosecondsPerSprite = 1.0e9 / spritesCount;
+    std::cout << "Sprite transform benchmark. Sprites: " << spritesCount
+              << " Matrix: " << matrixTime * nanosecondsPerSprite << " ns"
+              << " Affine2: " << affineTime * nanosecondsPerSprite << " ns"
+              << " Speedup: " << matrixTime / affineTime
+              << " Max error: " << maxError << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,359 @@
+#include "static_gravity_field.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+namespace Model
+{
+
+StaticGravityField::StaticGravityField(const std::list<Star>& stars,
+                                       const Config&          config)
+    : m_config{ config }
+{
+    if (config.levelsCount == 0 || config.cellsPerSide == 0 ||
+        config.innerRadius <= 0 || config.maxRelativeError <= 0)
+    {
+        throw std::runtime_error("Error: wrong gravity field config");
+    }
+
+    m_attractors.reserve(stars.size());
+    for (const auto& star : stars)
+    {
+        m_attractors.push_back({ star.x, star.y, star.m, star.r });
+    }
+    if (m_attractors.empty())
+    {
+        return;
+    }
+
+    for (size_t cells = config.cellsPerSide; cells <= config.maxCellsPerSide;
+         cells *= 2)
+    {
+        build(cells);
+        m_maxRelativeError = measureMaxRelativeError();
+        if (m_maxRelativeError <= config.maxRelativeError)
+        {
+            return;
+        }
+    }
+
+    std::stringstream serr;
+    serr << "Error: gravity field error " << m_maxRelativeError
+         << " is bigger than " << config.maxRelativeError << " with "
+         << m_cellsPerSide << " cells per side";
+    throw std::runtime_error(serr.str());
+}
+
+StaticGravityField::Acceleration StaticGravityField::calcAcceleration(
+    worldCalcType x, worldCalcType y, worldCalcType r) const
+{
+    const auto* level = findLevel(x, y, r);
+    if (level == nullptr)
+    {
+        return calcExactAcceleration(x, y, r);
+    }
+    return interpolate(*level, x, y);
+}
+
+StaticGravityField::Acceleration StaticGravityField::calcExactAcceleration(
+    worldCalcType x, worldCalcType y, worldCalcType r) const
+{
+    Acceleration sum{};
+    for (const auto& attractor : m_attractors)
+    {
+        const auto dx = attractor.x - x;
+        const auto dy = attractor.y - y;
+        if (std::abs(dx) < std::numeric_limits<worldCalcType>::epsilon() &&
+            std::abs(dy) < std::numeric_limits<worldCalcType>::epsilon())
+        {
+            continue;
+        }
+
+        const auto distance{ std::sqrt(dx * dx + dy * dy) };
+        const auto safeDistance{ ((attractor.r + r) < distance)
+                                     ? distance
+                                     : (attractor.r + r) };
+
+        const auto g =
+            Gravity::calcG(Gravity::gravityConstant, attractor.m, safeDistance);
+        sum[0] += g * dx / safeDistance;
+        sum[1] += g * dy / safeDistance;
+    }
+    return sum;
+}
+
+worldCalcType StaticGravityField::getOuterHalfSize() const
+{
+    return m_config.innerRadius *
+           static_cast<worldCalcType>(size_t{ 1 } << m_config.levelsCount);
+}
+
+void StaticGravityField::build(size_t cellsPerSide)
+{
+    m_cellsPerSide = cellsPerSide;
+    m_levels.clear();
+    m_levels.reserve(m_attractors.size() * m_config.levelsCount);
+
+    const size_t nodesPerSide = cellsPerSide + 1;
+    for (size_t j = 0; j < m_attractors.size(); ++j)
+    {
+        const auto& attractor = m_attractors[j];
+        auto        halfSize  = m_config.innerRadius * 2;
+        for (size_t i = 0; i < m_config.levelsCount; ++i, halfSize *= 2)
+        {
+            const auto cellSize =
+                2 * halfSize / static_cast<worldCalcType>(cellsPerSide);
+            Level level{ attractor.x - halfSize, attractor.y - halfSize,
+                         cellSize, j, {} };
+            level.nodes.reserve(nodesPerSide * nodesPerSide);
+            for (size_t line = 0; line < nodesPerSide; ++line)
+            {
+                const auto y =
+                    level.originY + static_cast<worldCalcType>(line) * cellSize;
+                for (size_t column = 0; column < nodesPerSide; ++column)
+                {
+                    const auto x =
+                        level.originX +
+                        static_cast<worldCalcType>(column) * cellSize;
+                    level.nodes.push_back(
+                        calcScaledAcceleration(attractor, x, y));
+                }
+            }
+            m_levels.push_back(std::move(level));
+        }
+    }
+}
+
+const StaticGravityField::Level* StaticGravityField::findLevel(
+    worldCalcType x, worldCalcType y, worldCalcType r) const
+{
+    size_t finestIndex = m_config.levelsCount;
+    size_t attractorIndex{};
+    for (size_t j = 0; j < m_attractors.size(); ++j)
+    {
+        const auto& attractor   = m_attractors[j];
+        const auto  dx          = attractor.x - x;
+        const auto  dy          = attractor.y - y;
+        const auto  innerRadius = std::max(m_config.innerRadius,
+                                          attractor.r + r);
+        if (dx * dx + dy * dy < innerRadius * innerRadius)
+        {
+            return nullptr;
+        }
+
+        // level i contains max(|dx|, |dy|) < innerRadius * 2^(i + 1)
+        const auto distance = std::max(std::abs(dx), std::abs(dy));
+        auto       halfSize = m_config.innerRadius * 2;
+        size_t     index{};
+        while (index < finestIndex && distance >= halfSize)
+        {
+            halfSize *= 2;
+            ++index;
+        }
+        if (index < finestIndex)
+        {
+            finestIndex    = index;
+            attractorIndex = j;
+        }
+    }
+    if (finestIndex == m_config.levelsCount)
+    {
+        return nullptr;
+    }
+    return &m_levels[attractorIndex * m_config.levelsCount + finestIndex];
+}
+
+StaticGravityField::Acceleration StaticGravityField::interpolate(
+    const Level& level, worldCalcType x, worldCalcType y) const
+{
+    const auto cellsCount = static_cast<worldCalcType>(m_cellsPerSide);
+    const auto cellX =
+        std::clamp((x - level.originX) / level.cellSize, 0.0, cellsCount);
+    const auto cellY =
+        std::clamp((y - level.originY) / level.cellSize, 0.0, cellsCount);
+    const auto column =
+        std::min(static_cast<size_t>(cellX), m_cellsPerSide - 1);
+    const auto line = std::min(static_cast<size_t>(cellY), m_cellsPerSide - 1);
+    const auto tx   = cellX - static_cast<worldCalcType>(column);
+    const auto ty   = cellY - static_cast<worldCalcType>(line);
+
+    const size_t nodesPerSide = m_cellsPerSide + 1;
+    const auto&  downLeft     = level.nodes[line * nodesPerSide + column];
+    const auto&  downRight    = level.nodes[line * nodesPerSide + column + 1];
+    const auto&  upLeft       = level.nodes[(line + 1) * nodesPerSide + column];
+    const auto&  upRight = level.nodes[(line + 1) * nodesPerSide + column + 1];
+
+    const auto& owner    = m_attractors[level.attractorIndex];
+    const auto  dx       = owner.x - x;
+    const auto  dy       = owner.y - y;
+    const auto  distance = std::sqrt(dx * dx + dy * dy);
+    const auto  scale    = 1 / (distance * distance * distance);
+
+    Acceleration result;
+    for (size_t i = 0; i < result.size(); ++i)
+    {
+        const auto down = downLeft[i] + (downRight[i] - downLeft[i]) * tx;
+        const auto up   = upLeft[i] + (upRight[i] - upLeft[i]) * tx;
+        result[i]       = (down + (up - down) * ty) * scale;
+    }
+    return result;
+}
+
+StaticGravityField::Acceleration StaticGravityField::calcScaledAcceleration(
+    const Attractor& owner, worldCalcType x, worldCalcType y) const
+{
+    const auto ownerDx = owner.x - x;
+    const auto ownerDy = owner.y - y;
+    const auto ownerDistance{ std::sqrt(ownerDx * ownerDx +
+                                        ownerDy * ownerDy) };
+    const auto ownerDistanceCubed = ownerDistance * ownerDistance *
+                                    ownerDistance;
+
+    Acceleration sum{ Gravity::gravityConstant * owner.m * ownerDx,
+                      Gravity::gravityConstant * owner.m * ownerDy };
+    for (const auto& attractor : m_attractors)
+    {
+        const auto dx = attractor.x - x;
+        const auto dy = attractor.y - y;
+        const auto distanceSquared{ dx * dx + dy * dy };
+        if (&attractor == &owner ||
+            distanceSquared < std::numeric_limits<worldCalcType>::epsilon())
+        {
+            continue;
+        }
+        const auto k = Gravity::gravityConstant * attractor.m *
+                       ownerDistanceCubed /
+                       (distanceSquared * std::sqrt(distanceSquared));
+        sum[0] += k * dx;
+        sum[1] += k * dy;
+    }
+    return sum;
+}
+
+worldCalcType StaticGravityField::calcRelativeError(
+    worldCalcType x, worldCalcType y, worldCalcType r,
+    const Acceleration& value) const
+{
+    const auto    exact = calcExactAcceleration(x, y, r);
+    worldCalcType scale{};
+    for (const auto& attractor : m_attractors)
+    {
+        const auto dx = attractor.x - x;
+        const auto dy = attractor.y - y;
+        const auto distanceSquared{ dx * dx + dy * dy };
+        if (distanceSquared > std::numeric_limits<worldCalcType>::epsilon())
+        {
+            scale += Gravity::gravityConstant * attractor.m / distanceSquared;
+        }
+    }
+    if (scale < std::numeric_limits<worldCalcType>::min())
+    {
+        return 0;
+    }
+    return std::hypot(value[0] - exact[0], value[1] - exact[1]) / scale;
+}
+
+worldCalcType StaticGravityField::measureMaxRelativeError() const
+{
+    // bilinear interpolation error is the biggest in cell center
+    worldCalcType maxError{};
+    for (const auto& level : m_levels)
+    {
+        for (size_t line = 0; line < m_cellsPerSide; ++line)
+        {
+            const auto y = level.originY +
+                           (static_cast<worldCalcType>(line) + 0.5) *
+                               level.cellSize;
+            for (size_t column = 0; column < m_cellsPerSide; ++column)
+            {
+                const auto x = level.originX +
+                               (static_cast<worldCalcType>(column) + 0.5) *
+                                   level.cellSize;
+                if (findLevel(x, y, 0) != &level)
+                {
+                    continue;
+                }
+                const auto error =
+                    calcRelativeError(x, y, 0, interpolate(level, x, y));
+                maxError = std::max(maxError, error);
+            }
+        }
+    }
+    return maxError;
+}
+
+int runGravityFieldBenchmark(const std::list<Star>&            stars,
+                             const StaticGravityField::Config& config)
+{
+    Timer                    buildTimer;
+    const StaticGravityField field{ stars, config };
+    const auto               buildTime = buildTimer.elapsed().count();
+    if (field.empty())
+    {
+        std::cerr << "Error: no stars for gravity field benchmark"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    using Acceleration = StaticGravityField::Acceleration;
+
+    constexpr size_t        pointsCount{ 1'000'000 };
+    constexpr worldCalcType gameAreaHalfSize{ 8000 };
+    constexpr worldCalcType objectRadius{ Asteroid::defaultR };
+
+    // fixed seed, so every run uses the same points
+    std::mt19937                                  generator{ 1 };
+    std::uniform_real_distribution<worldCalcType> distribution{
+        -gameAreaHalfSize, gameAreaHalfSize
+    };
+    std::vector<std::array<worldCalcType, 2>> points(pointsCount);
+    for (auto& point : points)
+    {
+        point = { distribution(generator), distribution(generator) };
+    }
+
+    std::vector<Acceleration> exactResults(pointsCount);
+    Timer                     exactTimer;
+    for (size_t i = 0; i < pointsCount; ++i)
+    {
+        exactResults[i] = field.calcExactAcceleration(
+            points[i][0], points[i][1], objectRadius);
+    }
+    const auto exactTime = exactTimer.elapsed().count();
+
+    std::vector<Acceleration> fieldResults(pointsCount);
+    Timer                     fieldTimer;
+    for (size_t i = 0; i < pointsCount; ++i)
+    {
+        fieldResults[i] =
+            field.calcAcceleration(points[i][0], points[i][1], objectRadius);
+    }
+    const auto fieldTime = fieldTimer.elapsed().count();
+
+    worldCalcType maxError{};
+    for (size_t i = 0; i < pointsCount; ++i)
+    {
+        const auto error = field.calcRelativeError(
+            points[i][0], points[i][1], objectRadius, fieldResults[i]);
+        maxError = std::max(maxError, error);
+    }
+
+    constexpr auto nanosecondsPerPoint = 1.0e9 / pointsCount;
+    std::cout << "Gravity field benchmark. Stars: " << stars.size()
+              << " Points: " << pointsCount
+              << " Cells per side: " << field.getCellsPerSide()
+              << " Build time: " << buildTime
+              << " Exact: " << exactTime * nanosecondsPerPoint << " ns"
+              << " Field: " << fieldTime * nanosecondsPerPoint << " ns"
+              << " Max relative error: " << maxError << " (build check "
+              << field.getMaxRelativeError() << ", bound "
+              << config.maxRelativeError << ")" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+} // namespace Model
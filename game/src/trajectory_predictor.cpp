@@ -0,0 +1,297 @@
+#include "trajectory_predictor.hpp"
+#include "world.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace Model
+{
+
+std::optional<std::array<worldCalcType, 2>> TrajectoryPredictor::Trajectory::
+    getPosition(time_point_t time) const
+{
+    const auto next = std::lower_bound(
+        points.begin(), points.end(), time,
+        [](const Point& point, time_point_t t) { return point.time < t; });
+    if (next == points.end() || (next == points.begin() && next->time != time))
+    {
+        return std::nullopt;
+    }
+    if (next->time == time)
+    {
+        return std::array<worldCalcType, 2>{ next->x, next->y };
+    }
+    const auto      previous = std::prev(next);
+    const seconds_t interval = next->time - previous->time;
+    const seconds_t passed   = time - previous->time;
+    const auto      part     = passed / interval;
+    return std::array<worldCalcType, 2>{
+        previous->x + (next->x - previous->x) * part,
+        previous->y + (next->y - previous->y) * part
+    };
+}
+
+TrajectoryPredictor::TrajectoryPredictor(const Config& config)
+    : m_config{ config }
+    , m_trajectory{ std::make_shared<Trajectory>() }
+{
+    m_worker = std::thread{ &TrajectoryPredictor::run, this };
+}
+
+TrajectoryPredictor::~TrajectoryPredictor()
+{
+    {
+        std::lock_guard lock{ m_mutex };
+        m_isStopping = true;
+    }
+    m_jobAdded.notify_one();
+    m_worker.join();
+}
+
+void TrajectoryPredictor::update(const World& world)
+{
+    const auto& ship    = *world.userShipPtr;
+    const auto  nowTime = world.lastUpdateTime;
+
+    std::array<worldCalcType, 5> thrust{
+        ship.mainEngine.getCurrentAbsoluteForce()
+    };
+    std::transform(
+        ship.sideEngines.begin(), ship.sideEngines.end(), thrust.begin() + 1,
+        [](const RocketEngine& engine) {
+            return engine.getCurrentAbsoluteForce();
+        });
+
+    const auto trajectory = getTrajectory();
+    const auto position   = trajectory->getPosition(nowTime);
+    const auto isDeviated =
+        !position ||
+        std::hypot(position->at(0) - ship.x, position->at(1) - ship.y) >
+            m_config.maxDeviation;
+    // time goes back after reset of game
+    const auto isFull =
+        thrust != m_lastThrust || isDeviated || nowTime < m_lastNowTime;
+    m_lastThrust  = thrust;
+    m_lastNowTime = nowTime;
+
+    std::optional<State> state;
+    if (isFull)
+    {
+        const auto toBody = [](const PhysicalObject& object) {
+            return Body{ object.x,  object.y, object.vx, object.vy,
+                         object.m,  object.r, object.k1, object.k2, {} };
+        };
+        state.emplace();
+        state->time = nowTime;
+        state->ship = toBody(ship);
+        for (const auto& planet : world.planets)
+        {
+            state->planets.push_back(toBody(planet));
+            state->planets.back().orbit = planet.orbit;
+        }
+        state->planetsAccelerations.resize(state->planets.size());
+        for (const auto& star : world.stars)
+        {
+            state->stars.push_back(toBody(star));
+        }
+    }
+
+    {
+        std::lock_guard lock{ m_mutex };
+        // pending full job is kept until worker takes it
+        if (state || !m_pendingJob || !m_pendingJob->state)
+        {
+            m_pendingJob = Job{ std::move(state), nowTime };
+        }
+        else
+        {
+            m_pendingJob->nowTime = nowTime;
+        }
+    }
+    m_jobAdded.notify_one();
+}
+
+std::shared_ptr<const TrajectoryPredictor::Trajectory> TrajectoryPredictor::
+    getTrajectory() const
+{
+    std::lock_guard lock{ m_mutex };
+    return m_trajectory;
+}
+
+TrajectoryPredictor::Metrics TrajectoryPredictor::getMetrics() const
+{
+    std::lock_guard lock{ m_mutex };
+    auto            metrics = m_metrics;
+    metrics.publishAge      = Timer::clock_t::now() - m_publishTime;
+    return metrics;
+}
+
+void TrajectoryPredictor::run()
+{
+    std::optional<time_point_t> unfinishedJobTime;
+    while (true)
+    {
+        Job job;
+        {
+            std::unique_lock lock{ m_mutex };
+            m_jobAdded.wait(lock, [this, &unfinishedJobTime] {
+                return m_isStopping || m_pendingJob || unfinishedJobTime;
+            });
+            if (m_isStopping)
+            {
+                return;
+            }
+            if (m_pendingJob)
+            {
+                job = std::move(*m_pendingJob);
+                m_pendingJob.reset();
+            }
+            else
+            {
+                job.nowTime = *unfinishedJobTime;
+            }
+        }
+
+        const auto isFull = job.state.has_value();
+        Timer      jobTimer;
+        processJob(job);
+        const auto jobTime          = jobTimer.elapsed();
+        const auto isBudgetExceeded = jobTime >= m_config.timeBudget;
+        unfinishedJobTime =
+            isBudgetExceeded ? std::optional{ job.nowTime } : std::nullopt;
+        publish(job.nowTime, isFull, jobTime, isBudgetExceeded);
+    }
+}
+
+void TrajectoryPredictor::processJob(Job& job)
+{
+    if (job.state)
+    {
+        m_tailState = std::move(*job.state);
+        m_baseTime  = m_tailState.time;
+        m_points.clear();
+        m_points.push_back(
+            { m_tailState.time, m_tailState.ship.x, m_tailState.ship.y });
+        m_isCalculated = true;
+    }
+    if (!m_isCalculated)
+    {
+        return;
+    }
+
+    // one point before now is kept for interpolation
+    while (m_points.size() > 1 && m_points[1].time <= job.nowTime)
+    {
+        m_points.pop_front();
+    }
+
+    Timer      budgetTimer;
+    const auto endTime = job.nowTime + m_config.horizon;
+    while (m_tailState.time < endTime &&
+           budgetTimer.elapsed() < m_config.timeBudget)
+    {
+        // budget is checked once per sample, it is much longer than step
+        while (m_tailState.time - m_points.back().time <
+               m_config.samplePeriod)
+        {
+            step(m_tailState);
+        }
+        m_points.push_back(
+            { m_tailState.time, m_tailState.ship.x, m_tailState.ship.y });
+    }
+}
+
+void TrajectoryPredictor::step(State& state) const
+{
+    const auto dt = static_cast<worldCalcType>(m_config.step.count());
+
+    // forces of the same model as World uses, without stars gravity grid
+    const auto calcAcceleration = [&state](const Body& body) {
+        std::array<worldCalcType, 2> force{
+            Resist::calcFresist(body.vx, body.k1, body.k2),
+            Resist::calcFresist(body.vy, body.k1, body.k2)
+        };
+        const auto addGravity = [&body, &force](const Body& attractor) {
+            const auto dx       = attractor.x - body.x;
+            const auto dy       = attractor.y - body.y;
+            const auto distance = std::sqrt(dx * dx + dy * dy);
+            if (distance < std::numeric_limits<worldCalcType>::epsilon())
+            {
+                return;
+            }
+            const auto safeDistance =
+                std::max(distance, body.r + attractor.r);
+            const auto absoluteForce =
+                Gravity::calcFgravity(body.m, attractor.m, safeDistance);
+            force[0] += dx / safeDistance * absoluteForce;
+            force[1] += dy / safeDistance * absoluteForce;
+        };
+        std::for_each(state.stars.begin(), state.stars.end(), addGravity);
+        std::for_each(state.planets.begin(), state.planets.end(), addGravity);
+        return std::array<worldCalcType, 2>{ force[0] / body.m,
+                                             force[1] / body.m };
+    };
+
+    const auto move = [dt](Body& body, std::array<worldCalcType, 2> a) {
+        const auto newVX = Motion::calcNextV(body.vx, a[0], dt);
+        const auto newVY = Motion::calcNextV(body.vy, a[1], dt);
+        body.x += Motion::calcDs(body.vx, newVX, dt);
+        body.y += Motion::calcDs(body.vy, newVY, dt);
+        body.vx = newVX;
+        body.vy = newVY;
+    };
+
+    // all accelerations are taken from positions before the step
+    for (size_t i = 0; i < state.planets.size(); ++i)
+    {
+        const auto& planet = state.planets[i];
+        state.planetsAccelerations[i] = planet.orbit
+                                            ? std::array<worldCalcType, 2>{}
+                                            : calcAcceleration(planet);
+    }
+    move(state.ship, calcAcceleration(state.ship));
+
+    state.time = std::chrono::time_point_cast<time_point_t::duration>(
+        state.time + m_config.step);
+    for (size_t i = 0; i < state.planets.size(); ++i)
+    {
+        auto& planet = state.planets[i];
+        if (planet.orbit)
+        {
+            const auto orbitState = planet.orbit->getState(state.time);
+            planet.x              = orbitState.x;
+            planet.y              = orbitState.y;
+            planet.vx             = orbitState.vx;
+            planet.vy             = orbitState.vy;
+        }
+        else
+        {
+            move(planet, state.planetsAccelerations[i]);
+        }
+    }
+}
+
+void TrajectoryPredictor::publish(time_point_t nowTime, bool isFull,
+                                  seconds_t jobTime, bool isBudgetExceeded)
+{
+    auto trajectory = std::make_shared<Trajectory>();
+    trajectory->points.assign(m_points.begin(), m_points.end());
+    trajectory->baseTime = m_baseTime;
+
+    std::lock_guard lock{ m_mutex };
+    m_trajectory  = std::move(trajectory);
+    m_publishTime = Timer::clock_t::now();
+
+    m_metrics.lastJobTime = jobTime;
+    m_metrics.maxJobTime  = std::max(m_metrics.maxJobTime, jobTime);
+    m_metrics.staleness   = nowTime - m_baseTime;
+    m_metrics.coverage    = m_points.empty()
+                                ? seconds_t{}
+                                : seconds_t{ m_points.back().time - nowTime };
+    ++(isFull ? m_metrics.fullRecalculations : m_metrics.extensions);
+    if (isBudgetExceeded)
+    {
+        ++m_metrics.budgetExceededCount;
+    }
+}
+
+} // namespace Model
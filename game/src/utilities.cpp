@@ -70,9 +70,21 @@ void normalizeLoopDuration(
     std::this_thread::sleep_for(timeToWaitDouble);
 }
 
+static std::uint32_t randomSeed{ std::random_device{}() };
+static std::mt19937  mersenne(randomSeed);
+
 int getRandom(int lowRange, int highRange)
 {
-    static std::random_device rd;
-    static std::mt19937       mersenne(rd());
     return ((mersenne()) % (highRange - lowRange + 1) + lowRange);
 }
+
+void setRandomSeed(std::uint32_t seed)
+{
+    randomSeed = seed;
+    mersenne.seed(seed);
+}
+
+std::uint32_t getRandomSeed()
+{
+    return randomSeed;
+}
@@ -1,6 +1,9 @@
 #include "world.hpp"
 #include "collision_detection.hpp"
 #include "global.hpp"
+#include "logger.hpp"
+#include "metrics_registry.hpp"
+#include "trace.hpp"
 #include <algorithm>
 #include <iostream>
 
@@ -9,6 +12,9 @@ namespace Model
 
 World::World(std::chrono::time_point<clock_t> initialTime)
     : lastUpdateTime{ initialTime }
+    , lastAsteroidSpawnTime{ initialTime }
+    , lastInputTime{ initialTime }
+    , targetTime{ initialTime }
 {
     rockets.push_back({});
     userShipPtr    = &rockets.front();
@@ -99,6 +105,8 @@ World::World(std::chrono::time_point<clock_t> initialTime)
 
     stars.push_back({});
     stars.front().angleSpeed = 0.1;
+
+    updateSpatialIndex();
 }
 
 void World::getUserRocketEvents(const WorldEvents& events)
@@ -136,12 +144,12 @@ void World::getUserRocketEvents(const WorldEvents& events)
         {
             auto midX = userShipPtr->x;
             auto midY = userShipPtr->y;
-#ifdef DEBUG_CONFIGURATION
-            std::clog << "Shout \n";
-#endif
-            outEvents.push_back(
-                { midX, midY, lastUpdateTime, OutEvent::Type::shoot });
-            bullets.push_back(bullet);
+            OM_LOG(debug, world, "Shout");
+            if (bullets.push(bullet))
+            {
+                outEvents.push_back(
+                    { midX, midY, lastUpdateTime, OutEvent::Type::shoot });
+            }
         }
     }
 
@@ -202,12 +210,184 @@ std::array<worldCalcType, 2> World::calcSumGravityForceToObject(
         sumForce[1] += vectorOfGravityForce[1];
         return sumForce;
     };
-    std::for_each(stars.begin(), stars.end(), addForceToOnePlanet);
+    if (starsGravityField.empty())
+    {
+        std::for_each(stars.begin(), stars.end(), addForceToOnePlanet);
+    }
+    else
+    {
+        const auto acceleration =
+            starsGravityField.calcAcceleration(obj.x, obj.y, obj.r);
+        sumForce[0] += acceleration[0] * obj.m;
+        sumForce[1] += acceleration[1] * obj.m;
+    }
 
     std::for_each(planets.begin(), planets.end(), addForceToOnePlanet);
     return sumForce;
 }
 
+void World::enableStarsGravityField(const StaticGravityField::Config& config)
+{
+    starsGravityField = StaticGravityField{ stars, config };
+}
+
+void World::setPlanetsOnRails(worldCalcType maxPerturbationRatio)
+{
+    planetsRailsMaxPerturbation = maxPerturbationRatio;
+    lastRailsCheckTime          = time_point_t{};
+    for (auto& planet : planets)
+    {
+        planet.orbit.reset();
+    }
+}
+
+static worldCalcType getGravityAccelerationFirstObjectToSecond(
+    const PhysicalObject& obj1, const PhysicalObject& obj2)
+{
+    const auto dx = obj2.x - obj1.x;
+    const auto dy = obj2.y - obj1.y;
+
+    const auto distance{ std::sqrt(dx * dx + dy * dy) };
+
+    const auto safeDistance{ ((obj1.r + obj2.r) < distance)
+                                 ? distance
+                                 : (obj1.r + obj2.r) };
+    return Gravity::calcG(Gravity::gravityConstant, obj2.m, safeDistance);
+}
+
+worldCalcType World::getPlanetsRailsMaxPerturbation() const
+{
+    return std::max(planetsRailsMaxPerturbation,
+                    timeWarpStrategy.railsMaxPerturbation);
+}
+
+void World::updatePlanetsRails(worldCalcType maxPerturbationRatio)
+{
+    for (auto& planet : planets)
+    {
+        // the strongest star is center of orbit, the rest is perturbation
+        const Star*   attractor{};
+        worldCalcType attractorAcceleration{};
+        worldCalcType perturbation{};
+        for (const auto& star : stars)
+        {
+            const auto acceleration =
+                getGravityAccelerationFirstObjectToSecond(planet, star);
+            if (acceleration > attractorAcceleration)
+            {
+                perturbation += attractorAcceleration;
+                attractorAcceleration = acceleration;
+                attractor             = &star;
+            }
+            else
+            {
+                perturbation += acceleration;
+            }
+        }
+        for (const auto& otherPlanet : planets)
+        {
+            if (&otherPlanet != &planet)
+            {
+                perturbation +=
+                    getGravityAccelerationFirstObjectToSecond(planet,
+                                                              otherPlanet);
+            }
+        }
+
+        const auto limit = maxPerturbationRatio * attractorAcceleration;
+        if (attractor == nullptr || perturbation > limit)
+        {
+            planet.orbit.reset();
+            continue;
+        }
+        // half of limit to enter, so planet doesn't switch on every check
+        if (planet.orbit || perturbation * 2 > limit)
+        {
+            continue;
+        }
+
+        auto orbit = KeplerOrbit::fromState(
+            { planet.x, planet.y, planet.vx, planet.vy }, attractor->x,
+            attractor->y, Gravity::gravityConstant * attractor->m,
+            lastUpdateTime);
+        // gravity near star is limited, so orbit should not come close to it
+        if (orbit && orbit->getPeriapsis() > attractor->r + planet.r)
+        {
+            planet.orbit = orbit;
+        }
+    }
+}
+
+World::TimeWarpStrategy World::getTimeWarpStrategy(worldCalcType factor)
+{
+    // small factors only add steps, bigger ones make steps longer and check
+    // collisions rarely with sweep, so cost grows much slower than factor
+    if (factor <= 4)
+    {
+        return {};
+    }
+    TimeWarpStrategy strategy;
+    strategy.stepScale            = std::min<worldCalcType>(factor / 4, 16);
+    strategy.integrator           = PhysicalObject::Integrator::symplecticEuler;
+    strategy.railsMaxPerturbation = 0.05;
+    if (factor >= 100)
+    {
+        strategy.stepsPerCollisionCheck = 4;
+    }
+    return strategy;
+}
+
+bool World::setTimeWarp(worldCalcType factor)
+{
+    // NaN is 1 too
+    factor = factor >= 1 ? std::min(factor, maxTimeWarp) : 1;
+    const auto isAllowed =
+        factor == 1 || !isUserShipNearBody(getTimeWarpStrategy(factor));
+    timeWarp         = isAllowed ? factor : 1;
+    timeWarpStrategy = getTimeWarpStrategy(timeWarp);
+    if (getPlanetsRailsMaxPerturbation() <= 0)
+    {
+        for (auto& planet : planets)
+        {
+            planet.orbit.reset();
+        }
+    }
+    return isAllowed;
+}
+
+bool World::isUserShipNearBody(const TimeWarpStrategy& strategy) const
+{
+    // guard runs every step, so look ahead until the next collision check
+    const auto&     userShip = *userShipPtr;
+    const seconds_t lookAheadTime =
+        dt * strategy.stepScale *
+        static_cast<worldCalcType>(strategy.stepsPerCollisionCheck);
+    const auto isNear = [&](const PhysicalObject& body) {
+        const auto dx           = userShip.x - body.x;
+        const auto dy           = userShip.y - body.y;
+        const auto dvx          = userShip.vx - body.vx;
+        const auto dvy          = userShip.vy - body.vy;
+        const auto speedSquared = dvx * dvx + dvy * dvy;
+        // closest approach on straight path
+        const auto approachTime =
+            speedSquared > 0 ? std::clamp(-(dx * dvx + dy * dvy) / speedSquared,
+                                          worldCalcType{ 0 },
+                                          lookAheadTime.count())
+                             : 0;
+        const auto closestX = dx + dvx * approachTime;
+        const auto closestY = dy + dvy * approachTime;
+        const auto surfaceDistance =
+            std::sqrt(closestX * closestX + closestY * closestY) -
+            (std::max(body.width, body.height) +
+             std::max(userShip.width, userShip.height)) /
+                2;
+        return surfaceDistance < timeWarpSafeDistance;
+    };
+    return std::any_of(planets.begin(), planets.end(), isNear) ||
+           std::any_of(stars.begin(), stars.end(), isNear) ||
+           std::any_of(asteroids.begin(), asteroids.end(), isNear);
+}
+
 void World::applyAllExternalForceToOneObject(PhysicalObject& object)
 {
     const auto vectorOfGravityForce = calcSumGravityForceToObject(object);
@@ -228,28 +408,30 @@ void World::applyAllExternalForceToOneObject(PhysicalObject& object)
                               externalForceMoments);
 }
 
-bool World::checkCollision(const Bullet& obj1, const Star& obj2)
+bool World::checkCollision(const Bullet& obj1, const PhysicalObject& obj2,
+                           OutEvent::Type collisionType)
 {
-    return World::checkCollision(obj1, static_cast<Planet>(obj2));
-}
-
-bool World::checkCollision(const Bullet& obj1, const Planet& obj2)
-{
-    const auto isCollided = CollisionDetection::isCollidedAABB(
-        { { obj1.x, obj1.y }, { obj1.width, obj1.height } },
-        { { obj2.x, obj2.y }, { obj2.width, obj2.height } });
+    const auto sweepTime = collisionSweepTime.count();
+    const auto isCollided =
+        sweepTime > 0
+            ? CollisionDetection::isCollidedSweptAABB(
+                  { { obj1.x, obj1.y }, { obj1.width, obj1.height } },
+                  { obj1.vx * sweepTime, obj1.vy * sweepTime },
+                  { { obj2.x, obj2.y }, { obj2.width, obj2.height } },
+                  { obj2.vx * sweepTime, obj2.vy * sweepTime })
+            : CollisionDetection::isCollidedAABB(
+                  { { obj1.x, obj1.y }, { obj1.width, obj1.height } },
+                  { { obj2.x, obj2.y }, { obj2.width, obj2.height } });
 
     if (isCollided)
     {
         auto midX = (obj1.x + obj2.x) / 2;
         auto midY = (obj1.y + obj2.y) / 2;
-#ifdef DEBUG_CONFIGURATION
-        std::clog << "\n"
-                  << "!!!Collision happened between: \n"
-                  << obj1 << obj2 << "\n";
-#endif
-        outEvents.push_back(
-            { midX, midY, lastUpdateTime, OutEvent::Type::hit });
+        OM_LOG(debug, world,
+               "!!!Collision happened between bullet: \n"
+                   << "X: " << obj1.x << "Y: " << obj1.y << '\n'
+                   << obj2);
+        outEvents.push_back({ midX, midY, lastUpdateTime, collisionType });
     }
     return isCollided;
 }
@@ -257,19 +439,24 @@ bool World::checkCollision(const Bullet& obj1, const Planet& obj2)
 bool World::checkCollision(const PhysicalObject& obj1,
                            const PhysicalObject& obj2)
 {
-    const auto isCollided = CollisionDetection::isCollidedAABB(
-        { { obj1.x, obj1.y }, { obj1.width, obj1.height } },
-        { { obj2.x, obj2.y }, { obj2.width, obj2.height } });
+    const auto sweepTime = collisionSweepTime.count();
+    const auto isCollided =
+        sweepTime > 0
+            ? CollisionDetection::isCollidedSweptAABB(
+                  { { obj1.x, obj1.y }, { obj1.width, obj1.height } },
+                  { obj1.vx * sweepTime, obj1.vy * sweepTime },
+                  { { obj2.x, obj2.y }, { obj2.width, obj2.height } },
+                  { obj2.vx * sweepTime, obj2.vy * sweepTime })
+            : CollisionDetection::isCollidedAABB(
+                  { { obj1.x, obj1.y }, { obj1.width, obj1.height } },
+                  { { obj2.x, obj2.y }, { obj2.width, obj2.height } });
 
     if (isCollided)
     {
         auto midX = (obj1.x + obj2.x) / 2;
         auto midY = (obj1.y + obj2.y) / 2;
-#ifdef DEBUG_CONFIGURATION
-        std::clog << "\n"
-                  << "!!!Collision happened between: \n"
-                  << obj1 << obj2 << "\n";
-#endif
+        OM_LOG(debug, world,
+               "!!!Collision happened between: \n" << obj1 << obj2);
         outEvents.push_back(
             { midX, midY, lastUpdateTime, OutEvent::Type::explosion });
     }
@@ -278,65 +465,40 @@ bool World::checkCollision(const PhysicalObject& obj1,
 
 void World::detectCollisionsBullets()
 {
-    auto nextBullet1 = bullets.begin();
-    for (auto bullet1 = nextBullet1; bullet1 != bullets.end();
-         bullet1      = nextBullet1)
-    {
-        bool stopCurrentIter = false;
-        ++nextBullet1;
-
-        for (auto rocket2 = rockets.begin(); rocket2 != rockets.end();
-             ++rocket2)
+    bullets.removeIf([this](const Bullet& bullet) {
+        for (auto rocket = rockets.begin(); rocket != rockets.end(); ++rocket)
         {
-            if (checkCollision(*bullet1, *rocket2))
+            if (checkCollision(bullet, *rocket, OutEvent::Type::explosion))
             {
-                bullets.erase(bullet1);
-                rockets.erase(rocket2);
-                stopCurrentIter = true;
-                break;
+                rockets.erase(rocket);
+                return true;
             }
         }
-        if (stopCurrentIter)
-        {
-            continue;
-        }
         for (auto asteroid = asteroids.begin(); asteroid != asteroids.end();
              ++asteroid)
         {
-            if (checkCollision(*bullet1, *asteroid))
+            if (checkCollision(bullet, *asteroid, OutEvent::Type::explosion))
             {
-                bullets.erase(bullet1);
                 asteroids.erase(asteroid);
-                stopCurrentIter = true;
-                break;
+                return true;
             }
         }
-        if (stopCurrentIter)
-        {
-            continue;
-        }
-        for (auto planet = planets.begin(); planet != planets.end(); ++planet)
+        for (const auto& planet : planets)
         {
-            if (checkCollision(*bullet1, *planet))
+            if (checkCollision(bullet, planet, OutEvent::Type::hit))
             {
-                bullets.erase(bullet1);
-                stopCurrentIter = true;
-                break;
+                return true;
             }
         }
-        if (stopCurrentIter)
+        for (const auto& star : stars)
         {
-            continue;
-        }
-        for (auto star = stars.begin(); star != stars.end(); ++star)
-        {
-            if (checkCollision(*bullet1, *star))
+            if (checkCollision(bullet, star, OutEvent::Type::hit))
             {
-                bullets.erase(bullet1);
-                break;
+                return true;
             }
         }
-    }
+        return false;
+    });
 }
 
 void World::detectCollisionsRockets()
@@ -496,14 +658,14 @@ void World::detectCollisions()
 
 void World::asteroidFunRandomizer()
 {
-    static time_point_t        lastTime{ lastUpdateTime };
     static constexpr seconds_t period{ 15 };
     static constexpr size_t    maxAmountOfAsteroids{ 50 };
-    const auto                 dt = lastUpdateTime - lastTime;
+    const auto                 dt = lastUpdateTime - lastAsteroidSpawnTime;
 
     if ((dt > period) && (asteroids.size() < maxAmountOfAsteroids))
     {
-        auto isAddAsteroidOk = false;
+        auto                             isAddAsteroidOk = false;
+        std::vector<SpatialIndex::Entry> overlappedObjects;
         while (!isAddAsteroidOk)
         {
             const auto x = static_cast<worldCalcType>(getRandom(-6000, 6000));
@@ -519,6 +681,12 @@ void World::asteroidFunRandomizer()
             if (distance < 300 || distanceToUser < 800)
                 continue;
 
+            // new asteroid shouldn't appear inside other object
+            spatialIndex.queryRadius(x, y, Asteroid::defaultR,
+                                     overlappedObjects);
+            if (!overlappedObjects.empty())
+                continue;
+
             const auto absoluteV = std::sqrt(Gravity::gravityConstant *
                                              Planet::defaultM / distance);
             const auto sinA      = x / distance;
@@ -530,65 +698,183 @@ void World::asteroidFunRandomizer()
             asteroids.back().vx         = absoluteV * cosA;
             asteroids.back().vy         = absoluteV * sinA;
             asteroids.back().angleSpeed = (x + y) / 9000;
-            lastTime                    = lastUpdateTime;
+            lastAsteroidSpawnTime       = lastUpdateTime;
             isAddAsteroidOk             = true;
         }
     }
 }
 
+void World::updateSpatialIndex()
+{
+    spatialIndex.update(rockets, asteroids, planets, stars);
+}
+
+void World::emitCollisionParticles()
+{
+    for (const auto& event : outEvents)
+    {
+        if (event.type == OutEvent::Type::hit)
+        {
+            particles.spawn({ ParticleSystem::Type::hit, event.x, event.y, 0,
+                              event.sizeX, event.sizeY, 1, event.time,
+                              ParticleSystem::hitTimeToLive });
+        }
+        else if (event.type == OutEvent::Type::explosion)
+        {
+            particles.spawn({ ParticleSystem::Type::explosion, event.x,
+                              event.y, 0, event.sizeX, event.sizeY, 1,
+                              event.time,
+                              ParticleSystem::explosionTimeToLive });
+        }
+    }
+}
+
 bool World::update(std::chrono::time_point<clock_t> nowTime,
                    const WorldEvents&               events)
 {
+    using om::MetricsRegistry;
+    static auto& updateTime =
+        MetricsRegistry::getHistogram("physics.update_us");
+    static auto& forcesTime =
+        MetricsRegistry::getHistogram("physics.forces_us");
+    static auto& integrationTime =
+        MetricsRegistry::getHistogram("physics.integration_us");
+    static auto& collisionsTime =
+        MetricsRegistry::getHistogram("physics.collisions_us");
+    static auto& particlesTime =
+        MetricsRegistry::getHistogram("physics.particles_us");
+    static auto& spatialIndexTime =
+        MetricsRegistry::getHistogram("physics.spatial_index_us");
+    static auto& stepsCount = MetricsRegistry::getCounter("physics.steps");
+    MetricsRegistry::ScopedTimer updateTimer{ updateTime };
+    OM_TRACE_SCOPE("World::update");
+
     outEvents.clear();
+    auto timeWarpEventIt = events.find(Events::userCommandTimeWarp);
+    if (timeWarpEventIt != events.end())
+    {
+        setTimeWarp(timeWarpEventIt->second[0]);
+    }
     getUserRocketEvents(events);
     enemiesForward();
     asteroidFunRandomizer();
 
-    while (lastUpdateTime + dt < nowTime)
+    if (timeWarp > 1)
     {
-        lastUpdateTime =
-            std::chrono::time_point_cast<std::chrono::steady_clock::duration>(
-                lastUpdateTime + dt);
+        targetTime += std::chrono::duration_cast<clock_t::duration>(
+            (nowTime - lastInputTime) * timeWarp);
+    }
+    else
+    {
+        targetTime += nowTime - lastInputTime;
+    }
+    lastInputTime = nowTime;
 
-        for (auto& rocket : rockets)
-        {
-            applyAllExternalForceToOneObject(rocket);
-        }
-        for (auto& planet : planets)
+    const seconds_t stepDt = dt * timeWarpStrategy.stepScale;
+    while (lastUpdateTime + stepDt < targetTime)
+    {
+        OM_TRACE_SCOPE("World::step");
+        if (timeWarp > 1 && isUserShipNearBody(timeWarpStrategy))
         {
-            applyAllExternalForceToOneObject(planet);
+            // rest of warped time is dropped, player gets control back
+            setTimeWarp(1);
+            targetTime = lastUpdateTime;
+            break;
         }
-        for (auto& asteroid : asteroids)
+
+        const auto railsMaxPerturbation = getPlanetsRailsMaxPerturbation();
+        if (railsMaxPerturbation > 0 &&
+            lastUpdateTime - lastRailsCheckTime >= railsCheckPeriod)
         {
-            applyAllExternalForceToOneObject(asteroid);
+            updatePlanetsRails(railsMaxPerturbation);
+            lastRailsCheckTime = lastUpdateTime;
         }
-        for (auto& rocket : rockets)
+
+        lastUpdateTime =
+            std::chrono::time_point_cast<std::chrono::steady_clock::duration>(
+                lastUpdateTime + stepDt);
+        stepsCount.add();
+
         {
-            rocket.update(dt);
+            MetricsRegistry::ScopedTimer forcesTimer{ forcesTime };
+            for (auto& rocket : rockets)
+            {
+                applyAllExternalForceToOneObject(rocket);
+            }
+            for (auto& planet : planets)
+            {
+                if (!planet.orbit)
+                {
+                    applyAllExternalForceToOneObject(planet);
+                }
+            }
+            for (auto& asteroid : asteroids)
+            {
+                applyAllExternalForceToOneObject(asteroid);
+            }
         }
-        for (auto& planet : planets)
         {
-            planet.update(dt);
+            MetricsRegistry::ScopedTimer integrationTimer{ integrationTime };
+            const auto integrator = timeWarpStrategy.integrator;
+            for (auto& rocket : rockets)
+            {
+                rocket.update(stepDt, integrator);
+                rocket.emitClouds(particles);
+            }
+            for (auto& planet : planets)
+            {
+                if (planet.orbit)
+                {
+                    planet.moveOnRails(lastUpdateTime, stepDt);
+                }
+                else
+                {
+                    planet.update(stepDt, integrator);
+                }
+            }
+            for (auto& asteroid : asteroids)
+            {
+                asteroid.update(stepDt, integrator);
+            }
+            bullets.update(stepDt);
         }
-        for (auto& asteroid : asteroids)
+
+        if (++stepsSinceCollisionCheck <
+            timeWarpStrategy.stepsPerCollisionCheck)
         {
-            asteroid.update(dt);
+            continue;
         }
-        for (auto& bullet : bullets)
+        // objects move a lot between checks in warp, so paths are swept
+        collisionSweepTime = timeWarpStrategy.stepScale > 1
+                                 ? stepDt * stepsSinceCollisionCheck
+                                 : seconds_t{};
+        stepsSinceCollisionCheck = 0;
         {
-            bullet.update(dt);
+            MetricsRegistry::ScopedTimer collisionsTimer{ collisionsTime };
+            OM_TRACE_SCOPE("World::detectCollisions");
+            detectCollisions();
         }
-        detectCollisions();
 
         if (gameOver)
         {
+            // index shouldn't keep destroyed objects
+            updateSpatialIndex();
             return false;
         }
     }
 
-    bullets.remove_if([this](const Bullet& bullet) {
-        return !bullet.isAlive(lastUpdateTime);
-    });
+    bullets.removeExpired(lastUpdateTime);
+    {
+        MetricsRegistry::ScopedTimer particlesTimer{ particlesTime };
+        OM_TRACE_SCOPE("World::particles");
+        emitCollisionParticles();
+        particles.update(lastUpdateTime);
+    }
+    {
+        MetricsRegistry::ScopedTimer spatialIndexTimer{ spatialIndexTime };
+        OM_TRACE_SCOPE("World::updateSpatialIndex");
+        updateSpatialIndex();
+    }
 
     Global::setUserPosition(userShipPtr->x, userShipPtr->y);
     return true;
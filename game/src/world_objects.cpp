@@ -1,6 +1,7 @@
 #include "world_objects.hpp"
 #include <algorithm>
-#include <iostream>
+#include <cmath>
+#include <logger.hpp>
 namespace Model
 {
 
@@ -15,7 +16,7 @@ PhysicalObject::PhysicalObject(worldCalcType in_m, worldCalcType in_r,
 {
 }
 
-void PhysicalObject::update(seconds_t dt)
+void PhysicalObject::update(seconds_t dt, Integrator integrator)
 {
     ax = Motion::calcNextA(m, forceX);
 
@@ -27,9 +28,18 @@ void PhysicalObject::update(seconds_t dt)
     auto newVY =
         Motion::calcNextV(vy, ay, static_cast<worldCalcType>(dt.count()));
 
-    x += Motion::calcDs(vx, newVX, static_cast<worldCalcType>(dt.count()));
+    if (integrator == Integrator::symplecticEuler)
+    {
+        x += newVX * static_cast<worldCalcType>(dt.count());
 
-    y += Motion::calcDs(vy, newVY, static_cast<worldCalcType>(dt.count()));
+        y += newVY * static_cast<worldCalcType>(dt.count());
+    }
+    else
+    {
+        x += Motion::calcDs(vx, newVX, static_cast<worldCalcType>(dt.count()));
+
+        y += Motion::calcDs(vy, newVY, static_cast<worldCalcType>(dt.count()));
+    }
 
     vx = newVX;
     vy = newVY;
@@ -75,17 +85,6 @@ void PhysicalObject::teleportationHack(worldCalcType newX, worldCalcType newY)
     y = newY;
 }
 
-worldCalcType TrailCloud::getCurrentPower() const
-{
-    const auto lastPowerOfTime =
-        1 - (lastUpdateTime - initialTime) / TrailCloud::timeToLive;
-
-    const auto currentPowerCoef =
-        (lastPowerOfTime > 0.0) ? lastPowerOfTime : 0.0;
-
-    return initPower * currentPowerCoef;
-}
-
 Rocket::Rocket(worldCalcType in_m, worldCalcType in_r, worldCalcType in_c,
                worldCalcType in_width, worldCalcType in_height,
                worldCalcType in_mainEngineMaxThrust,
@@ -104,17 +103,16 @@ void Rocket::setEvents(const RocketEvents& newEvents)
     events = newEvents;
 }
 
-void Rocket::update(seconds_t dt)
+void Rocket::update(seconds_t dt, Integrator integrator)
 {
     handleEvents(events);
 
-    PhysicalObject::update(dt);
+    PhysicalObject::update(dt, integrator);
     mainEngine.updateTime(lastUpdateTime);
     std::for_each(sideEngines.begin(), sideEngines.end(),
                   [this](RocketEngine& currentEngine) {
                       currentEngine.updateTime(lastUpdateTime);
                   });
-    handleClouds(lastUpdateTime);
 }
 
 void Rocket::applyExternalForce(worldCalcType externalForceX,
@@ -186,11 +184,9 @@ void Rocket::applyExternalForce(worldCalcType externalForceX,
 
 void Rocket::handleEvents(const RocketEvents& events)
 {
-    auto isContainUp = events.find(Events::commandForward) != events.end();
-    auto isContainRotateLeft =
-        events.find(Events::commandRotateLeft) != events.end();
-    auto isContainRotateRight =
-        events.find(Events::commandRotateRight) != events.end();
+    auto isContainUp          = events.contains(Events::commandForward);
+    auto isContainRotateLeft  = events.contains(Events::commandRotateLeft);
+    auto isContainRotateRight = events.contains(Events::commandRotateRight);
 
     if (isContainUp)
     {
@@ -270,42 +266,36 @@ Bullet Rocket::getBullet()
         bullet.vx      = vx - Bullet::bulletRelativeSpeed * std::sin(angle);
         bullet.vy      = vy + Bullet::bulletRelativeSpeed * std::cos(angle);
         lastTimeWeapon = lastUpdateTime;
-        std::clog << "Bullet throwed\n";
+        OM_LOG(debug, world, "Bullet throwed");
     }
     return bullet;
 }
 
-void Rocket::handleClouds(time_point_t lastUpdateTime)
+void Rocket::emitClouds(ParticleSystem& particles)
 {
-    static const double cloudPerSecond = 1.5;
-    static const double numberOfClouds =
-        TrailCloud::timeToLive.count() * cloudPerSecond;
+    static const double    cloudPerSecond = 1.5;
     static const seconds_t generationPeriod{ 1 / cloudPerSecond };
     const auto             elapsedTime =
         std::chrono::duration_cast<seconds_t>(lastUpdateTime - lastTimeClouds);
 
     if (elapsedTime >= generationPeriod)
     {
+        lastTimeClouds = lastUpdateTime;
         const auto currentMainEnginePower =
             mainEngine.getCurrentAbsoluteForce() / mainEngine.engineMaxForce;
         const auto smokeVisibility = 0.8;
         const auto smokeSize =
             currentMainEnginePower * TrailCloud::heightDefault;
-        const auto verticalShift = 0.5 * (defaultHeight + 2 * smokeSize);
-        clouds.push_front({ x + verticalShift * std::sin(angle),
-                            y - verticalShift * std::cos(angle), angle,
-                            smokeVisibility, lastUpdateTime, lastUpdateTime,
-                            smokeSize, smokeSize });
-
-        if (clouds.size() > std::round(numberOfClouds))
+        if (smokeSize <= 0)
         {
-            clouds.pop_back();
+            return;
         }
-        lastTimeClouds = lastUpdateTime;
-    }
-    for (auto& cloud : clouds)
-    {
-        cloud.lastUpdateTime = lastUpdateTime;
+        const auto verticalShift = 0.5 * (defaultHeight + 2 * smokeSize);
+        particles.spawn({ ParticleSystem::Type::trailCloud,
+                          x + verticalShift * std::sin(angle),
+                          y - verticalShift * std::cos(angle), angle, smokeSize,
+                          smokeSize, smokeVisibility, lastUpdateTime,
+                          TrailCloud::timeToLive });
     }
 }
 
@@ -350,6 +340,22 @@ Planet::Planet(worldCalcType in_m, worldCalcType in_r, worldCalcType in_c,
 {
 }
 
+void Planet::moveOnRails(time_point_t worldTime, seconds_t dt)
+{
+    const auto state = orbit->getState(worldTime);
+    x                = state.x;
+    y                = state.y;
+    vx               = state.vx;
+    vy               = state.vy;
+
+    // resist is negligible for planets, rotation keeps its speed
+    angle = std::fmod(angle + angleSpeed * dt.count(), 2 * M_PI);
+
+    lastUpdateTime =
+        std::chrono::time_point_cast<std::chrono::steady_clock::duration>(
+            lastUpdateTime + dt);
+}
+
 Asteroid::Asteroid(worldCalcType in_m, worldCalcType in_r, worldCalcType in_c,
                    worldCalcType in_width, worldCalcType in_height)
     : PhysicalObject(in_m, in_r, in_c, in_width, in_height)
@@ -0,0 +1,408 @@
+#include "world_snapshot.hpp"
+#include "file_utils.hpp"
+#include "global.hpp"
+#include "mapped_file.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace Model
+{
+
+static_assert(sizeof(WorldSnapshot::Header) == 72);
+static_assert(sizeof(WorldSnapshot::BodyRecord) == 144);
+static_assert(sizeof(WorldSnapshot::EngineRecord) == 48);
+static_assert(sizeof(WorldSnapshot::RocketRecord) == 408);
+static_assert(sizeof(WorldSnapshot::BulletRecord) == 48);
+static_assert(sizeof(WorldSnapshot::ParticleRecord) == 72);
+static_assert(std::numeric_limits<double>::is_iec559);
+
+static bool isLittleEndianHost()
+{
+    const std::uint32_t mark = WorldSnapshot::byteOrderMark;
+    std::uint8_t        firstByte;
+    std::memcpy(&firstByte, &mark, 1);
+    return firstByte == 0x04;
+}
+
+static std::int64_t toNanoseconds(Timer::time_point_t time)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               time.time_since_epoch())
+        .count();
+}
+
+/// Never changed WorldObjectState keeps max time, it is not shifted
+static Timer::time_point_t fromNanoseconds(std::int64_t nanoseconds,
+                                           std::int64_t timeShift)
+{
+    if (nanoseconds == std::numeric_limits<std::int64_t>::max())
+    {
+        return Timer::time_point_t{ Timer::clock_t::duration::max() };
+    }
+    return Timer::time_point_t{
+        std::chrono::duration_cast<Timer::clock_t::duration>(
+            std::chrono::nanoseconds{ nanoseconds + timeShift })
+    };
+}
+
+WorldSnapshot::BodyRecord WorldSnapshot::toRecord(const PhysicalObject& object)
+{
+    BodyRecord record{};
+    record.x                 = object.x;
+    record.y                 = object.y;
+    record.width             = object.width;
+    record.height            = object.height;
+    record.vx                = object.vx;
+    record.vy                = object.vy;
+    record.ax                = object.ax;
+    record.ay                = object.ay;
+    record.angle             = object.angle;
+    record.angleSpeed        = object.angleSpeed;
+    record.angleAcceleration = object.angleAcceleration;
+    record.forceX            = object.forceX;
+    record.forceY            = object.forceY;
+    record.forceMoment       = object.forceMoment;
+    record.m                 = object.m;
+    record.r                 = object.r;
+    record.c                 = object.c;
+    record.lastUpdateTime    = toNanoseconds(object.lastUpdateTime);
+    return record;
+}
+
+WorldSnapshot::EngineRecord WorldSnapshot::toRecord(const RocketEngine& engine)
+{
+    EngineRecord record{};
+    record.engineMaxForce      = engine.engineMaxForce;
+    record.enginePercentThrust = engine.enginePercentThrust;
+    record.engineHealth        = engine.m_engineHealth;
+    record.changeStateTime =
+        toNanoseconds(engine.m_engineState.m_changeStatetime);
+    record.currentTime = toNanoseconds(engine.m_engineState.m_currentTime);
+    record.state       = engine.m_engineState.m_state;
+    return record;
+}
+
+void WorldSnapshot::restore(PhysicalObject&   object,
+                            const BodyRecord& record,
+                            std::int64_t      timeShift)
+{
+    object.x                 = record.x;
+    object.y                 = record.y;
+    object.width             = record.width;
+    object.height            = record.height;
+    object.vx                = record.vx;
+    object.vy                = record.vy;
+    object.ax                = record.ax;
+    object.ay                = record.ay;
+    object.angle             = record.angle;
+    object.angleSpeed        = record.angleSpeed;
+    object.angleAcceleration = record.angleAcceleration;
+    object.forceX            = record.forceX;
+    object.forceY            = record.forceY;
+    object.forceMoment       = record.forceMoment;
+    object.lastUpdateTime = fromNanoseconds(record.lastUpdateTime, timeShift);
+}
+
+void WorldSnapshot::restore(RocketEngine&       engine,
+                            const EngineRecord& record,
+                            std::int64_t        timeShift)
+{
+    engine.enginePercentThrust = record.enginePercentThrust;
+    engine.m_engineHealth      = record.engineHealth;
+    engine.m_engineState.m_changeStatetime =
+        fromNanoseconds(record.changeStateTime, timeShift);
+    engine.m_engineState.m_currentTime =
+        fromNanoseconds(record.currentTime, timeShift);
+    engine.m_engineState.m_state = record.state != 0;
+}
+
+WorldSnapshot::Buffer WorldSnapshot::serialize(const World& world)
+{
+    Header header{};
+    std::copy(std::begin(signature), std::end(signature), header.signature);
+    header.version               = version;
+    header.byteOrderMark         = byteOrderMark;
+    header.lastUpdateTime        = toNanoseconds(world.lastUpdateTime);
+    header.lastAsteroidSpawnTime = toNanoseconds(world.lastAsteroidSpawnTime);
+    header.dt = std::chrono::duration_cast<std::chrono::nanoseconds>(world.dt)
+                    .count();
+    header.rocketsCount   = static_cast<std::uint32_t>(world.rockets.size());
+    header.starsCount     = static_cast<std::uint32_t>(world.stars.size());
+    header.planetsCount   = static_cast<std::uint32_t>(world.planets.size());
+    header.asteroidsCount = static_cast<std::uint32_t>(world.asteroids.size());
+    header.bulletsCount   = static_cast<std::uint32_t>(world.bullets.size());
+    header.particlesCount =
+        static_cast<std::uint32_t>(world.particles.size());
+
+    header.userRocketIndex = std::numeric_limits<std::uint32_t>::max();
+    const auto userRocketIt =
+        std::find_if(world.rockets.begin(), world.rockets.end(),
+                     [&world](const Rocket& rocket) {
+                         return &rocket == world.userShipPtr;
+                     });
+    if (userRocketIt != world.rockets.end())
+    {
+        header.userRocketIndex = static_cast<std::uint32_t>(
+            std::distance(world.rockets.begin(), userRocketIt));
+    }
+
+    const size_t bodiesCount = world.stars.size() + world.planets.size() +
+                               world.asteroids.size();
+    Buffer buffer(sizeof(Header) + world.rockets.size() * sizeof(RocketRecord) +
+                  bodiesCount * sizeof(BodyRecord) +
+                  world.bullets.size() * sizeof(BulletRecord) +
+                  header.particlesCount * sizeof(ParticleRecord));
+
+    std::byte* out    = buffer.data();
+    auto       append = [&out](const auto& record) {
+        std::memcpy(out, &record, sizeof(record));
+        out += sizeof(record);
+    };
+
+    append(header);
+    for (const auto& rocket : world.rockets)
+    {
+        RocketRecord record{};
+        record.body       = toRecord(rocket);
+        record.mainEngine = toRecord(rocket.mainEngine);
+        for (size_t i = 0; i < rocket.sideEngines.size(); ++i)
+        {
+            record.sideEngines[i] = toRecord(rocket.sideEngines[i]);
+        }
+        record.lastTimeClouds = toNanoseconds(rocket.lastTimeClouds);
+        record.lastTimeWeapon = toNanoseconds(rocket.lastTimeWeapon);
+        record.stabilizationLevel1Enabled = rocket.stabilizationLevel1Enabled;
+        record.stabilizationLevel2Enabled = rocket.stabilizationLevel2Enabled;
+        append(record);
+    }
+    for (const auto& star : world.stars)
+    {
+        append(toRecord(star));
+    }
+    for (const auto& planet : world.planets)
+    {
+        append(toRecord(planet));
+    }
+    for (const auto& asteroid : world.asteroids)
+    {
+        append(toRecord(asteroid));
+    }
+    world.bullets.forEach([&append](const Bullet& bullet) {
+        append(BulletRecord{ bullet.x, bullet.y, bullet.vx, bullet.vy,
+                             bullet.angle,
+                             toNanoseconds(bullet.creatingTime) });
+    });
+    world.particles.forEach(
+        [&append](const ParticleSystem::Particle& particle) {
+            append(ParticleRecord{
+                particle.x, particle.y, particle.angle, particle.width,
+                particle.height, particle.initPower,
+                toNanoseconds(particle.spawnTime), particle.timeToLive.count(),
+                static_cast<std::uint32_t>(particle.type), 0 });
+        });
+    return buffer;
+}
+
+bool WorldSnapshot::writeBuffer(const Buffer& buffer, const std::string& path)
+{
+    if (!isLittleEndianHost())
+    {
+        std::cerr << "Error: snapshot is supported on little-endian hosts only"
+                  << std::endl;
+        return false;
+    }
+
+    // renamed after writing, so crash never leaves broken snapshot
+    om::AtomicFileWriter writer{ path };
+    writer.getStream().write(reinterpret_cast<const char*>(buffer.data()),
+                             static_cast<std::streamsize>(buffer.size()));
+    if (!writer.commit())
+    {
+        std::cerr << "Error: can't write snapshot: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool WorldSnapshot::save(const World& world, const std::string& path)
+{
+    return writeBuffer(serialize(world), path);
+}
+
+std::future<bool> WorldSnapshot::saveAsync(const World& world,
+                                           std::string  path)
+{
+    return std::async(std::launch::async,
+                      [buffer = serialize(world), path = std::move(path)]() {
+                          return writeBuffer(buffer, path);
+                      });
+}
+
+World WorldSnapshot::load(const std::string&  path,
+                          Timer::time_point_t initialTime)
+{
+    if (!isLittleEndianHost())
+    {
+        throw std::runtime_error(
+            "Error: snapshot is supported on little-endian hosts only");
+    }
+
+    const auto file = om::mapFile(path);
+    if (!file)
+    {
+        throw std::runtime_error("Error: can't map snapshot: " + path);
+    }
+    const auto* data = file->data.get();
+    if (file->size < sizeof(Header))
+    {
+        throw std::runtime_error("Error: snapshot is too small: " + path);
+    }
+    const auto& header = *reinterpret_cast<const Header*>(data);
+    if (!std::equal(std::begin(signature), std::end(signature),
+                    header.signature) ||
+        header.version != version || header.byteOrderMark != byteOrderMark)
+    {
+        std::stringstream serr;
+        serr << "Error: wrong snapshot header, expected version " << version
+             << ": " << path;
+        throw std::runtime_error(serr.str());
+    }
+
+    const size_t bodiesCount = size_t{ header.starsCount } +
+                               header.planetsCount + header.asteroidsCount;
+    const size_t expectedSize =
+        sizeof(Header) + header.rocketsCount * sizeof(RocketRecord) +
+        bodiesCount * sizeof(BodyRecord) +
+        header.bulletsCount * sizeof(BulletRecord) +
+        header.particlesCount * sizeof(ParticleRecord);
+    if (file->size != expectedSize)
+    {
+        std::stringstream serr;
+        serr << "Error: snapshot size " << file->size << " expected "
+             << expectedSize << ": " << path;
+        throw std::runtime_error(serr.str());
+    }
+    if (header.userRocketIndex >= header.rocketsCount)
+    {
+        throw std::runtime_error("Error: snapshot without user rocket: " +
+                                 path);
+    }
+
+    const auto* rocketRecords =
+        reinterpret_cast<const RocketRecord*>(data + sizeof(Header));
+    const auto* starRecords = reinterpret_cast<const BodyRecord*>(
+        rocketRecords + header.rocketsCount);
+    const auto* planetRecords   = starRecords + header.starsCount;
+    const auto* asteroidRecords = planetRecords + header.planetsCount;
+    const auto* bulletRecords   = reinterpret_cast<const BulletRecord*>(
+        asteroidRecords + header.asteroidsCount);
+    const auto* particleRecords = reinterpret_cast<const ParticleRecord*>(
+        bulletRecords + header.bulletsCount);
+
+    const std::int64_t timeShift =
+        toNanoseconds(initialTime) - header.lastUpdateTime;
+
+    World world;
+    world.lastUpdateTime = fromNanoseconds(header.lastUpdateTime, timeShift);
+    world.lastAsteroidSpawnTime =
+        fromNanoseconds(header.lastAsteroidSpawnTime, timeShift);
+    world.dt            = std::chrono::nanoseconds{ header.dt };
+    world.lastInputTime = world.lastUpdateTime;
+    world.targetTime    = world.lastUpdateTime;
+
+    for (std::uint32_t i = 0; i < header.rocketsCount; ++i)
+    {
+        const auto& record = rocketRecords[i];
+        const auto& body   = record.body;
+        world.rockets.emplace_back(body.m, body.r, body.c, body.width,
+                                   body.height,
+                                   record.mainEngine.engineMaxForce,
+                                   record.sideEngines[0].engineMaxForce);
+        auto& rocket = world.rockets.back();
+        restore(rocket, body, timeShift);
+        restore(rocket.mainEngine, record.mainEngine, timeShift);
+        for (size_t j = 0; j < rocket.sideEngines.size(); ++j)
+        {
+            restore(rocket.sideEngines[j], record.sideEngines[j], timeShift);
+        }
+        rocket.lastTimeClouds =
+            fromNanoseconds(record.lastTimeClouds, timeShift);
+        rocket.lastTimeWeapon =
+            fromNanoseconds(record.lastTimeWeapon, timeShift);
+        rocket.stabilizationLevel1Enabled = record.stabilizationLevel1Enabled;
+        rocket.stabilizationLevel2Enabled = record.stabilizationLevel2Enabled;
+
+        if (i == header.userRocketIndex)
+        {
+            world.userShipPtr = &rocket;
+        }
+    }
+
+    auto restoreBodies = [timeShift](auto& objects, const BodyRecord* records,
+                                     std::uint32_t count) {
+        for (std::uint32_t i = 0; i < count; ++i)
+        {
+            const auto& record = records[i];
+            objects.emplace_back(record.m, record.r, record.c, record.width,
+                                 record.height);
+            restore(objects.back(), record, timeShift);
+        }
+    };
+    restoreBodies(world.stars, starRecords, header.starsCount);
+    restoreBodies(world.planets, planetRecords, header.planetsCount);
+    restoreBodies(world.asteroids, asteroidRecords, header.asteroidsCount);
+
+    for (std::uint32_t i = 0; i < header.bulletsCount; ++i)
+    {
+        const auto& record = bulletRecords[i];
+        Bullet      bullet;
+        bullet.x            = record.x;
+        bullet.y            = record.y;
+        bullet.vx           = record.vx;
+        bullet.vy           = record.vy;
+        bullet.angle        = record.angle;
+        bullet.creatingTime = fromNanoseconds(record.creatingTime, timeShift);
+        if (!world.bullets.push(bullet))
+        {
+            throw std::runtime_error("Error: too many bullets in snapshot: " +
+                                     path);
+        }
+    }
+
+    for (std::uint32_t i = 0; i < header.particlesCount; ++i)
+    {
+        const auto& record = particleRecords[i];
+        if (record.type >=
+            static_cast<std::uint32_t>(ParticleSystem::Type::maxType))
+        {
+            throw std::runtime_error(
+                "Error: wrong particle type in snapshot: " + path);
+        }
+        ParticleSystem::Particle particle;
+        particle.type       = static_cast<ParticleSystem::Type>(record.type);
+        particle.x          = record.x;
+        particle.y          = record.y;
+        particle.angle      = record.angle;
+        particle.width      = record.width;
+        particle.height     = record.height;
+        particle.initPower  = record.initPower;
+        particle.spawnTime  = fromNanoseconds(record.spawnTime, timeShift);
+        particle.timeToLive = ParticleSystem::seconds_t{ record.timeToLive };
+        if (!world.particles.spawn(particle))
+        {
+            throw std::runtime_error(
+                "Error: too many particles in snapshot: " + path);
+        }
+    }
+
+    world.updateSpatialIndex();
+    Global::setUserPosition(world.userShipPtr->x, world.userShipPtr->y);
+    return world;
+}
+
+} // namespace Model